@@ -11,8 +11,11 @@
 //  This file should not be modified by students.
 //
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
@@ -26,14 +29,25 @@
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/matrix.hpp>
 
 #include "Application.h"
 
+#include "Benchmark.h"
 #include "Buffers.h"
 #include "Canvas.h"
+#include "Culling.h"
+#include "FrameData.h"
 #include "Lighting.h"
+#include "MaskedOcclusion.h"
 #include "Materials.h"
+#include "Meshlets.h"
 #include "Models.h"
+#include "Occlusion.h"
+#include "RenderQueue.h"
 #include "ShaderSetup.h"
 #include "Testing.h"
 #include "Types.h"
@@ -51,6 +65,11 @@ static const char *vs_f = "f150.vert";
 static const char *fs_f = "f150.frag";
 static const char *vs_t = "texture.vert";
 static const char *fs_t = "texture.frag";
+static const char *vs_p = "proxy.vert";
+static const char *fs_p = "proxy.frag";
+static const char *vs_c = "cylinder.vert";
+static const char *tc_c = "cylinder.tesc";
+static const char *te_c = "cylinder.tese";
 
 // our Canvas
 static Canvas *canvas;
@@ -58,10 +77,40 @@ static Canvas *canvas;
 // buffers for our shapes
 static BufferSet buffers[N_OBJECTS];
 
+// optionally, all shapes share one vertex buffer and one index buffer
+// (requires glDrawElementsBaseVertex, from OpenGL 3.2)
+static bool useArena = true;
+static BufferSet arena;
+static const GLsizei arenaVertices = 256 * 1024;
+static const GLsizei arenaIndices = 1024 * 1024;
+
+// store vertex data in packed formats (requires OpenGL 3.3)?
+static bool usePacked = true;
+
+// draw all the copies of a mesh that share a material with a single
+// instanced draw call (requires OpenGL 3.3 or ARB_instanced_arrays,
+// and shaders with the per-instance vModel attribute)?
+static bool useInstancing = true;
+static bool instancing = false;
+static InstanceBuffer instances;
+
+// where each program's per-instance model matrix attribute is
+static GLint flatModelLoc = -1, textureModelLoc = -1;
+
+// back the Canvas' storage with huge pages when it grows large enough?
+static bool useHugePages = true;
+
+// what building the scene cost
+static BuildStats buildStats;
+static double buildSeconds;
+
 // shader program handles
 static GLuint flat, texture;
 
-// our VAO
+// do they get their per-frame data from the shared uniform block?
+static bool flatShared, textureShared;
+
+// our default VAO; each BufferSet caches its own VAOs for drawing
 static GLuint vao;
 
 // do we need to do a display() call?
@@ -74,6 +123,68 @@ static float angles[N_OBJECTS];    // individual rotation angles
 // which object(s) to texture map
 static bool map_obj[N_OBJECTS];
 
+// the draw calls for the current frame
+static RenderQueue queue;
+static unsigned long drawCalls = 0;
+
+// the farm is repeated on a farmSize x farmSize grid for large scenes
+static int farmSize = 1;
+static const int farmMax = 100;
+static const float farmSpacing = 20.0f;
+
+// every object in every farm, before culling
+typedef struct st_farmobj {
+	Object obj;          // which object
+	glm::mat4 model;     // its model transformation
+} FarmObject;
+static vector<FarmObject> farmObjects;
+
+// skip objects that are entirely outside the view frustum?
+static bool useCulling = true;
+static CullSet cullSet;
+
+// skip objects hidden behind others (requires OpenGL 3.2, and a
+// proxy program that uses the shared uniform block)?
+static bool useOcclusion = true;
+static bool occluding = false;
+static OcclusionCuller occlusion;
+static GLuint proxy;
+
+// also skip objects hidden behind others' occluder boxes, found by
+// rasterizing those on the CPU, and what that costs each frame
+static bool useSoftOcclusion = true;
+static MaskedOcclusion softOcclusion;
+static vector<unsigned char> softHidden;
+static double softRasterSeconds, softTestSeconds;
+
+// draw distant objects at simpler levels of detail?  the level each
+// farm object was last drawn at, and what that saved this frame
+static bool useLOD = true;
+static vector<int> farmLOD;
+static long lodTriangles, fullTriangles;
+static long lodObjects[ MAX_LODS ];
+
+// draw the cylinder bodies by tessellating a coarse control cage on
+// the GPU, as finely as their distance calls for (requires OpenGL 4.0,
+// and programs that use the shared uniform block)?  The programs for
+// flat shaded and texture mapped bodies, where their per-instance
+// model matrix attributes and level scale uniforms are, and how many
+// bodies were drawn this way this frame
+static bool useTessellation = true;
+static bool tessellating = false;
+static BufferSet cage;
+static GLuint tessFlat, tessTexture;
+static GLint tessFlatModelLoc = -1, tessTextureModelLoc = -1;
+static GLint tessFlatScale = -1, tessTextureScale = -1;
+static long tessObjects;
+
+// draw the full meshes of the objects only in the meshlets that may be
+// seen (facing the camera, and on the screen), and what finding those
+// cost this frame
+static bool useMeshlets = true;
+static MeshletCuller meshletCuller;
+static double meshletSeconds;
+
 // object transformations
 // static glm::vec3 quad_s( 1.75f,  1.75f,  1.75f );
 // static glm::vec3 quad_x( -1.25f, 0.5f, -1.5f );
@@ -117,6 +228,14 @@ static bool animateLight = false;
 static float delta = 1.0f;
 static const float lightMax = 50.0f, lightMin = -50.0f;
 
+// event loop scheduling
+static const double frameInterval = 1.0 / 60.0;  // animation step, in seconds
+static double nextFrame = 0.0;      // time of the next animation step
+
+// wakeup statistics for the event loop
+static unsigned long idleWakeups = 0;    // woke up with nothing to do
+static unsigned long activeWakeups = 0;  // woke up to animate or redraw
+
 //
 // PUBLIC GLOBALS
 //
@@ -155,15 +274,22 @@ static void createImage( Canvas &C )
 	// createObject( C, Cylinder, buffers[Cylinder] );
 	// createObject( C, Discs,    buffers[Discs] );
 
-    createObject( C, SiloBody, buffers[SiloBody] );
-    createObject( C, SiloRoof,   buffers[SiloRoof] );
-    createObject( C, MainBarnBody, buffers[MainBarnBody] );
-    createObject( C, MainBarnRoof, buffers[MainBarnRoof] );
-    createObject( C, AltBarnBody, buffers[AltBarnBody] );
-    ceateObject( C, AltBarnRoof, buffers[AltBarnRoof] );
-    ceateObject( C, MiniBarnBody, buffers[MiniBarnBody] );
-    ceateObject( C, MiniBarnRoof, buffers[MiniBarnRoof] );
-    createObject( C, Floor,     buffers[Floor]);
+	static const Object scene[] = {
+		SiloBody, SiloRoof, MainBarnBody, MainBarnRoof, AltBarnBody,
+		AltBarnRoof, MiniBarnBody, MiniBarnRoof, Floor
+	};
+
+	// the meshes are generated in parallel; their buffers are
+	// created here, on the context's thread
+	double start = glfwGetTime();
+	createObjects( C, scene, sizeof(scene) / sizeof(scene[0]),
+		buffers, &buildStats );
+	buildSeconds = glfwGetTime() - start;
+
+	// the control cage the GPU tessellates the cylinder bodies from
+	if( tessellating ) {
+		createCage( C, cage );
+	}
 }
 
 ///
@@ -178,6 +304,101 @@ static void createImage( Canvas &C )
 // 	}
 // }
 
+///
+/// Is anything in the scene currently being animated?
+///
+/// @return true if the event loop must wake up for animation steps
+///
+static bool animationPending( void ) {
+
+	if( animateLight ) {
+		return( true );
+	}
+
+	for( int i = 0; i < N_OBJECTS; ++i ) {
+		if( animating[i] ) {
+			return( true );
+		}
+	}
+
+	return( false );
+}
+
+///
+/// Print the event loop statistics
+///
+static void printStats( void ) {
+	unsigned long total = idleWakeups + activeWakeups;
+
+	cout << "Event loop: " << total << " wakeups, "
+		 << activeWakeups << " active, " << idleWakeups << " idle" << endl;
+	cout << "Render queue: " << queue.packets.size() << " packets, "
+		 << queue.programChanges << " program changes, "
+		 << queue.textureChanges << " texture changes, "
+		 << queue.changesAvoided << " changes avoided by sorting" << endl;
+	cout << "Draw calls: " << drawCalls << " for "
+		 << queue.packets.size() << " objects" << endl;
+	if( useCulling ) {
+		cout << "Frustum culling: " << cullSet.numVisible << " visible, "
+			 << cullSet.numCulled << " culled of " << cullSet.count
+			 << " objects" << endl;
+	}
+	if( occluding && useOcclusion ) {
+		cout << "Occlusion culling: " << occlusion.queried
+			 << " queries issued, " << occlusion.queryCulled
+			 << " hidden by queries, " << occlusion.hizCulled
+			 << " by the depth pyramid, " << occlusion.conditional
+			 << " drawn conditionally" << endl;
+	}
+	if( useSoftOcclusion ) {
+		cout << "Software occlusion: " << softOcclusion.occluders
+			 << " occluders (" << softOcclusion.triangles << " triangles) in "
+			 << softRasterSeconds * 1000.0 << " ms, "
+			 << softOcclusion.culled << " of " << softOcclusion.tested
+			 << " objects hidden in " << softTestSeconds * 1000.0
+			 << " ms" << endl;
+	}
+	if( useLOD ) {
+		cout << "Level of detail: " << lodTriangles << " of "
+			 << fullTriangles << " triangles drawn; objects at each level:";
+		for( int i = 0; i < MAX_LODS; ++i ) {
+			cout << " " << lodObjects[i];
+		}
+		cout << endl;
+	}
+	if( tessellating && useTessellation ) {
+		cout << "Tessellation: " << tessObjects << " cylinder bodies from "
+			 << cage.numIndices / 4 << " patches each" << endl;
+	}
+	if( useMeshlets ) {
+		cout << "Meshlets: " << meshletCuller.drawn << " of "
+			 << meshletCuller.meshlets << " drawn ("
+			 << meshletCuller.facing << " facing away, "
+			 << meshletCuller.outside << " off the screen) in "
+			 << meshletSeconds * 1000.0 << " ms; "
+			 << meshletCuller.submitted << " of " << meshletCuller.triangles
+			 << " triangles submitted in " << meshletCuller.ranges
+			 << " ranges" << endl;
+	}
+	if( instancing ) {
+		cout << "Instancing: " << instances.matrices.size()
+			 << " instances in " << queue.batches.size() << " batches, "
+			 << instances.capacity << " bytes of instance buffer" << endl;
+	}
+	if( BufferSet::sharedArena != nullptr ) {
+		cout << "Arena: " << arena.usedVertices << "/" << arena.capVertices
+			 << " vertices, " << arena.usedIndices << "/" << arena.capIndices
+			 << " indices" << endl;
+	}
+	cout << "Scene build: " << (buildSeconds * 1000.0) << " ms on "
+		 << buildStats.threads << " worker threads, "
+		 << buildStats.peakBytes << " bytes peak, "
+		 << buildStats.allocations << " allocations ("
+		 << buildStats.chunkAllocations << " from the system, "
+		 << buildStats.reserved << " bytes held)" << endl;
+	printMeshStats();
+}
+
 ///
 /// Animation routine
 ///
@@ -290,6 +511,79 @@ static void keyboard( GLFWwindow *window, int key, int scan,
 			 << "," << lightpos[2] << ")" << endl;
 		break;
 
+	// scene size
+
+	case GLFW_KEY_EQUAL:       // FALL THROUGH
+	case GLFW_KEY_KP_ADD:      // grow the farm grid
+		if( farmSize < farmMax ) {
+			farmSize += 1;
+		}
+		cout << "Farm grid is " << farmSize << "x" << farmSize << endl;
+		break;
+
+	case GLFW_KEY_MINUS:       // FALL THROUGH
+	case GLFW_KEY_KP_SUBTRACT: // shrink the farm grid
+		if( farmSize > 1 ) {
+			farmSize -= 1;
+		}
+		cout << "Farm grid is " << farmSize << "x" << farmSize << endl;
+		break;
+
+	case GLFW_KEY_S: // rendering statistics
+		printStats();
+		// return without updating the display
+		return;
+		// NOTREACHED
+
+	case GLFW_KEY_B: // vertex layout benchmark
+		benchLayouts( texture );
+		break;
+
+	case GLFW_KEY_F: // frustum culling on/off
+		useCulling = !useCulling;
+		cout << "Frustum culling is " << (useCulling ? "on" : "off") << endl;
+		break;
+
+	case GLFW_KEY_C: // occlusion culling on/off
+		useOcclusion = !useOcclusion;
+		if( useOcclusion ) {
+			// what we learned before may be out of date
+			occlusion.reset();
+		}
+		cout << "Occlusion culling is " << (useOcclusion ? "on" : "off")
+			 << (occluding ? "" : " (not available)") << endl;
+		break;
+
+	case GLFW_KEY_D: // levels of detail on/off
+		useLOD = !useLOD;
+		farmLOD.clear();
+		cout << "Levels of detail are " << (useLOD ? "on" : "off") << endl;
+		break;
+
+	case GLFW_KEY_G: // GPU tessellation of the cylinders on/off
+		useTessellation = !useTessellation;
+		cout << "GPU tessellation is " << (useTessellation ? "on" : "off")
+			 << (tessellating ? "" : " (not available)") << endl;
+		break;
+
+	case GLFW_KEY_K: // meshlet culling on/off
+		useMeshlets = !useMeshlets;
+		cout << "Meshlet culling is " << (useMeshlets ? "on" : "off")
+			 << endl;
+		break;
+
+	case GLFW_KEY_M: // software (masked) occlusion culling on/off
+		useSoftOcclusion = !useSoftOcclusion;
+		cout << "Software occlusion culling is "
+			 << (useSoftOcclusion ? "on" : "off") << endl;
+		break;
+
+	case GLFW_KEY_T: // triangle submission benchmark
+		benchTriangles();
+		// return without updating the display
+		return;
+		// NOTREACHED
+
 	// Reset parameters
 
 	// case GLFW_KEY_1: // reset all object rotations
@@ -321,6 +615,16 @@ static void keyboard( GLFWwindow *window, int key, int scan,
 		cout << "  o, O      Move light 'out' from the scene"
 			<< " (away from the objects)" << endl;
 		cout << "  p, P      Print light position" << endl;
+		cout << "  s, S      Print rendering statistics" << endl;
+		cout << "  b, B      Benchmark the vertex buffer layouts" << endl;
+		cout << "  t, T      Benchmark adding triangles to a Canvas" << endl;
+		cout << "  f, F      Toggle frustum culling" << endl;
+		cout << "  c, C      Toggle occlusion culling" << endl;
+		cout << "  m, M      Toggle software occlusion culling" << endl;
+		cout << "  d, D      Toggle levels of detail" << endl;
+		cout << "  g, G      Toggle GPU tessellation of the cylinders" << endl;
+		cout << "  k, K      Toggle meshlet culling" << endl;
+		cout << "   +, -     Grow/shrink the grid of farms" << endl;
 		cout << "   2        Reset light position, stop animation" << endl;
 		// return without updating the display
 		return;
@@ -336,6 +640,16 @@ static void keyboard( GLFWwindow *window, int key, int scan,
 	updateDisplay = true;
 }
 
+///
+/// Handle window refresh requests (e.g., after the window is uncovered)
+///
+/// @param window   GLFW window being used
+///
+static void refresh( GLFWwindow * /* window */ )
+{
+	updateDisplay = true;
+}
+
 ///
 /// Set the titlebar in the display window
 ///
@@ -350,6 +664,286 @@ void setTitle( void ) {
 	glfwSetWindowTitle( w_window, buf );
 }
 
+///
+/// Compute the model transformation for an object in the original farm
+///
+/// @param obj  the object
+/// @return its model matrix
+///
+static glm::mat4 objectTransform( int obj )
+{
+	// select the correct rotation angles
+	glm::vec3 ang( angles[obj], angles[obj], angles[obj] );
+
+	switch( obj ) {
+
+	case SiloBody:
+		return( modelMatrix( siloBody_s, ang, siloBody_x ) );
+	case SiloRoof:
+		return( modelMatrix( siloRoof_s, ang, siloRoof_x ) );
+
+	case MainBarnBody:
+		return( modelMatrix( mainBarnBody_s, ang, mainBarnBody_x ) );
+	case MainBarnRoof:
+		return( modelMatrix( mainBarnRoof_s, ang, mainBarnRoof_x ) );
+
+	case AltBarnBody:
+		return( modelMatrix( altBarnBody_s, ang, altBarnBody_x ) );
+	case AltBarnRoof:
+		return( modelMatrix( altBarnRoof_s, ang, altBarnRoof_x ) );
+
+	case MiniBarnBody:
+		return( modelMatrix( miniBarnBody_s, ang, miniBarnBody_x ) );
+	case MiniBarnRoof:
+		return( modelMatrix( miniBarnRoof_s, ang, miniBarnRoof_x ) );
+
+	case Floor:
+		return( modelMatrix( road_s, road_r, road_x ) );
+	}
+
+	return( glm::mat4(1.0f) );
+}
+
+///
+/// The largest factor by which a model transformation scales
+///
+/// @param m   the transformation
+///
+/// @return the length of the longest transformed axis
+///
+static float modelScale( const glm::mat4 &m )
+{
+	float s2 = 0.0f;
+
+	for( int k = 0; k < 3; ++k ) {
+		s2 = std::max( s2, m[k][0] * m[k][0] + m[k][1] * m[k][1] +
+			m[k][2] * m[k][2] );
+	}
+
+	return( sqrtf( s2 ) );
+}
+
+///
+/// The number of triangles an object's buffers draw at a level of detail
+///
+/// @param buf   the buffers
+/// @param lod   the level
+///
+/// @return the triangle count
+///
+static long triangles( BufferSet *buf, int lod )
+{
+	if( buf->indexType == GL_NONE ) {
+		return( buf->numElements / 3 );
+	}
+	if( lod > 0 && lod < buf->numLODs ) {
+		return( buf->lodCount[lod] / 3 );
+	}
+
+	return( buf->numIndices / 3 );
+}
+
+///
+/// Does a program draw its objects texture mapped?
+///
+/// @param program   the program
+///
+/// @return true for the texture programs
+///
+static bool isMapped( GLuint program )
+{
+	return( program == texture || (tessellating && program == tessTexture) );
+}
+
+///
+/// Does a program tessellate its objects from a control cage?
+///
+/// @param program   the program
+///
+/// @return true for the tessellation programs
+///
+static bool isTessellated( GLuint program )
+{
+	return( tessellating && (program == tessFlat || program == tessTexture) );
+}
+
+///
+/// Where a program's per-instance model matrix attribute is
+///
+/// @param program   the program
+///
+/// @return the attribute's location
+///
+static GLint modelLoc( GLuint program )
+{
+	if( program == texture ) {
+		return( textureModelLoc );
+	}
+	if( tessellating && program == tessFlat ) {
+		return( tessFlatModelLoc );
+	}
+	if( tessellating && program == tessTexture ) {
+		return( tessTextureModelLoc );
+	}
+
+	return( flatModelLoc );
+}
+
+///
+/// Select the buffers to draw a packet with; the tessellated
+/// programs need each cage corner's texture coordinates, and get
+/// their normals from the tessellation evaluation shader
+///
+/// @param p   the packet
+///
+static void selectPacketBuffers( DrawPacket &p )
+{
+	bool patches = isTessellated( p.program );
+
+	p.buf->selectBuffers( p.program,
+		"vPosition", NULL, patches ? NULL : "vNormal",
+		(patches || isMapped( p.program )) ? "vTexCoord" : NULL );
+}
+
+///
+/// Draw the mesh of one packet:  only its meshlets that may be seen, if
+/// they were culled, or else the whole of its level of detail
+///
+/// @param p   the packet
+///
+static void drawPacketMesh( DrawPacket &p )
+{
+	if( p.meshlets >= 0 ) {
+		meshletCuller.draw( p.meshlets, p.buf );
+	} else {
+		p.buf->drawBuffers( p.lod );
+	}
+}
+
+///
+/// Draw the queued packets one object at a time
+///
+static void drawPackets( void )
+{
+	GLuint curProgram = 0;
+	int curMaterial = -1;
+	BufferSet *curDecode = nullptr;
+	drawCalls = 0;
+
+	for( size_t i = 0; i < queue.packets.size(); ++i ) {
+		DrawPacket &p = queue.packets[i];
+		bool mapped = isMapped( p.program );
+
+		// select the proper shader program
+		if( p.program != curProgram ) {
+			glUseProgram( p.program );
+			curProgram = p.program;
+			curMaterial = -1;
+			curDecode = nullptr;
+		}
+
+		// set texture parameters OR material properties
+		if( p.material != curMaterial ) {
+			setMaterials( p.program, p.obj, mapped );
+			curMaterial = p.material;
+			checkErrors( "display materials" );
+		}
+
+		// send the transformation data
+		setModelMatrix( p.program, p.model );
+
+		// select the buffers
+		selectPacketBuffers( p );
+
+		// tell the shader how to unpack this mesh's positions
+		if( curDecode == nullptr || !p.buf->sameDecode( curDecode ) ) {
+			p.buf->sendDecode( p.program );
+			curDecode = p.buf;
+		}
+
+		// draw it; a conditional draw is left to the GPU
+		drawCalls += 1;
+		if( p.query != 0 ) {
+			glBeginConditionalRender( p.query, GL_QUERY_WAIT );
+			drawPacketMesh( p );
+			glEndConditionalRender();
+		} else {
+			drawPacketMesh( p );
+		}
+	}
+}
+
+///
+/// Draw the queued packets as instanced batches, one draw call for
+/// all the copies of a mesh that share a program and material
+///
+static void drawInstanced( void )
+{
+	GLuint curProgram = 0;
+	int curMaterial = -1;
+	BufferSet *curDecode = nullptr;
+	drawCalls = 0;
+
+	// gather the packets by mesh, and send all their matrices at once
+	queue.batch();
+
+	instances.clear();
+	for( size_t i = 0; i < queue.packets.size(); ++i ) {
+		instances.add( queue.packets[i].model );
+	}
+	instances.upload();
+	checkErrors( "display instances" );
+
+	for( size_t b = 0; b < queue.batches.size(); ++b ) {
+		DrawBatch &batch = queue.batches[b];
+		DrawPacket &p = queue.packets[batch.first];
+		bool mapped = isMapped( p.program );
+
+		// select the proper shader program
+		if( p.program != curProgram ) {
+			glUseProgram( p.program );
+			curProgram = p.program;
+			curMaterial = -1;
+			curDecode = nullptr;
+		}
+
+		// set texture parameters OR material properties
+		if( p.material != curMaterial ) {
+			setMaterials( p.program, p.obj, mapped );
+			curMaterial = p.material;
+			checkErrors( "display materials" );
+		}
+
+		// select the buffers, and this batch's model matrices
+		selectPacketBuffers( p );
+		instances.select( modelLoc( p.program ), (GLint) batch.first );
+
+		// tell the shader how to unpack this mesh's positions
+		if( curDecode == nullptr || !p.buf->sameDecode( curDecode ) ) {
+			p.buf->sendDecode( p.program );
+			curDecode = p.buf;
+		}
+
+		// draw every copy; a conditional draw is left to the GPU, and
+		// a packet whose meshlets were culled (always a batch of one)
+		// takes its model matrix from instance 0
+		drawCalls += 1;
+		if( p.query != 0 ) {
+			glBeginConditionalRender( p.query, GL_QUERY_WAIT );
+			if( p.meshlets >= 0 ) {
+				drawPacketMesh( p );
+			} else {
+				p.buf->drawInstanced( (GLsizei) batch.count, p.lod );
+			}
+			glEndConditionalRender();
+		} else if( p.meshlets >= 0 ) {
+			drawPacketMesh( p );
+		} else {
+			p.buf->drawInstanced( (GLsizei) batch.count, p.lod );
+		}
+	}
+}
+
 ///
 /// Display the current image
 ///
@@ -364,82 +958,231 @@ static void display( void )
 	// check for any errors to this point
 	checkErrors( "display init" );
 
-	// draw the individual objects
+	// the camera, projection, and lighting are the same for every
+	// object, so send them once per frame; this is a single buffer
+	// update (if anything changed) for programs using the shared block
+	updateFrameData();
+
+	if( !flatShared ) {
+		glUseProgram( flat );
+		setCamera( flat );
+		setProjection( flat );
+		setLighting( flat );
+	}
+	if( !textureShared ) {
+		glUseProgram( texture );
+		setCamera( texture );
+		setProjection( texture );
+		setLighting( texture );
+	}
+	checkErrors( "display frame data" );
+
+	// start a new set of draw packets
+	queue.clear();
+
+	glm::mat4 view = cameraMatrix();
+
+	// transformations for the objects in the original farm
+	glm::mat4 base[N_OBJECTS];
 	for( int obj = SiloBody; obj < N_OBJECTS; ++obj ) {
+		base[obj] = objectTransform( obj );
+	}
 
-		// select the proper shader program
-		GLuint program = map_obj[obj] ? texture : flat;
-		glUseProgram( program );
+	glm::mat4 proj = projectionMatrix();
+	glm::mat4 projView = proj * view;
+
+	// pixels covered by one unit at a distance of one unit, for
+	// choosing levels of detail
+	int fw, fh;
+	glfwGetFramebufferSize( w_window, &fw, &fh );
+	float pixelScale = 0.5f * fh * proj[1][1];
+	bool occlude = occluding && useOcclusion;
+
+	// the tessellated cylinders divide their edges to suit the same scale
+	bool tessellate = tessellating && useTessellation;
+	if( tessellate ) {
+		glUseProgram( tessFlat );
+		glUniform1f( tessFlatScale, pixelScale );
+		glUseProgram( tessTexture );
+		glUniform1f( tessTextureScale, pixelScale );
+	}
+	tessObjects = 0;
 
-		// set up the common transformations
-		setCamera( program );
-		setProjection( program );
-		checkErrors( "display camera" );
+	// gather every object in every farm, and its world-space bounds
+	farmObjects.clear();
+	cullSet.clear();
 
-		// and our lighting
-		setLighting( program );
-		checkErrors( "display lighting" );
+	for( int i = 0; i < farmSize; ++i ) {
+		for( int j = 0; j < farmSize; ++j ) {
 
-		// set texture parameters OR material properties
-		setMaterials( program, (Object) obj, map_obj[obj] );
-		checkErrors( "display materials" );
+			// farms are laid out across and away from the camera
+			glm::vec4 offset( (i - (farmSize - 1) * 0.5f) * farmSpacing,
+							  0.0f, -j * farmSpacing, 0.0f );
 
-		// select the correct rotation angles
-		glm::vec3 ang( angles[obj], angles[obj], angles[obj] );
+			for( int obj = SiloBody; obj < N_OBJECTS; ++obj ) {
 
-		// send all the transformation data
-		switch( obj ) {
+				if( getBuffers( (Object) obj ) == nullptr ) {
+					continue;
+				}
 
-        case SiloBody:
-            setTransforms( program, siloBody_s, ang, siloBody_x );
-			break;
-        case SiloRoof:
-            setTransforms( program, siloRoof_s, ang, siloRoof_x );
-			break;
+				FarmObject f;
+				f.obj = (Object) obj;
+				f.model = base[obj];
+				f.model[3] += offset;
+				farmObjects.push_back( f );
 
+				if( useCulling || occlude || useSoftOcclusion ) {
+					cullSet.add( getBounds( f.obj ), f.model );
+				}
+			}
+		}
+	}
 
-        case MainBarnBody:
-            setTransforms( program, mainBarnBody_s, ang, mainBarnBody_x );
-			break;
-        case MainBarnRoof:
-            setTransforms( program, mainBarnRoof_s, ang, mainBarnRoof_x );
-			break;
+	// drop the ones the camera can't see
+	if( useCulling ) {
+		cullSet.cull( projView );
+	}
 
+	// draw the big objects that are left into the software depth
+	// buffer, and find the objects they hide
+	if( useSoftOcclusion ) {
+		double start = glfwGetTime();
+
+		softOcclusion.begin( projView );
+		for( size_t k = 0; k < farmObjects.size(); ++k ) {
+			Bounds box;
+			if( (!useCulling || cullSet.visible[k]) &&
+				getOccluder( farmObjects[k].obj, box ) ) {
+				softOcclusion.addOccluder( box, farmObjects[k].model );
+			}
+		}
+		softOcclusion.rasterize();
 
-        case AltBarnBody:
-            setTransforms( program, altBarnBody_s, ang, altBarnBody_x );
-			break;
-        case AltBarnRoof:
-            setTransforms( program, altBarnRoof_s, ang, altBarnRoof_x );
-			break;
+		double mid = glfwGetTime();
 
+		softHidden.assign( farmObjects.size(), 0 );
+		for( size_t k = 0; k < farmObjects.size(); ++k ) {
+			if( !useCulling || cullSet.visible[k] ) {
+				softHidden[k] = softOcclusion.hidden( cullSet, k );
+			}
+		}
+
+		softRasterSeconds = mid - start;
+		softTestSeconds = glfwGetTime() - mid;
+	}
 
-        case MiniBarnBody:
-            setTransforms( program, miniBarnBody_s, ang, miniBarnBody_x );
-			break;
-        case MiniBarnRoof:
-            setTransforms( program, miniBarnRoof_s, ang, miniBarnRoof_x );
-			break;
+	// and find out what earlier frames showed was hidden
+	if( occlude ) {
+		occlusion.begin( farmObjects.size() );
+	}
 
+	// queue up a draw packet for each of the rest
+	if( farmLOD.size() != farmObjects.size() ) {
+		farmLOD.assign( farmObjects.size(), -1 );
+	}
+	lodTriangles = fullTriangles = 0;
+	for( int i = 0; i < MAX_LODS; ++i ) {
+		lodObjects[i] = 0;
+	}
 
-        case Floor:
-            setTransforms( program, road_s, road_r, road_x );
-			break;
+	for( size_t k = 0; k < farmObjects.size(); ++k ) {
+		if( useCulling && !cullSet.visible[k] ) {
+			continue;
+		}
 
+		if( useSoftOcclusion && softHidden[k] ) {
+			continue;
 		}
 
-		checkErrors( "display xforms" );
+		GLuint query = 0;
+		if( occlude &&
+			occlusion.test( cullSet, k, projView, query ) == OCC_HIDDEN ) {
+			continue;
+		}
 
-		// draw it
-		buffers[obj].selectBuffers( program,
-			"vPosition", NULL, "vNormal", 
-			map_obj[obj] ? "vTexCoord" : NULL );
-		checkErrors( "display select" );
+		Object obj = farmObjects[k].obj;
+		const glm::mat4 &model = farmObjects[k].model;
 
-		glDrawElements( GL_TRIANGLES, buffers[obj].numElements,
-						GL_UNSIGNED_INT, (void *) 0 );
-		checkErrors( "display draw" );
+		// objects with identical meshes share their buffers
+		BufferSet *buf = getBuffers( obj );
+
+		// select the proper shader program
+		GLuint program = map_obj[obj] ? texture : flat;
+
+		// view-space Z is negative in front of the camera
+		float depth = -(view * model[3]).z;
+
+		// the GPU decides how finely to draw a tessellated cylinder
+		int lod = 0;
+		if( tessellate && usesCage( obj ) ) {
+			buf = &cage;
+			program = map_obj[obj] ? tessTexture : tessFlat;
+			tessObjects += 1;
+		} else {
+			// farther away, a simpler mesh looks the same
+			if( useLOD && depth > 0.0f ) {
+				lod = selectLOD( obj,
+					pixelScale * modelScale( model ) / depth, farmLOD[k] );
+				farmLOD[k] = lod;
+			}
+			lodTriangles += triangles( buf, lod );
+			fullTriangles += triangles( buf, 0 );
+			lodObjects[lod] += 1;
+		}
+
+		queue.add( program, getMaterialID( obj ),
+				   map_obj[obj] ? getTexture( obj ) : 0,
+				   obj, buf, model, depth, query, lod );
+	}
+
+	// put them in the cheapest order to draw
+	queue.sort();
+
+	// cut the full meshes down to the meshlets that may be seen
+	if( useMeshlets ) {
+		double start = glfwGetTime();
+
+		// the camera is where the view matrix takes the origin from
+		glm::vec3 eye = -(glm::transpose( glm::mat3( view ) ) *
+			glm::vec3( view[3] ));
+		meshletCuller.begin( projView, eye );
+
+		for( size_t k = 0; k < queue.packets.size(); ++k ) {
+			DrawPacket &p = queue.packets[k];
+			const MeshletSet &m = getMeshlets( p.obj );
+			if( p.lod == 0 && p.buf == getBuffers( p.obj ) &&
+				m.numMeshlets >= MESHLET_MIN ) {
+				p.meshlets = meshletCuller.add( &m, p.model );
+			}
+		}
+		meshletCuller.cull();
+
+		meshletSeconds = glfwGetTime() - start;
+	}
+
+	if( instancing ) {
+		drawInstanced();
+	} else {
+		drawPackets();
+	}
+	checkErrors( "display draw" );
+
+	// test this frame's objects for the next ones
+	if( occlude ) {
+		occlusion.end( cullSet, useCulling ? cullSet.visible.data() : nullptr,
+			projView, fw, fh );
+		checkErrors( "display occlusion" );
+
+		// what this frame learns is only used by the next one, so keep
+		// drawing until the results stop changing
+		if( occlusion.settling() ) {
+			updateDisplay = true;
+		}
 	}
+
+	// go back to the default VAO so that any later buffer creation
+	// can't disturb the element binding of a cached one
+	glBindVertexArray( vao );
 }
 
 ///
@@ -482,6 +1225,43 @@ static bool init( void )
 	}
 	checkErrors( "init shaders 2" );
 
+	// hook both programs up to the shared per-frame uniform block
+	initFrameData();
+	flatShared = bindFrameData( flat );
+	textureShared = bindFrameData( texture );
+	checkErrors( "init frame data" );
+
+	// the cylinder bodies can be tessellated on the GPU, with programs
+	// of their own that share the flat and texture fragment shaders
+	if( useTessellation && gl_maj >= 4 ) {
+		tessFlat = shaderSetup( vs_c, fs_f, NULL, tc_c, te_c, error );
+		if( tessFlat ) {
+			tessTexture = shaderSetup( vs_c, fs_t, NULL, tc_c, te_c, error );
+		}
+		if( !tessFlat || !tessTexture ) {
+			cerr << "Error setting up tessellation shaders - "
+				 << errorString(error) << "; no GPU tessellation" << endl;
+		} else if( bindFrameData( tessFlat ) && bindFrameData( tessTexture ) ) {
+			tessFlatScale = glGetUniformLocation( tessFlat, "tessScale" );
+			tessTextureScale = glGetUniformLocation( tessTexture, "tessScale" );
+			glPatchParameteri( GL_PATCH_VERTICES, 4 );
+			tessellating = true;
+		}
+		checkErrors( "init tessellation" );
+	}
+
+	// occlusion culling draws bounding boxes with a program of its own
+	if( useOcclusion && (gl_maj > 3 || (gl_maj == 3 && gl_min >= 2)) ) {
+		proxy = shaderSetup( vs_p, fs_p, error );
+		if( !proxy ) {
+			cerr << "Error setting up proxy shader - "
+				 << errorString(error) << "; no occlusion culling" << endl;
+		} else if( bindFrameData( proxy ) ) {
+			occluding = occlusion.init( proxy );
+		}
+		checkErrors( "init occlusion" );
+	}
+
 #ifdef DEBUG
 	// Define the CPP symbol 'DEBUG' and recompile to enable the compilation
 	// of this code into your program for debugging purposes
@@ -498,9 +1278,10 @@ static bool init( void )
 		cerr << "Error - cannot create Canvas" << endl;
 		return( false );
 	}
+	canvas->storage().setHugePages( useHugePages );
 
-	// need a VAO if we're using a core context;
-	// doesn't hurt even if we're not using one
+	// need a VAO if we're using a core context; BufferSets build
+	// their own for drawing, but buffer creation needs one bound
 	glGenVertexArrays( 1, &vao );
 	glBindVertexArray( vao );
 	checkErrors( "init vao" );
@@ -513,6 +1294,54 @@ static bool init( void )
 	glClearDepth( 1.0f );
 	checkErrors( "init setup" );
 
+	// pack the vertex data if the hardware can read packed normals
+	if( usePacked &&
+		(GLEW_VERSION_3_3 || GLEW_ARB_vertex_type_2_10_10_10_rev) ) {
+		BufferSet::setLayout( LAYOUT_PACKED, false );
+	}
+
+	// use instanced drawing if both shader programs support it
+	if( useInstancing && (GLEW_VERSION_3_3 || GLEW_ARB_instanced_arrays) ) {
+		flatModelLoc = glGetAttribLocation( flat, "vModel" );
+		textureModelLoc = glGetAttribLocation( texture, "vModel" );
+		GLint flatSel = glGetUniformLocation( flat, "instanced" );
+		GLint textureSel = glGetUniformLocation( texture, "instanced" );
+		instancing = flatModelLoc >= 0 && textureModelLoc >= 0 &&
+			flatSel >= 0 && textureSel >= 0;
+
+		// the tessellation programs must be able to do it, too
+		GLint tessFlatSel = -1, tessTextureSel = -1;
+		if( instancing && tessellating ) {
+			tessFlatModelLoc = glGetAttribLocation( tessFlat, "vModel" );
+			tessTextureModelLoc = glGetAttribLocation( tessTexture, "vModel" );
+			tessFlatSel = glGetUniformLocation( tessFlat, "instanced" );
+			tessTextureSel = glGetUniformLocation( tessTexture, "instanced" );
+			instancing = tessFlatModelLoc >= 0 && tessTextureModelLoc >= 0 &&
+				tessFlatSel >= 0 && tessTextureSel >= 0;
+		}
+
+		if( instancing ) {
+			glUseProgram( flat );
+			glUniform1i( flatSel, GL_TRUE );
+			glUseProgram( texture );
+			glUniform1i( textureSel, GL_TRUE );
+			if( tessellating ) {
+				glUseProgram( tessFlat );
+				glUniform1i( tessFlatSel, GL_TRUE );
+				glUseProgram( tessTexture );
+				glUniform1i( tessTextureSel, GL_TRUE );
+			}
+		}
+	}
+	checkErrors( "init instancing" );
+
+	// set up the shared buffer arena if we can use it
+	if( useArena && (GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex) ) {
+		arena.createArena( arenaVertices, arenaIndices );
+		BufferSet::setArena( &arena );
+		checkErrors( "init arena" );
+	}
+
 	// create the geometry for our shapes.
 	createImage( *canvas );
 	checkErrors( "init image" );
@@ -523,6 +1352,7 @@ static bool init( void )
 
 	// register our callbacks
 	glfwSetKeyCallback( w_window, keyboard );
+	glfwSetWindowRefreshCallback( w_window, refresh );
 	checkErrors( "init callback" );
 
 	return( true );
@@ -554,15 +1384,59 @@ void application( void )
 
 	checkErrors( "after init" );
 
+	nextFrame = glfwGetTime();
+
 	// loop until it's time to quit
 	while( !glfwWindowShouldClose(w_window) ) {
-		animate();
+
+		// run an animation step if one is due
+		if( animationPending() ) {
+			double now = glfwGetTime();
+			if( now >= nextFrame ) {
+				animate();
+				// keep a steady cadence, but don't try to catch up
+				nextFrame += frameInterval;
+				if( nextFrame < now ) {
+					nextFrame = now + frameInterval;
+				}
+			}
+		}
+
 		if( updateDisplay ) {
 			updateDisplay = false;
 			display();
 			glfwSwapBuffers( w_window );
 			checkErrors( "event loop" );
 		}
-		glfwPollEvents();
+
+		// block until there is an event to handle, or until the next
+		// animation deadline if something is moving; if the last frame
+		// asked for another, wait no longer than a frame for events
+		if( updateDisplay ) {
+			glfwWaitEventsTimeout( frameInterval );
+		} else if( animationPending() ) {
+			double wait = nextFrame - glfwGetTime();
+			if( wait > 0.0 ) {
+				glfwWaitEventsTimeout( wait );
+			} else {
+				glfwPollEvents();
+			}
+		} else {
+			glfwWaitEvents();
+			// restart the animation clock from now
+			nextFrame = glfwGetTime();
+		}
+
+		// was there any work for us when we woke up?
+		if( updateDisplay ||
+			(animationPending() && glfwGetTime() >= nextFrame) ) {
+			activeWakeups += 1;
+		} else {
+			idleWakeups += 1;
+		}
 	}
+
+#ifdef DEBUG
+	printStats();
+#endif
 }
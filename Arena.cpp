@@ -0,0 +1,172 @@
+//
+//  Arena.cpp
+//
+//  A resettable memory arena for geometry storage.
+//
+
+#include <cstdlib>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "Arena.h"
+
+///
+/// Constructor
+///
+/// @param size   default chunk size (bytes)
+///
+MemArena::MemArena( size_t size ) {
+	chunkSize = size;
+	wantSize = 0;
+	used = 0;
+	hugePages = false;
+	reserved = 0;
+	inUse = 0;
+	resetStats();
+}
+
+///
+/// Destructor
+///
+MemArena::~MemArena( void ) {
+	release();
+}
+
+///
+/// newChunk(size) - get another chunk from the system
+///
+/// @param size   minimum chunk size (bytes)
+///
+void MemArena::newChunk( size_t size ) {
+	chunk c;
+
+	c.size = size < chunkSize ? chunkSize : size;
+	c.base = nullptr;
+	c.mapped = false;
+
+#if defined(__linux__)
+	if( hugePages && c.size >= HUGE_PAGE_SIZE ) {
+		// round up to a whole number of huge pages
+		c.size = (c.size + HUGE_PAGE_SIZE - 1) & ~(size_t) (HUGE_PAGE_SIZE - 1);
+
+		// explicit huge pages, if the system has any set aside;
+		// otherwise, ask for transparent huge pages
+		void *p = mmap( nullptr, c.size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+		if( p == MAP_FAILED ) {
+			p = mmap( nullptr, c.size, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+			if( p != MAP_FAILED ) {
+				madvise( p, c.size, MADV_HUGEPAGE );
+			}
+		}
+		if( p != MAP_FAILED ) {
+			c.base = (char *) p;
+			c.mapped = true;
+		}
+	}
+#endif
+
+	if( c.base == nullptr ) {
+		c.base = (char *) malloc( c.size );
+		if( c.base == nullptr ) {
+			cerr << "MemArena: cannot allocate " << c.size << " bytes" << endl;
+			exit( 1 );
+		}
+	}
+
+	chunks.push_back( c );
+	used = 0;
+	reserved += c.size;
+	chunkAllocations += 1;
+}
+
+///
+/// allocate(bytes,align) - get memory from the arena
+///
+/// @param bytes   how much is needed
+/// @param align   required alignment (a power of two)
+///
+/// @return the address of the memory
+///
+void *MemArena::allocate( size_t bytes, size_t align ) {
+
+	// after a reset that left several chunks, start over with one
+	// chunk big enough for all of them
+	if( chunks.empty() ) {
+		newChunk( wantSize > bytes + align ? wantSize : bytes + align );
+		wantSize = 0;
+	}
+
+	chunk *c = &chunks.back();
+	size_t start = ((size_t) c->base + used + align - 1) & ~(align - 1);
+	start -= (size_t) c->base;
+
+	if( start + bytes > c->size ) {
+		newChunk( bytes + align );
+		c = &chunks.back();
+		start = ((size_t) c->base + align - 1) & ~(align - 1);
+		start -= (size_t) c->base;
+	}
+
+	used = start + bytes;
+	inUse += bytes;
+	if( inUse > peakBytes ) {
+		peakBytes = inUse;
+	}
+	allocations += 1;
+
+	return( c->base + start );
+}
+
+///
+/// reset() - make all of the arena's memory available again
+///
+/// Everything previously allocated from the arena becomes invalid.
+///
+void MemArena::reset( void ) {
+
+	if( chunks.size() > 1 ) {
+		// coalesce on the next allocation
+		size_t total = reserved;
+		release();
+		wantSize = total;
+	}
+
+	used = 0;
+	inUse = 0;
+}
+
+///
+/// release() - return all memory to the system
+///
+void MemArena::release( void ) {
+
+	for( size_t i = 0; i < chunks.size(); ++i ) {
+#if defined(__linux__)
+		if( chunks[i].mapped ) {
+			munmap( chunks[i].base, chunks[i].size );
+			continue;
+		}
+#endif
+		free( chunks[i].base );
+	}
+
+	chunks.clear();
+	used = 0;
+	inUse = 0;
+	reserved = 0;
+	wantSize = 0;
+}
+
+///
+/// resetStats() - start collecting statistics afresh
+///
+void MemArena::resetStats( void ) {
+	peakBytes = inUse;
+	allocations = 0;
+	chunkAllocations = 0;
+}
@@ -0,0 +1,169 @@
+//
+//  Arena.h
+//
+//  A resettable memory arena for geometry storage.
+//
+//  Memory is handed out by bumping a pointer through large chunks
+//  obtained from the system.  Individual allocations are never freed;
+//  instead, reset() makes all of the memory available again at once,
+//  keeping the chunks for reuse.  If more than one chunk was needed,
+//  they are replaced by a single chunk of the combined size the next
+//  time memory is requested, so a repeated build settles into one
+//  contiguous block.
+//
+//  Chunks of at least HUGE_PAGE_SIZE bytes can optionally be backed
+//  by huge pages (Linux only; elsewhere, ordinary memory is used).
+//
+//  ArenaAllocator lets standard containers draw their storage from
+//  an arena.
+//
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+//
+// Default chunk size, and the size of a huge page
+//
+#define ARENA_CHUNK     (1024 * 1024)
+#define HUGE_PAGE_SIZE  (2 * 1024 * 1024)
+
+class MemArena {
+
+public:
+	// bytes currently handed out, and the most ever handed out at once
+	size_t inUse, peakBytes;
+
+	// bytes obtained from the system (currently held)
+	size_t reserved;
+
+	// number of allocations from the arena, and from the system
+	long allocations, chunkAllocations;
+
+private:
+	struct chunk {
+		char *base;
+		size_t size;
+		bool mapped;     // obtained with mmap() rather than malloc()
+	};
+
+	vector<chunk> chunks;
+
+	// how much of the last chunk has been used
+	size_t used;
+
+	// size of new chunks, and the size to coalesce into after a reset
+	size_t chunkSize, wantSize;
+
+	// back big chunks with huge pages?
+	bool hugePages;
+
+public:
+
+	///
+	/// Constructor
+	///
+	/// @param size   default chunk size (bytes)
+	///
+	MemArena( size_t size = ARENA_CHUNK );
+
+	///
+	/// Destructor
+	///
+	~MemArena( void );
+
+	///
+	/// allocate(bytes,align) - get memory from the arena
+	///
+	/// @param bytes   how much is needed
+	/// @param align   required alignment (a power of two)
+	///
+	/// @return the address of the memory
+	///
+	void *allocate( size_t bytes, size_t align = 16 );
+
+	///
+	/// reset() - make all of the arena's memory available again
+	///
+	/// Everything previously allocated from the arena becomes invalid.
+	///
+	void reset( void );
+
+	///
+	/// release() - return all memory to the system
+	///
+	void release( void );
+
+	///
+	/// setHugePages(on) - select whether big chunks use huge pages
+	///
+	/// @param on   true to use huge pages where possible
+	///
+	void setHugePages( bool on ) { hugePages = on; }
+
+	///
+	/// usesHugePages() - are big chunks using huge pages?
+	///
+	/// @return true if huge pages are used where possible
+	///
+	bool usesHugePages( void ) { return( hugePages ); }
+
+	///
+	/// resetStats() - start collecting statistics afresh
+	///
+	void resetStats( void );
+
+private:
+
+	///
+	/// newChunk(size) - get another chunk from the system
+	///
+	/// @param size   minimum chunk size (bytes)
+	///
+	void newChunk( size_t size );
+
+};
+
+///
+/// Standard allocator that draws from a MemArena.  Deallocation does
+/// nothing; the memory comes back when the arena is reset.
+///
+template <typename T>
+class ArenaAllocator {
+
+public:
+	typedef T value_type;
+	typedef true_type propagate_on_container_copy_assignment;
+	typedef true_type propagate_on_container_move_assignment;
+	typedef true_type propagate_on_container_swap;
+
+	MemArena *arena;
+
+	ArenaAllocator( MemArena *a ) : arena( a ) {}
+
+	template <typename U>
+	ArenaAllocator( const ArenaAllocator<U> &other ) : arena( other.arena ) {}
+
+	T *allocate( size_t n ) {
+		return( (T *) arena->allocate( n * sizeof(T), alignof(T) ) );
+	}
+
+	void deallocate( T *, size_t ) {}
+
+	template <typename U>
+	bool operator==( const ArenaAllocator<U> &other ) const {
+		return( arena == other.arena );
+	}
+
+	template <typename U>
+	bool operator!=( const ArenaAllocator<U> &other ) const {
+		return( arena != other.arena );
+	}
+};
+
+#endif
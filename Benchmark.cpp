@@ -0,0 +1,243 @@
+//
+//  Benchmark.cpp
+//
+//  Timing tests for the vertex data paths.
+//
+//  The layout test builds a heavily tessellated mesh, draws it
+//  repeatedly with rasterization turned off (so that only vertex
+//  fetching and vertex shading are measured), and reports the time
+//  per draw.  glFinish() brackets each timed section so that the GPU
+//  work is included in the wall-clock time.
+//
+//  The triangle test times building a large mesh in a Canvas one
+//  triangle at a time and in bulk; it involves no GL calls.
+//
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "Buffers.h"
+#include "Canvas.h"
+#include "Utils.h"
+
+using namespace std;
+
+// PRIVATE GLOBALS
+
+// grid size (in quads per side) of the test mesh
+static const int benchTess = 400;
+
+// number of timed draws per test
+static const int benchReps = 20;
+
+// grid size (in quads) of the triangle test mesh:  1M triangles
+static const int triCols = 1000;
+static const int triRows = 500;
+
+// PRIVATE FUNCTIONS
+
+///
+/// Fill a Canvas with an n x n grid of quads in the XY plane,
+/// with normals and texture coordinates
+///
+/// @param C   the Canvas to fill
+/// @param n   number of quads along each side
+///
+static void makeGrid( Canvas &C, int n )
+{
+	Normal nn = { 0.0f, 0.0f, 1.0f };
+	float step = 2.0f / n;
+
+	C.clear();
+	for( int i = 0; i < n; ++i ) {
+		for( int j = 0; j < n; ++j ) {
+			float x0 = -1.0f + i * step, x1 = x0 + step;
+			float y0 = -1.0f + j * step, y1 = y0 + step;
+			float u0 = (float) i / n, u1 = (float) (i + 1) / n;
+			float v0 = (float) j / n, v1 = (float) (j + 1) / n;
+
+			Vertex p0 = { x0, y0, 0.0f, 1.0f };
+			Vertex p1 = { x1, y0, 0.0f, 1.0f };
+			Vertex p2 = { x1, y1, 0.0f, 1.0f };
+			Vertex p3 = { x0, y1, 0.0f, 1.0f };
+
+			C.addTriangleWithNorms( p0, nn, p1, nn, p2, nn );
+			C.addTextureCoords( TexCoord{u0, v0}, TexCoord{u1, v0},
+				TexCoord{u1, v1} );
+			C.addTriangleWithNorms( p0, nn, p2, nn, p3, nn );
+			C.addTextureCoords( TexCoord{u0, v0}, TexCoord{u1, v1},
+				TexCoord{u0, v1} );
+		}
+	}
+}
+
+///
+/// Time repeated draws of a BufferSet
+///
+/// @param B         the BufferSet to draw
+/// @param program   shader program to draw with
+/// @param full      use all attributes (else, positions only)
+/// @return average time per draw, in milliseconds
+///
+static double timeDraws( BufferSet &B, GLuint program, bool full )
+{
+	// start from a fresh VAO, so that the attribute setup
+	// matches what we're asking for this time
+	B.deleteVAOs();
+	if( full ) {
+		B.selectBuffers( program, "vPosition", NULL, "vNormal", "vTexCoord" );
+	} else {
+		B.selectBuffers( program, "vPosition", NULL, NULL, NULL );
+	}
+
+	// one untimed draw to get everything resident
+	B.drawBuffers();
+	glFinish();
+
+	double start = glfwGetTime();
+	for( int i = 0; i < benchReps; ++i ) {
+		B.drawBuffers();
+	}
+	glFinish();
+	double elapsed = glfwGetTime() - start;
+
+	return( elapsed * 1000.0 / benchReps );
+}
+
+// PUBLIC FUNCTIONS
+
+///
+/// Compare the planar and interleaved BufferSet layouts, with all
+/// attributes and with positions only
+///
+/// @param program   shader program with vPosition, vNormal, and
+///                  vTexCoord attributes
+///
+void benchLayouts( GLuint program )
+{
+	static const struct {
+		const char *name;
+		Layout layout;
+		bool positions;
+	} tests[] = {
+		{ "planar",                LAYOUT_PLANAR,      false },
+		{ "interleaved",           LAYOUT_INTERLEAVED, false },
+		{ "interleaved+positions", LAYOUT_INTERLEAVED, true  },
+		{ "packed",                LAYOUT_PACKED,      false }
+	};
+
+	// remember the settings we're about to change
+	BufferSet *oldArena = BufferSet::sharedArena;
+	Layout oldLayout = BufferSet::defaultLayout;
+	bool oldPositions = BufferSet::defaultPositions;
+	GLint oldVAO;
+	glGetIntegerv( GL_VERTEX_ARRAY_BINDING, &oldVAO );
+
+	Canvas C( 1, 1 );
+	makeGrid( C, benchTess );
+	int nverts = C.numVertices();
+
+	cout << "Layout benchmark: " << (nverts / 3) << " triangles, "
+		 << benchReps << " draws per test" << endl;
+
+	glUseProgram( program );
+	glEnable( GL_RASTERIZER_DISCARD );
+
+	// each layout gets buffers of its own, outside the arena
+	BufferSet::setArena( nullptr );
+	for( const auto &t : tests ) {
+		BufferSet::setLayout( t.layout, t.positions );
+
+		BufferSet B;
+		B.createBuffers( C );
+
+		double full = timeDraws( B, program, true );
+		double pos = timeDraws( B, program, false );
+
+		cout << "  " << setw(22) << left << t.name << right
+			 << fixed << setprecision(3)
+			 << " all attributes " << setw(8) << full << " ms"
+			 << "  positions only " << setw(8) << pos << " ms"
+			 << "  (" << setprecision(1) << (nverts / full / 1000.0)
+			 << " Mverts/s)" << endl;
+		cout.unsetf( ios::fixed );
+
+		B.deleteVAOs();
+		B.deleteBuffers();
+	}
+
+	glDisable( GL_RASTERIZER_DISCARD );
+	checkErrors( "benchLayouts" );
+
+	// put everything back the way it was
+	BufferSet::setLayout( oldLayout, oldPositions );
+	BufferSet::setArena( oldArena );
+	glBindVertexArray( oldVAO );
+}
+
+///
+/// Compare adding a 1M-triangle mesh to a Canvas one triangle at a
+/// time with adding it through the bulk interface
+///
+void benchTriangles( void )
+{
+	// an indexed grid of vertices, the way the data tables hold them
+	vector<Vertex> verts;
+	vector<TexCoord> uvs;
+	vector<GLuint> tris;
+
+	verts.reserve( (triCols + 1) * (triRows + 1) );
+	uvs.reserve( (triCols + 1) * (triRows + 1) );
+	for( int j = 0; j <= triRows; ++j ) {
+		for( int i = 0; i <= triCols; ++i ) {
+			float u = (float) i / triCols, v = (float) j / triRows;
+			verts.push_back( Vertex{ u - 0.5f, v - 0.5f, u * v, 1.0f } );
+			uvs.push_back( TexCoord{ u, v } );
+		}
+	}
+
+	tris.reserve( triCols * triRows * 6 );
+	for( int j = 0; j < triRows; ++j ) {
+		for( int i = 0; i < triCols; ++i ) {
+			GLuint a = j * (triCols + 1) + i;
+			GLuint b = a + 1, c = a + triCols + 1, d = c + 1;
+			tris.insert( tris.end(), { a, b, d, a, d, c } );
+		}
+	}
+	int ntris = tris.size() / 3;
+
+	// each way gets a fresh Canvas, so neither runs on storage the
+	// other has already grown
+	double single, bulk;
+
+	// one triangle at a time
+	{
+		Canvas C( 1, 1 );
+		double start = glfwGetTime();
+		for( int t = 0; t < ntris; ++t ) {
+			GLuint *e = &tris[t*3];
+			C.addTriangle( verts[e[0]], verts[e[1]], verts[e[2]] );
+			C.addTextureCoords( uvs[e[0]], uvs[e[1]], uvs[e[2]] );
+		}
+		single = glfwGetTime() - start;
+	}
+
+	// all at once
+	{
+		Canvas C( 1, 1 );
+		double start = glfwGetTime();
+		C.addTriangles( verts.data(), tris.data(), ntris, uvs.data() );
+		bulk = glfwGetTime() - start;
+	}
+
+	cout << "Triangle benchmark: " << ntris << " triangles" << endl;
+	cout << fixed << setprecision(1)
+		 << "  addTriangle()   " << setw(8) << single * 1000.0 << " ms  ("
+		 << setw(6) << ntris / single / 1.0e6 << " Mtris/s)" << endl
+		 << "  addTriangles()  " << setw(8) << bulk * 1000.0 << " ms  ("
+		 << setw(6) << ntris / bulk / 1.0e6 << " Mtris/s)" << endl;
+	cout.unsetf( ios::fixed );
+}
@@ -0,0 +1,38 @@
+//
+//  Benchmark.h
+//
+//  Timing tests for the vertex data paths.
+//
+//  The layout test builds a heavily tessellated mesh, draws it
+//  repeatedly with rasterization turned off (so that only vertex
+//  fetching and vertex shading are measured), and reports the time
+//  per draw.  The triangle test times building a large mesh in a
+//  Canvas one triangle at a time and in bulk.
+//
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+///
+/// Compare the planar and interleaved BufferSet layouts, with all
+/// attributes and with positions only
+///
+/// @param program   shader program with vPosition, vNormal, and
+///                  vTexCoord attributes
+///
+void benchLayouts( GLuint program );
+
+///
+/// Compare adding a 1M-triangle mesh to a Canvas one triangle at a
+/// time with adding it through the bulk interface
+///
+void benchTriangles( void );
+
+#endif
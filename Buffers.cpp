@@ -10,8 +10,11 @@
 //  This file should not be modified by students.
 //
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
@@ -26,6 +29,73 @@
 #include "Buffers.h"
 #include "Utils.h"
 
+// the arena new meshes are placed in (nullptr if none)
+BufferSet *BufferSet::sharedArena = nullptr;
+
+// layout used for new buffers, and whether they get a
+// position-only stream
+Layout BufferSet::defaultLayout = LAYOUT_INTERLEAVED;
+bool BufferSet::defaultPositions = false;
+
+///
+/// enableAttrib(program,name,comps,type,stride,offset) - enable one
+///     vertex attribute array, if the program uses that attribute
+///
+/// Integer types are treated as normalized values.
+///
+/// @param program   GLSL program object
+/// @param name      name of the attribute variable
+/// @param comps     number of components per vertex
+/// @param type      data type of each component
+/// @param stride    distance between vertices (bytes)
+/// @param offset    where the data begins in the buffer (bytes)
+///
+static void enableAttrib( GLuint program, const char *name, GLint comps,
+	GLenum type, GLsizei stride, GLintptr offset ) {
+	GLint loc = getAttribLoc( program, name );
+	if( loc >= 0 ) {
+		GLboolean norm = (type == GL_FLOAT || type == GL_HALF_FLOAT) ?
+			GL_FALSE : GL_TRUE;
+		glEnableVertexAttribArray( loc );
+		glVertexAttribPointer( loc, comps, type, norm, stride,
+							   BUFFER_OFFSET(offset) );
+	}
+}
+
+///
+/// fillBuffer(target,offset,size,flags,fill) - have 'fill' write the
+///     contents of part of the buffer bound to 'target'
+///
+/// The region is mapped so that 'fill' can write straight into it; if
+/// mapping fails (or the contents are lost before it is unmapped), the
+/// data is written to a temporary copy and uploaded from there.
+///
+/// @param target   buffer binding point
+/// @param offset   where the region begins (bytes)
+/// @param size     length of the region (bytes)
+/// @param flags    extra glMapBufferRange() access flags
+/// @param fill     writes the data, given the destination address
+///
+template <typename Fill>
+static void fillBuffer( GLenum target, GLintptr offset, GLsizeiptr size,
+	GLbitfield flags, Fill fill ) {
+
+	void *dst = glMapBufferRange( target, offset, size,
+		GL_MAP_WRITE_BIT | flags );
+	if( dst != nullptr ) {
+		fill( dst );
+		if( glUnmapBuffer( target ) == GL_TRUE ) {
+			return;
+		}
+	}
+
+	cerr << "fillBuffer(): cannot map " << size
+		 << " bytes, uploading a copy" << endl;
+	vector<char> tmp( size );
+	fill( (void *) tmp.data() );
+	glBufferSubData( target, offset, size, tmp.data() );
+}
+
 ///
 /// Constructor
 ///
@@ -39,9 +109,29 @@ BufferSet::BufferSet( void ) {
 ///
 void BufferSet::initBuffer( void ) {
 	vbuffer = ebuffer = 0;
-	numElements = 0;
-	vSize = eSize = tSize = cSize = nSize = 0;
+	numElements = numIndices = 0;
+	indexType = GL_UNSIGNED_INT;
+	indexSize = sizeof(GLuint);
+	primitive = GL_TRIANGLES;
+	vSize = eSize = tSize = cSize = nSize = pSize = 0;
 	bufferInit = false;
+	layout = LAYOUT_PLANAR;
+	stride = 0;
+	vOffset = cOffset = nOffset = tOffset = pOffset = -1;
+	vComps = 4;
+	for( int i = 0; i < 3; ++i ) {
+		posScale[i] = 1.0f;
+		posOffset[i] = 0.0f;
+	}
+	packError.position = packError.normal = packError.uv = 0.0f;
+	numVAOs = 0;
+	arena = nullptr;
+	baseVertex = 0;
+	firstIndex = 0;
+	numLODs = 1;
+	lodFirst[0] = lodCount[0] = 0;
+	capVertices = capIndices = 0;
+	usedVertices = usedIndices = 0;
 }
 
 ///
@@ -56,9 +146,48 @@ void BufferSet::dumpBuffer( const char *which ) {
 	}
 	cout << "initialized)" << endl;
 	cout << "  IDs: v " << vbuffer << " e " << ebuffer <<
-		" #elements: " << numElements << endl;
+		" #elements: " << numElements << " #indices: " << numIndices <<
+		" (" << (indexType == GL_NONE ? "none" :
+				 indexType == GL_UNSIGNED_SHORT ? "16-bit" : "32-bit") <<
+		")" << endl;
 	cout << "  Sizes:  v " << vSize << " e " << eSize <<
-		" t " << tSize << " c " << cSize << " n " << nSize << endl;
+		" t " << tSize << " c " << cSize << " n " << nSize <<
+		" p " << pSize << endl;
+	cout << "  Layout: " <<
+		(layout == LAYOUT_PACKED ? "packed" :
+		 layout == LAYOUT_INTERLEAVED ? "interleaved" : "planar") <<
+		" stride " << stride << " offsets: v " << vOffset << " c " <<
+		cOffset << " n " << nOffset << " t " << tOffset << " p " <<
+		pOffset << endl;
+	if( layout == LAYOUT_PACKED ) {
+		cout << "  Decode: scale (" << posScale[0] << "," << posScale[1] <<
+			"," << posScale[2] << ") offset (" << posOffset[0] << "," <<
+			posOffset[1] << "," << posOffset[2] << ")" << endl;
+		cout << "  Packing error: position " << packError.position <<
+			" normal " << packError.normal << " deg uv " << packError.uv <<
+			endl;
+	}
+	if( numLODs > 1 ) {
+		cout << "  LODs:";
+		for( int i = 0; i < numLODs; ++i ) {
+			cout << " " << lodCount[i] << "@" << lodFirst[i];
+		}
+		cout << endl;
+	}
+	if( arena != nullptr ) {
+		cout << "  In arena: base vertex " << baseVertex
+			 << " first index " << firstIndex << endl;
+	}
+	if( capVertices > 0 ) {
+		cout << "  Arena: " << usedVertices << "/" << capVertices
+			 << " vertices, " << usedIndices << "/" << capIndices
+			 << " indices" << endl;
+	}
+	cout << "  VAOs:";
+	for( int i = 0; i < numVAOs; ++i ) {
+		cout << " " << vaos[i] << " (prog " << vaoPrograms[i] << ")";
+	}
+	cout << endl;
 }
 
 ///
@@ -90,9 +219,11 @@ void BufferSet::createBuffers( Canvas &C ) {
 
 	// reset this BufferSet if it has already been used
 	if( bufferInit ) {
-		// must delete the existing buffer IDs first
-		glDeleteBuffers( 1, &(vbuffer) );
-		glDeleteBuffers( 1, &(ebuffer) );
+		// must delete the existing buffer IDs first; the space used
+		// in an arena isn't reclaimed, but the arena's buffers stay
+		deleteBuffers();
+		// the VAOs refer to the old buffers, so they must go, too
+		deleteVAOs();
 		// clear everything out
 		initBuffer();
 	}
@@ -104,103 +235,628 @@ void BufferSet::createBuffers( Canvas &C ) {
 	// other fields may or may not be present; this depends on
 	// how the shape was created
 	//
+	// planar layout:
+	//
 	//             data        components   offset to beginning
 	//          [ locations ]  XYZW         0
 	//          [ colors    ]  RGBA         vSize
 	//          [ normals   ]  XYZ          vSize+cSize
 	//          [ t. coords ]  UV           vSize+cSize+nSize
 	//
+	// interleaved layout (one entry per vertex, 'stride' bytes each):
+	//
+	//          [ XYZ  normal XYZ  UV  RGBA ] [ XYZ ... ] ...
+	//          [ positions ]  XYZ          numElements*stride
+	//
+	// in the interleaved layout, the position-only stream is there
+	// only if it was requested
+	//
 
-	// get the vertex count
+	// get the vertex and index counts; these are the same unless
+	// the Canvas has welded its vertices
 	numElements = C.numVertices();
+	numIndices = C.numIndices();
+
+	// until we're told otherwise, they're all one level of detail
+	numLODs = 1;
+	lodFirst[0] = 0;
+	lodCount[0] = numIndices;
 
 	// if there are no vertices, there's nothing for us to do
 	if( numElements < 1 ) {
 		return;
 	}
 
-	// OK, we have vertices!
-	float *points = C.getVertices();
-	// #bytes = number of elements * 4 floats/element * bytes/float
-	vSize = numElements * 4 * sizeof(float);
+	// work out the sizes (and, for our own buffers, the placement)
+	// of each kind of data; nothing is copied out of the Canvas yet
+	layout = defaultLayout;
+	GLsizeiptr vbufSize = planLayout( C );
 
-	// accumulate the total vertex buffer size
-	GLsizeiptr vbufSize = vSize;
+	// choose how we'll draw:  without indices if the Canvas has
+	// none, else with the narrowest index type that will do
+	chooseIndexType( C );
+	// #bytes = number of elements * bytes/element
+	eSize = indexType == GL_NONE ? 0 : numIndices * indexSize;
 
-	// get the color data (if there is any)
-	float *colors = C.getColors();
-	if( colors != nullptr ) {
-		cSize = numElements * 4 * sizeof(float);
-		vbufSize += cSize;
+	// put the mesh in the shared arena if it matches the arena's
+	// layout and there's room for it; otherwise, it gets buffers
+	// of its own
+	BufferSet *a = sharedArena;
+	if( a != nullptr && fitsArena( a ) ) {
+
+		claimArena( a );
+
+		// the space we were given has never been drawn from, so
+		// there's no need to wait for the GPU before writing it
+		writeData( C, baseVertex, firstIndex,
+			GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT );
+
+		return;
 	}
 
-	// get the normal data (if there is any)
-	float *normals = C.getNormals();
-	if( normals != nullptr ) {
-		nSize = numElements * 3 * sizeof(float);
-		vbufSize += nSize;
+	// create the buffers without any contents; the data is written
+	// straight into them below.  the copy-write target is used so
+	// that the element binding of the current VAO isn't disturbed
+	if( eSize > 0 ) {
+		ebuffer = makeBuffer( GL_COPY_WRITE_BUFFER, nullptr, eSize );
 	}
+	vbuffer = makeBuffer( GL_COPY_WRITE_BUFFER, nullptr, vbufSize );
 
-	// get the (u,v) data (if there is any)
-	float *uv = C.getUV();
-	if( uv != nullptr ) {
-		tSize = numElements * 2 * sizeof(float);
-		vbufSize += tSize;
+	writeData( C, 0, 0, GL_MAP_INVALIDATE_RANGE_BIT );
+
+	// finally, mark it as set up
+	bufferInit = true;
+}
+
+///
+/// planLayout(C) - work out the size of each kind of vertex data the
+///     Canvas holds, and where it goes in a buffer of our own
+///
+/// @param C     the Canvas we'll use for drawing
+///
+/// @return the total vertex buffer size (bytes)
+///
+GLsizeiptr BufferSet::planLayout( Canvas &C ) {
+
+	if( layout == LAYOUT_PACKED ) {
+		// everything is in one block; locations are stored relative
+		// to the center of the bounding box
+		float lo[3], hi[3];
+		C.getBounds( lo, hi );
+		for( int i = 0; i < 3; ++i ) {
+			posOffset[i] = (lo[i] + hi[i]) * 0.5f;
+			posScale[i] = (hi[i] - lo[i]) * 0.5f;
+			if( posScale[i] <= 0.0f ) {
+				posScale[i] = 1.0f;
+			}
+		}
+
+		stride = C.packedSize();
+		vComps = 4;
+		vOffset = 0;
+		vSize = numElements * 4 * sizeof(GLshort);
+		GLintptr offset = 4 * sizeof(GLshort);
+		if( C.hasNormals() ) {
+			nOffset = offset;
+			nSize = numElements * sizeof(GLuint);
+			offset += sizeof(GLuint);
+		}
+		if( C.hasUV() ) {
+			tOffset = offset;
+			tSize = numElements * 2 * sizeof(GLushort);
+			offset += 2 * sizeof(GLushort);
+		}
+		if( C.hasColors() ) {
+			cOffset = offset;
+			cSize = numElements * 4 * sizeof(GLubyte);
+			offset += 4 * sizeof(GLubyte);
+		}
+
+		return( (GLsizeiptr) numElements * stride );
 	}
 
-	// get the element data
-	GLuint *elements = C.getElements();
-	// #bytes = number of elements * bytes/element
-	eSize = numElements * sizeof(GLuint);
+	if( layout == LAYOUT_INTERLEAVED ) {
+		// everything but the position stream is in one block
+		stride = C.interleavedFloats() * sizeof(float);
+		vComps = 3;
+		vOffset = 0;
+		vSize = numElements * 3 * sizeof(float);
+		GLintptr offset = 3 * sizeof(float);
+		if( C.hasNormals() ) {
+			nOffset = offset;
+			nSize = numElements * 3 * sizeof(float);
+			offset += 3 * sizeof(float);
+		}
+		if( C.hasUV() ) {
+			tOffset = offset;
+			tSize = numElements * 2 * sizeof(float);
+			offset += 2 * sizeof(float);
+		}
+		if( C.hasColors() ) {
+			cOffset = offset;
+			cSize = numElements * 4 * sizeof(float);
+			offset += 4 * sizeof(float);
+		}
 
-	// first, create the connectivity data
-	ebuffer = makeBuffer( GL_ELEMENT_ARRAY_BUFFER, elements, eSize );
+		GLsizeiptr blockSize = (GLsizeiptr) numElements * stride;
 
-	// next, the vertex buffer, containing vertices and "extra" data
-	// note that we use glBufferSubData() calls to do the copying
-	vbuffer = makeBuffer( GL_ARRAY_BUFFER, nullptr, vbufSize );
+		// the separate position stream, if we want one
+		if( defaultPositions ) {
+			pOffset = blockSize;
+			pSize = numElements * 3 * sizeof(float);
+		}
 
-	// copy in the location data
-	glBufferSubData( GL_ARRAY_BUFFER, 0, vSize, points );
+		return( blockSize + pSize );
+	}
 
-	// offsets to subsequent sections are the sum of
-	// the preceding section sizes (in bytes)
+	// planar: each section follows the ones before it
+	vComps = 4;
+	vOffset = 0;
+	// #bytes = number of elements * 4 floats/element * bytes/float
+	vSize = numElements * 4 * sizeof(float);
 	GLintptr offset = vSize;
 
-	// add in the color data (if there is any)
-	if( cSize > 0 ) {
-		glBufferSubData( GL_ARRAY_BUFFER, offset, cSize, colors );
+	if( C.hasColors() ) {
+		cOffset = offset;
+		cSize = numElements * 4 * sizeof(float);
 		offset += cSize;
 	}
-
-	// add in the normal data (if there is any)
-	if( nSize > 0 ) {
-		glBufferSubData( GL_ARRAY_BUFFER, offset, nSize, normals );
+	if( C.hasNormals() ) {
+		nOffset = offset;
+		nSize = numElements * 3 * sizeof(float);
 		offset += nSize;
 	}
-
-	// add in the (u,v) data (if there is any)
-	if( tSize > 0 ) {
-		glBufferSubData( GL_ARRAY_BUFFER, offset, tSize, uv );
+	if( C.hasUV() ) {
+		tOffset = offset;
+		tSize = numElements * 2 * sizeof(float);
 		offset += tSize;
 	}
 
-	// sanity check!
-	if( offset != vbufSize ) {
-		cerr << "*** createBuffers: size mismatch, offset "
-			<< offset << " vbufSize " << vbufSize << endl;
+	return( offset );
+}
+
+///
+/// chooseIndexType(C) - decide how the mesh held in the Canvas will
+///     be drawn
+///
+/// Unwelded data has sequential indices, so it's drawn without any;
+/// otherwise 16-bit indices are used if every vertex can be reached
+/// with one, else 32-bit indices.
+///
+/// @param C     the Canvas we'll use for drawing
+///
+void BufferSet::chooseIndexType( Canvas &C ) {
+	if( !C.isIndexed() ) {
+		indexType = GL_NONE;
+		indexSize = 0;
+	} else if( numElements <= 65536 ) {
+		indexType = GL_UNSIGNED_SHORT;
+		indexSize = sizeof(GLushort);
+	} else {
+		indexType = GL_UNSIGNED_INT;
+		indexSize = sizeof(GLuint);
 	}
+}
 
-	// NOTE:  'points', 'colors', and 'elements' are dynamically allocated,
-	// but we don't free them here because they will be freed at the next
-	// call to clear() or the get*() functions
+///
+/// fitsArena(a) - determine whether this mesh can be placed in an arena
+///
+/// A planar arena has no color section; an interleaved or packed one
+/// holds exactly location, normal, and (u,v) data for each vertex.
+///
+/// @param a     the arena
+///
+/// @return true if the mesh matches the arena and there is room
+///
+bool BufferSet::fitsArena( BufferSet *a ) {
+
+	if( a->layout != layout || cSize > 0 ) {
+		return( false );
+	}
+
+	if( layout != LAYOUT_PLANAR &&
+		(stride != a->stride || nSize == 0 || tSize == 0 ||
+		 (pSize > 0) != (a->pSize > 0)) ) {
+		return( false );
+	}
+
+	// the arena's indices are all the same width; its meshes
+	// either use that or have none
+	if( indexType != GL_NONE && indexType != a->indexType ) {
+		return( false );
+	}
+
+	GLsizei indices = indexType == GL_NONE ? 0 : numIndices;
+
+	return( a->usedVertices + numElements <= a->capVertices &&
+			a->usedIndices + indices <= a->capIndices );
+}
+
+///
+/// writeData(C,base,first,flags) - copy the Canvas data directly into
+///     our (already allocated) vertex and element buffers
+///
+/// Each region is mapped and the Canvas writes into it, so the only
+/// copy made is the one into the buffer itself.
+///
+/// @param C       the Canvas we'll use for drawing
+/// @param base    vertex number at which our vertices begin
+/// @param first   index number at which our indices begin
+/// @param flags   extra glMapBufferRange() access flags
+///
+void BufferSet::writeData( Canvas &C, GLint base, GLsizei first,
+	GLbitfield flags ) {
+
+	glBindBuffer( GL_COPY_WRITE_BUFFER, vbuffer );
+
+	if( layout == LAYOUT_PACKED ) {
+		fillBuffer( GL_COPY_WRITE_BUFFER, vOffset + base * stride,
+			(GLsizeiptr) numElements * stride, flags,
+			[&]( void *dst ) {
+				C.writePacked( dst, posScale, posOffset, packError );
+			} );
+	} else if( layout == LAYOUT_INTERLEAVED ) {
+		fillBuffer( GL_COPY_WRITE_BUFFER, vOffset + base * stride,
+			(GLsizeiptr) numElements * stride, flags,
+			[&]( void *dst ) { C.writeInterleaved( (float *) dst ); } );
+		if( pSize > 0 ) {
+			fillBuffer( GL_COPY_WRITE_BUFFER,
+				pOffset + base * 3 * sizeof(float), pSize, flags,
+				[&]( void *dst ) { C.writePositions( (float *) dst ); } );
+		}
+	} else {
+		fillBuffer( GL_COPY_WRITE_BUFFER,
+			vOffset + base * 4 * sizeof(float), vSize, flags,
+			[&]( void *dst ) { C.writeVertices( (float *) dst ); } );
+		if( cSize > 0 ) {
+			fillBuffer( GL_COPY_WRITE_BUFFER,
+				cOffset + base * 4 * sizeof(float), cSize, flags,
+				[&]( void *dst ) { C.writeColors( (float *) dst ); } );
+		}
+		if( nSize > 0 ) {
+			fillBuffer( GL_COPY_WRITE_BUFFER,
+				nOffset + base * 3 * sizeof(float), nSize, flags,
+				[&]( void *dst ) { C.writeNormals( (float *) dst ); } );
+		}
+		if( tSize > 0 ) {
+			fillBuffer( GL_COPY_WRITE_BUFFER,
+				tOffset + base * 2 * sizeof(float), tSize, flags,
+				[&]( void *dst ) { C.writeUV( (float *) dst ); } );
+		}
+	}
+
+	if( indexType == GL_NONE ) {
+		return;
+	}
+
+	glBindBuffer( GL_COPY_WRITE_BUFFER, ebuffer );
+	if( indexType == GL_UNSIGNED_SHORT ) {
+		fillBuffer( GL_COPY_WRITE_BUFFER, first * indexSize, eSize, flags,
+			[&]( void *dst ) { C.writeElements( (GLushort *) dst ); } );
+	} else {
+		fillBuffer( GL_COPY_WRITE_BUFFER, first * indexSize, eSize, flags,
+			[&]( void *dst ) { C.writeElements( (GLuint *) dst ); } );
+	}
+}
+
+///
+/// claimArena(a) - reserve space in an arena for this BufferSet's
+///     vertices and indices
+///
+/// @param a     the arena
+///
+void BufferSet::claimArena( BufferSet *a ) {
+	arena = a;
+	baseVertex = a->usedVertices;
+	firstIndex = a->usedIndices;
+	a->usedVertices += numElements;
+	if( indexType != GL_NONE ) {
+		a->usedIndices += numIndices;
+	}
+
+	// we draw using the arena's buffers and data layout
+	vbuffer = a->vbuffer;
+	ebuffer = a->ebuffer;
+	stride = a->stride;
+	vOffset = a->vOffset;
+	cOffset = a->cOffset;
+	nOffset = a->nOffset;
+	tOffset = a->tOffset;
+	pOffset = a->pOffset;
+	vComps = a->vComps;
+	bufferInit = true;
+}
+
+///
+/// createArena(maxVerts,maxIndices) - turn this BufferSet into an
+///     arena that can hold the data for many meshes
+///
+/// The arena uses the current default layout without colors; a
+/// planar arena has each section sized for maxVerts vertices,
+/// while an interleaved one holds location, normal, and texture
+/// coordinates for each vertex.
+///
+/// @param maxVerts     vertex capacity
+/// @param maxIndices   index capacity
+///
+void BufferSet::createArena( GLsizei maxVerts, GLsizei maxIndices ) {
+
+	if( bufferInit ) {
+		deleteBuffers();
+		deleteVAOs();
+		initBuffer();
+	}
+
+	layout = defaultLayout;
+
+	if( layout == LAYOUT_PACKED ) {
+		stride = 4 * sizeof(GLshort) + sizeof(GLuint) + 2 * sizeof(GLushort);
+		vComps = 4;
+		vOffset = 0;
+		nOffset = 4 * sizeof(GLshort);
+		tOffset = nOffset + sizeof(GLuint);
+		vSize = maxVerts * 4 * sizeof(GLshort);
+		nSize = maxVerts * sizeof(GLuint);
+		tSize = maxVerts * 2 * sizeof(GLushort);
+	} else if( layout == LAYOUT_INTERLEAVED ) {
+		stride = 8 * sizeof(float);
+		vComps = 3;
+		vOffset = 0;
+		nOffset = 3 * sizeof(float);
+		tOffset = 6 * sizeof(float);
+		vSize = maxVerts * 3 * sizeof(float);
+		nSize = maxVerts * 3 * sizeof(float);
+		tSize = maxVerts * 2 * sizeof(float);
+		if( defaultPositions ) {
+			pOffset = vSize + nSize + tSize;
+			pSize = maxVerts * 3 * sizeof(float);
+		}
+	} else {
+		vComps = 4;
+		vSize = maxVerts * 4 * sizeof(float);
+		nSize = maxVerts * 3 * sizeof(float);
+		tSize = maxVerts * 2 * sizeof(float);
+		vOffset = 0;
+		nOffset = vSize;
+		tOffset = vSize + nSize;
+	}
+	// each mesh's indices are relative to its base vertex, so 16
+	// bits are enough for any mesh that can use them at all
+	indexType = GL_UNSIGNED_SHORT;
+	indexSize = sizeof(GLushort);
+	eSize = maxIndices * indexSize;
+
+	ebuffer = makeBuffer( GL_ELEMENT_ARRAY_BUFFER, nullptr, eSize );
+	vbuffer = makeBuffer( GL_ARRAY_BUFFER, nullptr,
+		vSize + nSize + tSize + pSize );
+
+	capVertices = maxVerts;
+	capIndices = maxIndices;
 
-	// finally, mark it as set up
 	bufferInit = true;
 }
 
 ///
-/// selectBuffers() - bind the correct vertex and element buffers
+/// setArena(arena) - select the arena that subsequent calls to
+///     createBuffers() will place their data in
+///
+/// @param a     the arena, or nullptr for separate buffers
+///
+void BufferSet::setArena( BufferSet *a ) {
+	sharedArena = a;
+}
+
+///
+/// setLayout(layout,positions) - select the layout that subsequent
+///     calls to createBuffers() and createArena() will use
+///
+/// @param l           the vertex layout
+/// @param positions   also create a position-only stream?
+///
+void BufferSet::setLayout( Layout l, bool positions ) {
+	defaultLayout = l;
+	defaultPositions = positions;
+}
+
+///
+/// setLODs(n,counts) - divide our indices into levels of detail
+///
+/// The index list of the Canvas the buffers were created from must
+/// have held the levels one after another, starting with the whole
+/// mesh; afterward, numIndices is the size of level 0.
+///
+/// @param n        number of levels (at most MAX_LODS)
+/// @param counts   number of indices in each level
+///
+void BufferSet::setLODs( int n, const GLsizei counts[] ) {
+	GLsizei total = 0;
+
+	// drawn without indices, there is only the whole mesh
+	if( indexType == GL_NONE || n < 1 ) {
+		return;
+	}
+
+	numLODs = std::min( n, MAX_LODS );
+	for( int i = 0; i < numLODs; ++i ) {
+		lodFirst[i] = total;
+		lodCount[i] = counts[i];
+		total += counts[i];
+	}
+	numIndices = lodCount[0];
+}
+
+///
+/// deleteBuffers() - release the buffers (but not the VAOs) of
+///     this BufferSet, unless they belong to an arena
+///
+void BufferSet::deleteBuffers( void ) {
+	if( arena == nullptr ) {
+		glDeleteBuffers( 1, &(vbuffer) );
+		glDeleteBuffers( 1, &(ebuffer) );
+	}
+	vbuffer = ebuffer = 0;
+}
+
+///
+/// lodRange(lod,first,count) - find the indices of a level of detail
+///
+/// @param lod     the level (out of range means level 0)
+/// @param first   receives its first index (within our buffers)
+/// @param count   receives its number of indices
+///
+void BufferSet::lodRange( int lod, GLsizei &first, GLsizei &count ) {
+
+	if( lod <= 0 || lod >= numLODs ) {
+		first = firstIndex;
+		count = numIndices;
+	} else {
+		first = firstIndex + lodFirst[lod];
+		count = lodCount[lod];
+	}
+}
+
+///
+/// drawBuffers(lod) - draw the triangles held in this BufferSet
+///
+/// The buffers must already have been selected.
+///
+/// @param lod   level of detail to draw
+///
+void BufferSet::drawBuffers( int lod ) {
+	GLsizei first, count;
+
+	if( indexType == GL_NONE ) {
+		// within an arena, our vertices begin at the base vertex
+		glDrawArrays( primitive, baseVertex, numElements );
+		return;
+	}
+
+	lodRange( lod, first, count );
+	if( arena != nullptr ) {
+		glDrawElementsBaseVertex( primitive, count, indexType,
+			BUFFER_OFFSET(first * indexSize), baseVertex );
+	} else {
+		glDrawElements( primitive, count, indexType,
+			BUFFER_OFFSET(first * indexSize) );
+	}
+}
+
+///
+/// drawRanges(firsts,counts,n) - draw several runs of our indices
+///     with a single call
+///
+/// The buffers must already have been selected.  Does nothing if
+/// we are drawn without indices.
+///
+/// @param firsts   where each run begins (counted from our first index)
+/// @param counts   how many indices each run has
+/// @param n        how many runs there are
+///
+void BufferSet::drawRanges( const GLsizei *firsts, const GLsizei *counts,
+	int n ) {
+
+	// reused from call to call to avoid allocating every frame
+	static vector<const GLvoid *> offsets;
+	static vector<GLint> bases;
+
+	if( indexType == GL_NONE || n < 1 ) {
+		return;
+	}
+
+	offsets.resize( n );
+	bases.resize( n );
+	for( int i = 0; i < n; ++i ) {
+		offsets[i] = BUFFER_OFFSET((firstIndex + firsts[i]) * indexSize);
+		bases[i] = baseVertex;
+	}
+
+	if( arena != nullptr ) {
+		glMultiDrawElementsBaseVertex( primitive, counts, indexType,
+			offsets.data(), n, bases.data() );
+	} else {
+		glMultiDrawElements( primitive, counts, indexType,
+			offsets.data(), n );
+	}
+}
+
+///
+/// drawInstanced(count,lod) - draw 'count' copies of the triangles
+///     held in this BufferSet with a single call
+///
+/// The buffers and the per-instance data must already have been
+/// selected.
+///
+/// @param count   number of instances
+/// @param lod     level of detail to draw
+///
+void BufferSet::drawInstanced( GLsizei count, int lod ) {
+	GLsizei first, n;
+
+	if( indexType == GL_NONE ) {
+		glDrawArraysInstanced( primitive, baseVertex, numElements, count );
+		return;
+	}
+
+	lodRange( lod, first, n );
+	if( arena != nullptr ) {
+		glDrawElementsInstancedBaseVertex( primitive, n, indexType,
+			BUFFER_OFFSET(first * indexSize), count, baseVertex );
+	} else {
+		glDrawElementsInstanced( primitive, n, indexType,
+			BUFFER_OFFSET(first * indexSize), count );
+	}
+}
+
+///
+/// sendDecode(program) - send the location decoding parameters
+///     for this BufferSet to the shader program
+///
+/// @param program   GLSL program object
+///
+void BufferSet::sendDecode( GLuint program ) {
+	GLint loc = getUniformLoc( program, U_POS_SCALE );
+	if( loc >= 0 ) {
+		glUniform3fv( loc, 1, posScale );
+	}
+	loc = getUniformLoc( program, U_POS_OFFSET );
+	if( loc >= 0 ) {
+		glUniform3fv( loc, 1, posOffset );
+	}
+}
+
+///
+/// sameDecode(b) - determine whether another BufferSet's locations
+///     are decoded the same way as ours
+///
+/// @param b     the other BufferSet
+///
+/// @return true if the decoding parameters match
+///
+bool BufferSet::sameDecode( const BufferSet *b ) {
+	for( int i = 0; i < 3; ++i ) {
+		if( posScale[i] != b->posScale[i] || posOffset[i] != b->posOffset[i] ) {
+			return( false );
+		}
+	}
+	return( true );
+}
+
+///
+/// deleteVAOs() - release all cached vertex array objects
+///
+void BufferSet::deleteVAOs( void ) {
+	if( numVAOs > 0 ) {
+		glDeleteVertexArrays( numVAOs, vaos );
+		numVAOs = 0;
+	}
+}
+
+///
+/// selectBuffers() - bind the vertex array object for this BufferSet
+///     and the supplied program, creating it on first use
+///
+/// The attribute names are only looked up when the VAO is created;
+/// after that, selecting the buffers is a single glBindVertexArray().
 ///
 /// @param program   GLSL program object
 /// @param vp        name of the position attribute variable
@@ -211,77 +867,190 @@ void BufferSet::createBuffers( Canvas &C ) {
 void BufferSet::selectBuffers( GLuint program,
 	const char *vp, const char *vc, const char *vn, const char *vt ) {
 
-	// bind the buffers
+	// meshes in an arena all share the arena's VAOs
+	if( arena != nullptr ) {
+		arena->selectBuffers( program, vp, vc, vn, vt );
+		return;
+	}
+
+	// have we already built a VAO for this program?
+	for( int i = 0; i < numVAOs; ++i ) {
+		if( vaoPrograms[i] == program ) {
+			glBindVertexArray( vaos[i] );
+			return;
+		}
+	}
+
+	// no - create one, and record the attribute setup in it
+	GLuint vao;
+	glGenVertexArrays( 1, &vao );
+	glBindVertexArray( vao );
+
+	if( numVAOs < MAX_VAOS ) {
+		vaos[numVAOs] = vao;
+		vaoPrograms[numVAOs] = program;
+		numVAOs += 1;
+	} else {
+		// out of slots; recycle the most recent one
+		cerr << "selectBuffers(): too many programs, VAO "
+			 << vaos[MAX_VAOS-1] << " replaced" << endl;
+		glDeleteVertexArrays( 1, &vaos[MAX_VAOS-1] );
+		vaos[MAX_VAOS-1] = vao;
+		vaoPrograms[MAX_VAOS-1] = program;
+	}
+
+	// bind the buffers; the element buffer binding is part of the VAO
 	glBindBuffer( GL_ARRAY_BUFFER, vbuffer );
 	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebuffer );
 
 	// set up the vertex attribute variables
 
-	// we always want position data
+	// we always want position data; if that's all we want, use
+	// the position-only stream if there is one
 #if defined(DEBUG)
 	if( vSize == 0 ) {
 		cerr << "selectBuffers(): Position data requested, but vSize is 0"
 			 << endl;
 	}
 #endif
-	GLint loc = getAttribLoc( program , vp );
-	if( loc >= 0 ) {
-		glEnableVertexAttribArray( loc );
-		glVertexAttribPointer( loc, 4, GL_FLOAT, GL_FALSE, 0,
-							   BUFFER_OFFSET(0) );
+	if( vc == nullptr && vn == nullptr && vt == nullptr && pOffset >= 0 ) {
+		enableAttrib( program, vp, 3, GL_FLOAT, 0, pOffset );
+		return;
 	}
 
-	// cumulative byte offset for subsequent data sections
-	int offset = vSize;
+	// component types used by this layout
+	bool packed = layout == LAYOUT_PACKED;
+	GLenum vType = packed ? GL_SHORT : GL_FLOAT;
+	GLenum cType = packed ? GL_UNSIGNED_BYTE : GL_FLOAT;
+	GLenum nType = packed ? GL_INT_2_10_10_10_REV : GL_FLOAT;
+	GLenum tType = packed ? GL_HALF_FLOAT : GL_FLOAT;
+
+	enableAttrib( program, vp, vComps, vType, stride, vOffset );
 
 	// do we also want color?
 	if( vc != nullptr ) {
 #if defined(DEBUG)
-		if( cSize == 0 ) {
-			cerr << "selectBuffers(): Color data requested, but cSize is 0",
+		if( cOffset < 0 ) {
+			cerr << "selectBuffers(): Color data requested, but there is none"
 				 << endl;
 		}
 #endif
-		loc = getAttribLoc( program, vc );
-		if( loc >= 0 ) {
-			glEnableVertexAttribArray( loc );
-			glVertexAttribPointer( loc, 4, GL_FLOAT, GL_FALSE, 0,
-								   BUFFER_OFFSET(offset) );
+		if( cOffset >= 0 ) {
+			enableAttrib( program, vc, 4, cType, stride, cOffset );
 		}
-		offset += cSize;
 	}
 
 	// how about a surface normal?
 	if( vn != nullptr ) {
 #if defined(DEBUG)
-		if( nSize == 0 ) {
-			cerr << "selectBuffers(): Normal data requested, but nSize is 0",
+		if( nOffset < 0 ) {
+			cerr << "selectBuffers(): Normal data requested, but there is none"
 				 << endl;
 		}
 #endif
-		loc = getAttribLoc( program, vn );
-		if( loc >= 0 ) {
-			glEnableVertexAttribArray( loc );
-			glVertexAttribPointer( loc, 3, GL_FLOAT, GL_FALSE, 0,
-								   BUFFER_OFFSET(offset) );
+		if( nOffset >= 0 ) {
+			enableAttrib( program, vn, packed ? 4 : 3, nType, stride, nOffset );
 		}
-		offset += nSize;
 	}
 
 	// what about texture coordinates?
 	if( vt != nullptr ) {
 #if defined(DEBUG)
-		if( tSize == 0 ) {
-			cerr << "selectBuffers(): Texture data requested, but tSize is 0",
+		if( tOffset < 0 ) {
+			cerr << "selectBuffers(): Texture data requested, but there is none"
 				 << endl;
 		}
 #endif
-		loc = getAttribLoc( program, vt );
-		if( loc >= 0 ) {
-			glEnableVertexAttribArray( loc );
-			glVertexAttribPointer( loc, 2, GL_FLOAT, GL_FALSE, 0,
-								   BUFFER_OFFSET(offset) );
+		if( tOffset >= 0 ) {
+			enableAttrib( program, vt, 2, tType, stride, tOffset );
 		}
-		offset += tSize;
 	}
 }
+
+///
+/// Constructor
+///
+InstanceBuffer::InstanceBuffer( void ) : vbuffer(0), capacity(0) {
+}
+
+///
+/// clear() - forget the matrices from the previous frame
+///
+void InstanceBuffer::clear( void ) {
+	matrices.clear();
+}
+
+///
+/// add(model) - add an instance
+///
+/// @param model   its model transformation
+///
+/// @return its position among this frame's instances
+///
+GLint InstanceBuffer::add( const glm::mat4 &model ) {
+	matrices.push_back( model );
+	return( (GLint) matrices.size() - 1 );
+}
+
+///
+/// upload() - copy this frame's matrices into the buffer, growing
+///     it if they don't fit
+///
+void InstanceBuffer::upload( void ) {
+	GLsizeiptr size = matrices.size() * sizeof(glm::mat4);
+
+	if( size == 0 ) {
+		return;
+	}
+
+	if( vbuffer == 0 ) {
+		glGenBuffers( 1, &vbuffer );
+	}
+	glBindBuffer( GL_ARRAY_BUFFER, vbuffer );
+
+	// grow by doubling, so a growing scene reallocates only rarely;
+	// otherwise, orphan last frame's storage so we needn't wait for
+	// the draw calls still reading it
+	if( size > capacity ) {
+		capacity = capacity > 0 ? capacity : size;
+		while( capacity < size ) {
+			capacity *= 2;
+		}
+	}
+	glBufferData( GL_ARRAY_BUFFER, capacity, NULL, GL_STREAM_DRAW );
+
+	fillBuffer( GL_ARRAY_BUFFER, 0, size, GL_MAP_INVALIDATE_BUFFER_BIT,
+		[&]( void *dst ) {
+			memcpy( dst, matrices.data(), size );
+		} );
+}
+
+///
+/// select(loc,first) - point the per-instance attribute of the
+///     currently bound vertex array object at our matrices
+///
+/// @param loc     location of the mat4 attribute variable
+/// @param first   the instance the next draw call begins with
+///
+void InstanceBuffer::select( GLint loc, GLint first ) {
+	GLintptr base = first * sizeof(glm::mat4);
+
+	glBindBuffer( GL_ARRAY_BUFFER, vbuffer );
+
+	// a mat4 attribute takes four locations, one per column
+	for( int c = 0; c < 4; ++c ) {
+		glEnableVertexAttribArray( loc + c );
+		glVertexAttribPointer( loc + c, 4, GL_FLOAT, GL_FALSE,
+			sizeof(glm::mat4), BUFFER_OFFSET(base + c * sizeof(glm::vec4)) );
+		glVertexAttribDivisor( loc + c, 1 );
+	}
+}
+
+///
+/// deleteBuffer() - release the buffer
+///
+void InstanceBuffer::deleteBuffer( void ) {
+	glDeleteBuffers( 1, &vbuffer );
+	vbuffer = 0;
+	capacity = 0;
+}
@@ -20,6 +20,10 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
 using namespace std;
 
 #include "Canvas.h"
@@ -29,6 +33,34 @@ using namespace std;
 //
 #define BUFFER_OFFSET(i)        ((GLvoid *)(((char *)0) + (i)))
 
+//
+// Maximum number of shader programs a single BufferSet can be drawn
+// with; each one gets its own vertex array object
+//
+#define MAX_VAOS        8
+
+//
+// Most levels of detail a single BufferSet can hold
+//
+#define MAX_LODS        4
+
+//
+// How the vertex data in a BufferSet is organized:
+//
+//   LAYOUT_PLANAR       all locations, then all colors, all normals,
+//                       and all texture coordinates
+//   LAYOUT_INTERLEAVED  location, normal, texture coordinates, and
+//                       color for each vertex, one after another
+//   LAYOUT_PACKED       interleaved, but with the location in 16-bit
+//                       normalized integers (decoded in the vertex
+//                       shader with posScale and posOffset), the normal
+//                       as 2_10_10_10_REV, texture coordinates as half
+//                       floats, and colors as unsigned bytes
+//
+typedef enum lay_e {
+	LAYOUT_PLANAR = 0, LAYOUT_INTERLEAVED, LAYOUT_PACKED
+} Layout;
+
 //
 // All the relevant information needed to keep
 // track of vertex and element buffers
@@ -40,15 +72,74 @@ public:
 	// buffer handles
 	GLuint vbuffer, ebuffer;
 
-	// total number of vertices
+	// total number of vertices, and of indices drawn
 	int numElements;
+	int numIndices;
+
+	// type and size (bytes) of our indices; GL_NONE if we are
+	// drawn without any
+	GLenum indexType;
+	GLsizei indexSize;
+
+	// what the vertices are drawn as:  GL_TRIANGLES, or GL_PATCHES
+	// for a control cage that a tessellation shader refines
+	GLenum primitive;
 
 	// component sizes (bytes)
 	long vSize, eSize, tSize, cSize, nSize;
 
+	// size of the separate position-only stream (bytes, 0 if none)
+	long pSize;
+
 	// have these already been set up?
 	bool bufferInit;
 
+	// how the vertex buffer is organized
+	Layout layout;
+
+	// distance between consecutive vertices (bytes; 0 if tightly packed)
+	GLsizei stride;
+
+	// where each kind of data begins in the vertex buffer (bytes;
+	// -1 if not present), and the number of location components
+	GLintptr vOffset, cOffset, nOffset, tOffset, pOffset;
+	GLint vComps;
+
+	// how to turn packed locations back into model coordinates
+	// (model = packed * posScale + posOffset), and the largest
+	// errors packing introduced
+	float posScale[3], posOffset[3];
+	PackError packError;
+
+	// levels of detail:  where each level's indices begin (counted
+	// from our first index) and how many there are; level 0 is the
+	// whole mesh, and is all there is unless setLODs() is called
+	int numLODs;
+	GLsizei lodFirst[MAX_LODS], lodCount[MAX_LODS];
+
+	// cached vertex array objects and the programs they belong to
+	GLuint vaos[MAX_VAOS];
+	GLuint vaoPrograms[MAX_VAOS];
+	int numVAOs;
+
+	// if our data lives in a shared arena, the arena and where
+	// in it our vertices and indices begin
+	BufferSet *arena;
+	GLint baseVertex;
+	GLsizei firstIndex;
+
+	// arena bookkeeping (used only by an arena BufferSet)
+	GLsizei capVertices, capIndices;
+	GLsizei usedVertices, usedIndices;
+
+	// the arena new meshes are placed in (nullptr if none)
+	static BufferSet *sharedArena;
+
+	// layout used for new buffers, and whether they get a
+	// position-only stream
+	static Layout defaultLayout;
+	static bool defaultPositions;
+
 public:
 
 	///
@@ -88,7 +179,117 @@ public:
 	void createBuffers( Canvas &C );
 
 	///
-	/// selectBuffers() - bind the correct vertex and element buffers
+	/// createArena(maxVerts,maxIndices) - turn this BufferSet into an
+	///     arena that can hold the data for many meshes
+	///
+	/// The arena uses the current default layout without colors; a
+	/// planar arena has each section sized for maxVerts vertices,
+	/// while an interleaved one holds location, normal, and texture
+	/// coordinates for each vertex.
+	///
+	/// @param maxVerts     vertex capacity
+	/// @param maxIndices   index capacity
+	///
+	void createArena( GLsizei maxVerts, GLsizei maxIndices );
+
+	///
+	/// setArena(arena) - select the arena that subsequent calls to
+	///     createBuffers() will place their data in
+	///
+	/// @param a     the arena, or nullptr for separate buffers
+	///
+	static void setArena( BufferSet *a );
+
+	///
+	/// setLayout(layout,positions) - select the layout that subsequent
+	///     calls to createBuffers() and createArena() will use
+	///
+	/// @param l           the vertex layout
+	/// @param positions   also create a position-only stream?
+	///
+	static void setLayout( Layout l, bool positions );
+
+	///
+	/// setLODs(n,counts) - divide our indices into levels of detail
+	///
+	/// The index list of the Canvas the buffers were created from must
+	/// have held the levels one after another, starting with the whole
+	/// mesh; afterward, numIndices is the size of level 0.
+	///
+	/// @param n        number of levels (at most MAX_LODS)
+	/// @param counts   number of indices in each level
+	///
+	void setLODs( int n, const GLsizei counts[] );
+
+	///
+	/// deleteBuffers() - release the buffers (but not the VAOs) of
+	///     this BufferSet, unless they belong to an arena
+	///
+	void deleteBuffers( void );
+
+	///
+	/// drawBuffers(lod) - draw the triangles held in this BufferSet
+	///
+	/// The buffers must already have been selected.
+	///
+	/// @param lod   level of detail to draw
+	///
+	void drawBuffers( int lod = 0 );
+
+	///
+	/// drawRanges(firsts,counts,n) - draw several runs of our indices
+	///     with a single call
+	///
+	/// The buffers must already have been selected.  Does nothing if
+	/// we are drawn without indices.
+	///
+	/// @param firsts   where each run begins (counted from our first index)
+	/// @param counts   how many indices each run has
+	/// @param n        how many runs there are
+	///
+	void drawRanges( const GLsizei *firsts, const GLsizei *counts, int n );
+
+	///
+	/// drawInstanced(count,lod) - draw 'count' copies of the triangles
+	///     held in this BufferSet with a single call
+	///
+	/// The buffers and the per-instance data must already have been
+	/// selected.
+	///
+	/// @param count   number of instances
+	/// @param lod     level of detail to draw
+	///
+	void drawInstanced( GLsizei count, int lod = 0 );
+
+	///
+	/// sendDecode(program) - send the location decoding parameters
+	///     for this BufferSet to the shader program
+	///
+	/// @param program   GLSL program object
+	///
+	void sendDecode( GLuint program );
+
+	///
+	/// sameDecode(b) - determine whether another BufferSet's locations
+	///     are decoded the same way as ours
+	///
+	/// @param b     the other BufferSet
+	///
+	/// @return true if the decoding parameters match
+	///
+	bool sameDecode( const BufferSet *b );
+
+	///
+	/// deleteVAOs() - release all cached vertex array objects
+	///
+	void deleteVAOs( void );
+
+	///
+	/// selectBuffers() - bind the vertex array object for this BufferSet
+	///     and the supplied program, creating it on first use
+	///
+	/// If only the position attribute is requested and the BufferSet
+	/// has a position-only stream, that stream is used.
 	///
 	/// @param program   GLSL program object
 	/// @param vp        name of the position attribute variable
@@ -99,6 +300,125 @@ public:
 	void selectBuffers( GLuint program,
 		const char *vp, const char * vc, const char *vn, const char *vt );
 
+private:
+
+	///
+	/// lodRange(lod,first,count) - find the indices of a level of detail
+	///
+	/// @param lod     the level (out of range means level 0)
+	/// @param first   receives its first index (within our buffers)
+	/// @param count   receives its number of indices
+	///
+	void lodRange( int lod, GLsizei &first, GLsizei &count );
+
+	///
+	/// planLayout(C) - work out the size of each kind of vertex data the
+	///     Canvas holds, and where it goes in a buffer of our own
+	///
+	/// @param C     the Canvas we'll use for drawing
+	///
+	/// @return the total vertex buffer size (bytes)
+	///
+	GLsizeiptr planLayout( Canvas &C );
+
+	///
+	/// chooseIndexType(C) - decide how the mesh held in the Canvas will
+	///     be drawn
+	///
+	/// @param C     the Canvas we'll use for drawing
+	///
+	void chooseIndexType( Canvas &C );
+
+	///
+	/// fitsArena(a) - determine whether this mesh can be placed in an arena
+	///
+	/// @param a     the arena
+	///
+	/// @return true if the mesh matches the arena and there is room
+	///
+	bool fitsArena( BufferSet *a );
+
+	///
+	/// writeData(C,base,first,flags) - copy the Canvas data directly into
+	///     our (already allocated) vertex and element buffers
+	///
+	/// @param C       the Canvas we'll use for drawing
+	/// @param base    vertex number at which our vertices begin
+	/// @param first   index number at which our indices begin
+	/// @param flags   extra glMapBufferRange() access flags
+	///
+	void writeData( Canvas &C, GLint base, GLsizei first, GLbitfield flags );
+
+	///
+	/// claimArena(a) - reserve space in an arena for this BufferSet's
+	///     vertices and indices
+	///
+	/// @param a     the arena
+	///
+	void claimArena( BufferSet *a );
+
+};
+
+//
+// Per-instance model transformations for instanced drawing
+//
+// The matrices for a frame are collected with add(), sent to the GPU
+// together with upload(), and then handed to each instanced draw call
+// by select(), which points a mat4 vertex attribute (four consecutive
+// vec4 locations, advancing once per instance) at that call's matrices.
+//
+
+class InstanceBuffer {
+
+public:
+	// buffer handle, and its size (bytes)
+	GLuint vbuffer;
+	GLsizeiptr capacity;
+
+	// the matrices for the current frame
+	vector<glm::mat4> matrices;
+
+public:
+
+	///
+	/// Constructor
+	///
+	InstanceBuffer( void );
+
+	///
+	/// clear() - forget the matrices from the previous frame
+	///
+	void clear( void );
+
+	///
+	/// add(model) - add an instance
+	///
+	/// @param model   its model transformation
+	///
+	/// @return its position among this frame's instances
+	///
+	GLint add( const glm::mat4 &model );
+
+	///
+	/// upload() - copy this frame's matrices into the buffer, growing
+	///     it if they don't fit
+	///
+	void upload( void );
+
+	///
+	/// select(loc,first) - point the per-instance attribute of the
+	///     currently bound vertex array object at our matrices
+	///
+	/// @param loc     location of the mat4 attribute variable
+	/// @param first   the instance the next draw call begins with
+	///
+	void select( GLint loc, GLint first );
+
+	///
+	/// deleteBuffer() - release the buffer
+	///
+	void deleteBuffer( void );
+
 };
 
 #endif
@@ -34,9 +34,18 @@
 //  sequence.
 //
 
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <unordered_map>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define CANVAS_SSE
+#endif
 #include <glm/vec3.hpp>
 #include <glm/geometric.hpp>
 
@@ -44,13 +53,149 @@
 #include "Canvas.h"
 #include "Utils.h"
 
+//
+// PRIVATE TYPES
+//
+
+//
+// Hash table key used when welding vertices:  all the data for one
+// vertex (at most XYZ, normal, UV, and RGBA), compared bit for bit
+//
+struct WeldKey {
+	float v[12];
+	int n;
+
+	bool operator==( const WeldKey &k ) const {
+		return( n == k.n && memcmp( v, k.v, n * sizeof(float) ) == 0 );
+	}
+};
+
+struct WeldHash {
+	size_t operator()( const WeldKey &k ) const {
+		// FNV-1a over the bytes of the vertex data
+		const unsigned char *p = (const unsigned char *) k.v;
+		size_t h = 2166136261u;
+		for( size_t i = 0; i < k.n * sizeof(float); i++ ) {
+			h = (h ^ p[i]) * 16777619u;
+		}
+		return( h );
+	}
+};
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// Fold an array of 32-bit values into a 64-bit FNV-1a hash
+///
+/// @param h      the hash so far
+/// @param data   the values
+/// @param n      how many there are
+///
+/// @return the updated hash
+///
+static uint64_t hashWords( uint64_t h, const void *data, size_t n )
+{
+	const uint32_t *w = (const uint32_t *) data;
+
+	// the length goes in first, so each array's data stays separate
+	h = (h ^ (uint64_t) n) * 1099511628211ull;
+	for( size_t i = 0; i < n; i++ ) {
+		h = (h ^ w[i]) * 1099511628211ull;
+	}
+
+	return( h );
+}
+
+///
+/// Convert a value in [-1,1] to a 16-bit normalized integer
+///
+static GLshort toSnorm16( float f )
+{
+	f = f < -1.0f ? -1.0f : (f > 1.0f ? 1.0f : f);
+	return( (GLshort) lroundf( f * 32767.0f ) );
+}
+
+///
+/// Convert a value in [-1,1] to a 10-bit normalized integer
+///
+static int toSnorm10( float f )
+{
+	f = f < -1.0f ? -1.0f : (f > 1.0f ? 1.0f : f);
+	return( (int) lroundf( f * 511.0f ) );
+}
+
+///
+/// Convert a float to IEEE half precision (rounding to nearest)
+///
+static GLushort toHalf( float f )
+{
+	uint32_t x;
+	memcpy( &x, &f, sizeof(x) );
+
+	uint32_t sign = (x >> 16) & 0x8000;
+	uint32_t rawExp = (x >> 23) & 0xff;
+	uint32_t mant = x & 0x7fffff;
+	int exp = (int) rawExp - 127 + 15;
+
+	if( rawExp == 0xff ) {
+		// infinity or NaN
+		return( sign | 0x7c00 | (mant ? 0x200 : 0) );
+	}
+	if( exp >= 31 ) {
+		// too big; make it infinite
+		return( sign | 0x7c00 );
+	}
+	if( exp <= 0 ) {
+		// too small for a normalized half
+		if( exp < -10 ) {
+			return( sign );
+		}
+		mant |= 0x800000;
+		int shift = 14 - exp;
+		uint32_t h = mant >> shift;
+		if( (mant >> (shift - 1)) & 1 ) {
+			h += 1;
+		}
+		return( sign | h );
+	}
+
+	// a carry out of the mantissa correctly bumps the exponent
+	uint32_t h = sign | (exp << 10) | (mant >> 13);
+	if( mant & 0x1000 ) {
+		h += 1;
+	}
+	return( h );
+}
+
+///
+/// Convert an IEEE half precision value to a float
+///
+static float fromHalf( GLushort h )
+{
+	float sign = (h & 0x8000) ? -1.0f : 1.0f;
+	int exp = (h >> 10) & 0x1f;
+	int mant = h & 0x3ff;
+
+	if( exp == 0 ) {
+		return( sign * ldexpf( (float) mant, -24 ) );
+	}
+	if( exp == 31 ) {
+		return( mant ? NAN : sign * INFINITY );
+	}
+	return( sign * ldexpf( (float) (mant | 0x400), exp - 25 ) );
+}
+
 ///
 /// Constructor
 ///
 /// @param w width of canvas
 /// @param h height of canvas
 ///
-Canvas::Canvas( int w, int h ) : width(w), height(h) {
+Canvas::Canvas( int w, int h ) : width(w), height(h),
+	points(&pool), normals(&pool), uv(&pool), colors(&pool),
+	elements(&pool) {
 	// G++ allows us to use (Color) { ... }, but Visual Studio
 	// doesn't, so we do this the long way to keep everyone happy
 	Color black = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -62,6 +207,7 @@ Canvas::Canvas( int w, int h ) : width(w), height(h) {
 	uvArray = 0;
 	elemArray = 0;
 	numElements = 0;
+	indexed = false;
 }
 
 ///
@@ -80,36 +226,43 @@ Canvas::~Canvas( void ) {
 ///
 void Canvas::clear( void )
 {
-	if( pointArray ) {
-		delete [] pointArray;
-		pointArray = 0;
-	}
-	if( normalArray ) {
-		delete [] normalArray;
-		normalArray = 0;
-	}
-	if( uvArray ) {
-		delete [] uvArray;
-		uvArray = 0;
-	}
-	if( elemArray ) {
-		delete [] elemArray;
-		elemArray = 0;
-	}
-	if( colorArray ) {
-		delete [] colorArray;
-		colorArray = 0;
-	}
-	points.clear();
-	normals.clear();
-	uv.clear();
-	colors.clear();
+	// the arrays live in the arena, so they're simply forgotten
+	pointArray = 0;
+	normalArray = 0;
+	uvArray = 0;
+	elemArray = 0;
+	colorArray = 0;
+
+	// give up the vectors' storage, then recycle all of it at once
+	FloatVec( &pool ).swap( points );
+	FloatVec( &pool ).swap( normals );
+	FloatVec( &pool ).swap( uv );
+	FloatVec( &pool ).swap( colors );
+	IndexVec( &pool ).swap( elements );
+	pool.reset();
+
+	indexed = false;
 	numElements = 0;
 	Color black = { 0.0f, 0.0f, 0.0f, 1.0f };
 	currentColor = black;
 	currentDepth = -1.0f;
 }
 
+///
+/// Reserve space for the vertices of the next shape
+///
+/// @param nverts   expected number of vertices
+///
+void Canvas::reserve( int nverts )
+{
+	points.reserve( points.size() + (size_t) nverts * 4 );
+	normals.reserve( normals.size() + (size_t) nverts * 3 );
+	uv.reserve( uv.size() + (size_t) nverts * 2 );
+	if( indexed ) {
+		elements.reserve( elements.size() + nverts );
+	}
+}
+
 ///
 /// Set the pixel Z coordinate
 ///
@@ -229,6 +382,11 @@ void Canvas::addVertex( Vertex v )
 	points.push_back( v.z );
 	points.push_back( 1.0f );  // ignore the homogeneous coordinate
 
+	// once we're indexed, new vertices get indices of their own
+	if( indexed ) {
+		elements.push_back( numElements );
+	}
+
 	// here is where we actually count the number of
 	// things that have been put into the canvas
 	numElements += 1;
@@ -314,6 +472,210 @@ void Canvas::addTextureCoords( TexCoord uv0, TexCoord uv1, TexCoord uv2 )
 	addTexCoord( uv2 );
 }
 
+///
+/// Compute the (unnormalized) face normals of a run of triangles
+///
+/// @param verts   vertex locations
+/// @param tris    three indices into 'verts' for each triangle
+/// @param ntris   number of triangles
+/// @param out     receives XYZ for each triangle
+///
+static void faceNormals( const Vertex *verts, const GLuint *tris,
+	int ntris, float *out )
+{
+	int t = 0;
+
+#if defined(CANVAS_SSE)
+	// four triangles at a time:  gather the corners into SoA form,
+	// then u = p1 - p0, v = p2 - p0, and n = u x v
+	for( ; t + 4 <= ntris; t += 4 ) {
+		const GLuint *e = &tris[t*3];
+		const Vertex &a0 = verts[e[0]], &b0 = verts[e[1]], &c0 = verts[e[2]];
+		const Vertex &a1 = verts[e[3]], &b1 = verts[e[4]], &c1 = verts[e[5]];
+		const Vertex &a2 = verts[e[6]], &b2 = verts[e[7]], &c2 = verts[e[8]];
+		const Vertex &a3 = verts[e[9]], &b3 = verts[e[10]], &c3 = verts[e[11]];
+
+		__m128 px = _mm_setr_ps( a0.x, a1.x, a2.x, a3.x );
+		__m128 py = _mm_setr_ps( a0.y, a1.y, a2.y, a3.y );
+		__m128 pz = _mm_setr_ps( a0.z, a1.z, a2.z, a3.z );
+
+		__m128 ux = _mm_sub_ps( _mm_setr_ps( b0.x, b1.x, b2.x, b3.x ), px );
+		__m128 uy = _mm_sub_ps( _mm_setr_ps( b0.y, b1.y, b2.y, b3.y ), py );
+		__m128 uz = _mm_sub_ps( _mm_setr_ps( b0.z, b1.z, b2.z, b3.z ), pz );
+
+		__m128 vx = _mm_sub_ps( _mm_setr_ps( c0.x, c1.x, c2.x, c3.x ), px );
+		__m128 vy = _mm_sub_ps( _mm_setr_ps( c0.y, c1.y, c2.y, c3.y ), py );
+		__m128 vz = _mm_sub_ps( _mm_setr_ps( c0.z, c1.z, c2.z, c3.z ), pz );
+
+		__m128 nx = _mm_sub_ps( _mm_mul_ps( uy, vz ), _mm_mul_ps( uz, vy ) );
+		__m128 ny = _mm_sub_ps( _mm_mul_ps( uz, vx ), _mm_mul_ps( ux, vz ) );
+		__m128 nz = _mm_sub_ps( _mm_mul_ps( ux, vy ), _mm_mul_ps( uy, vx ) );
+
+		// back to XYZ order
+		float x[4], y[4], z[4];
+		_mm_storeu_ps( x, nx );
+		_mm_storeu_ps( y, ny );
+		_mm_storeu_ps( z, nz );
+		for( int k = 0; k < 4; k++ ) {
+			out[(t+k)*3]   = x[k];
+			out[(t+k)*3+1] = y[k];
+			out[(t+k)*3+2] = z[k];
+		}
+	}
+#endif
+
+	// whatever is left (or everything, without SSE)
+	for( ; t < ntris; t++ ) {
+		const Vertex &p0 = verts[tris[t*3]];
+		const Vertex &p1 = verts[tris[t*3+1]];
+		const Vertex &p2 = verts[tris[t*3+2]];
+		float ux = p1.x - p0.x, uy = p1.y - p0.y, uz = p1.z - p0.z;
+		float vx = p2.x - p0.x, vy = p2.y - p0.y, vz = p2.z - p0.z;
+		out[t*3]   = uy * vz - uz * vy;
+		out[t*3+1] = uz * vx - ux * vz;
+		out[t*3+2] = ux * vy - uy * vx;
+	}
+}
+
+///
+/// Add many triangles at once from indexed tables of data
+///
+/// Space for all the new data is reserved up front.  Unless normals
+/// are supplied, each triangle gets its face normal (as with
+/// addTriangle()), computed several triangles at a time with SSE
+/// where it is available.
+///
+/// @param verts   vertex locations
+/// @param tris    three indices into 'verts' (and the other tables)
+///                for each triangle
+/// @param ntris   number of triangles
+/// @param uvs     (u,v) data for each vertex (or NULL)
+/// @param norms   normal for each vertex (or NULL for face normals)
+///
+void Canvas::addTriangles( const Vertex *verts, const GLuint *tris,
+	int ntris, const TexCoord *uvs, const Normal *norms )
+{
+	if( ntris < 1 ) {
+		return;
+	}
+
+	size_t n = (size_t) ntris * 3;
+
+	// grow each array once, then fill in the new part directly
+	size_t p0 = points.size(), n0 = normals.size(), t0 = uv.size();
+	points.resize( p0 + n * 4 );
+	normals.resize( n0 + n * 3 );
+	if( uvs != NULL ) {
+		uv.resize( t0 + n * 2 );
+	}
+
+	float *pdst = &points[p0];
+	for( size_t i = 0; i < n; i++ ) {
+		const Vertex &v = verts[tris[i]];
+		*pdst++ = v.x;
+		*pdst++ = v.y;
+		*pdst++ = v.z;
+		*pdst++ = 1.0f;  // ignore the homogeneous coordinate
+	}
+
+	float *ndst = &normals[n0];
+	if( norms != NULL ) {
+		for( size_t i = 0; i < n; i++ ) {
+			const Normal &nn = norms[tris[i]];
+			*ndst++ = nn.x;
+			*ndst++ = nn.y;
+			*ndst++ = nn.z;
+		}
+	} else {
+		// compute the face normals into the first third of the new
+		// space, then spread each one out to its three corners,
+		// working backward so nothing is overwritten too soon
+		faceNormals( verts, tris, ntris, ndst );
+		for( int t = ntris - 1; t >= 0; t-- ) {
+			float x = ndst[t*3], y = ndst[t*3+1], z = ndst[t*3+2];
+			for( int k = 2; k >= 0; k-- ) {
+				ndst[(t*3+k)*3]   = x;
+				ndst[(t*3+k)*3+1] = y;
+				ndst[(t*3+k)*3+2] = z;
+			}
+		}
+	}
+
+	if( uvs != NULL ) {
+		float *tdst = &uv[t0];
+		for( size_t i = 0; i < n; i++ ) {
+			const TexCoord &tc = uvs[tris[i]];
+			*tdst++ = tc.u;
+			*tdst++ = tc.v;
+		}
+	}
+
+	// once we're indexed, new vertices get indices of their own
+	if( indexed ) {
+		for( size_t i = 0; i < n; i++ ) {
+			elements.push_back( numElements + i );
+		}
+	}
+
+	numElements += n;
+}
+
+///
+/// Add an indexed mesh whose vertices are already shared
+///
+/// @param verts    vertex locations
+/// @param norms    normal for each vertex (or NULL)
+/// @param uvs      (u,v) data for each vertex (or NULL)
+/// @param nverts   number of vertices
+/// @param idx      indices into the vertex tables, three per triangle
+/// @param nidx     number of indices
+///
+void Canvas::addMesh( const Vertex *verts, const Normal *norms,
+	const TexCoord *uvs, int nverts, const GLuint *idx, int nidx )
+{
+	// anything already here gets an index list of its own first
+	if( !indexed ) {
+		elements.reserve( numElements + nidx );
+		for( int i = 0; i < numElements; i++ ) {
+			elements.push_back( i );
+		}
+		indexed = true;
+	}
+
+	points.reserve( points.size() + (size_t) nverts * 4 );
+	for( int i = 0; i < nverts; i++ ) {
+		points.push_back( verts[i].x );
+		points.push_back( verts[i].y );
+		points.push_back( verts[i].z );
+		points.push_back( 1.0f );
+	}
+
+	if( norms ) {
+		normals.reserve( normals.size() + (size_t) nverts * 3 );
+		for( int i = 0; i < nverts; i++ ) {
+			normals.push_back( norms[i].x );
+			normals.push_back( norms[i].y );
+			normals.push_back( norms[i].z );
+		}
+	}
+
+	if( uvs ) {
+		uv.reserve( uv.size() + (size_t) nverts * 2 );
+		for( int i = 0; i < nverts; i++ ) {
+			uv.push_back( uvs[i].u );
+			uv.push_back( uvs[i].v );
+		}
+	}
+
+	GLuint base = numElements;
+	elements.reserve( elements.size() + nidx );
+	for( int i = 0; i < nidx; i++ ) {
+		elements.push_back( base + idx[i] );
+	}
+
+	numElements += nverts;
+}
+
 	/////////////////////////////////////
 	//
 	// Retrieving things from the Canvas
@@ -327,24 +689,15 @@ void Canvas::addTextureCoords( TexCoord uv0, TexCoord uv1, TexCoord uv2 )
 ///
 GLuint *Canvas::getElements( void )
 {
-	// delete the old element array if we have one
-	if( elemArray ) {
-		delete [] elemArray;
-		elemArray = 0;
-	}
+	// any old array stays in the arena until the canvas is cleared
+	elemArray = 0;
 
-	int n = numElements;
+	int n = numIndices();
 
 	if( n > 0 ) {
 		// create and fill a new element array
-		elemArray = new GLuint[ n ];
-		if( elemArray == 0 ) {
-			cerr << "element allocation failure" << endl;
-			exit( 1 );
-		}
-		for( int i = 0; i < n; i++ ) {
-			elemArray[i] = i;
-		}
+		elemArray = (GLuint *) pool.allocate( n * sizeof(GLuint) );
+		writeElements( elemArray );
 	}
 
 	return elemArray;
@@ -357,21 +710,14 @@ GLuint *Canvas::getElements( void )
 ///
 float *Canvas::getVertices( void )
 {
-	// delete the old point array if we have one
-	if( pointArray ) {
-		delete [] pointArray;
-		pointArray = 0;
-	}
+	// any old array stays in the arena until the canvas is cleared
+	pointArray = 0;
 
 	int n = points.size();
 
 	if( n > 0 ) {
 		// create and fill a new point array
-		pointArray = new float[ n ];
-		if( pointArray == 0 ) {
-			cerr << "point allocation failure" << endl;
-			exit( 1 );
-		}
+		pointArray = (float *) pool.allocate( n * sizeof(float) );
 		for( int i = 0; i < n; i++ ) {
 			pointArray[i] = points[i];
 		}
@@ -387,21 +733,14 @@ float *Canvas::getVertices( void )
 ///
 float *Canvas::getNormals( void )
 {
-	// delete the old normal array if we have one
-	if( normalArray ) {
-		delete [] normalArray;
-		normalArray = 0;
-	}
+	// any old array stays in the arena until the canvas is cleared
+	normalArray = 0;
 
 	int n = normals.size();
 
 	if( n > 0 ) {
 		// create and fill a new normal array
-		normalArray = new float[ n ];
-		if( normalArray == 0 ) {
-			cerr << "normal allocation failure" << endl;
-			exit( 1 );
-		}
+		normalArray = (float *) pool.allocate( n * sizeof(float) );
 		for( int i = 0; i < n; i++ ) {
 			normalArray[i] = normals[i];
 		}
@@ -417,21 +756,14 @@ float *Canvas::getNormals( void )
 ///
 float *Canvas::getUV( void )
 {
-	// delete the old texture coordinate array if we have one
-	if( uvArray ) {
-		delete [] uvArray;
-		uvArray = 0;
-	}
+	// any old array stays in the arena until the canvas is cleared
+	uvArray = 0;
 
 	int n = uv.size();
 
 	if( n > 0 ) {
 		// create and fill a new texture coordinate array
-		uvArray = new float[ n ];
-		if( uvArray == 0 ) {
-			cerr << "uv allocation failure" << endl;
-			exit( 1 );
-		}
+		uvArray = (float *) pool.allocate( n * sizeof(float) );
 		for( int i = 0; i < n; i++ ) {
 			uvArray[i] = uv[i];
 		}
@@ -447,21 +779,14 @@ float *Canvas::getUV( void )
 ///
 float *Canvas::getColors( void )
 {
-	// delete the old color array if we have one
-	if( colorArray ) {
-		delete [] colorArray;
-		colorArray = 0;
-	}
+	// any old array stays in the arena until the canvas is cleared
+	colorArray = 0;
 
 	int n = colors.size();
 
 	if( n > 0 ) {
 		// create and fill a new color array
-		colorArray = new float[ n ];
-		if( colorArray == 0 ) {
-			cerr << "color allocation failure" << endl;
-			exit( 1 );
-		}
+		colorArray = (float *) pool.allocate( n * sizeof(float) );
 		for( int i = 0; i < n; i++ ) {
 			colorArray[i] = colors[i];
 		}
@@ -470,6 +795,288 @@ float *Canvas::getColors( void )
 	return colorArray;
 }
 
+///
+/// Write the vertex locations (XYZW) into caller-supplied memory
+/// (e.g., a mapped buffer object), without an intermediate copy
+///
+/// @param dst  Destination; must have room for numVertices() vertices
+///
+void Canvas::writeVertices( float *dst )
+{
+	if( !points.empty() ) {
+		memcpy( dst, points.data(), points.size() * sizeof(float) );
+	}
+}
+
+///
+/// Write the normals (XYZ) into caller-supplied memory
+///
+/// @param dst  Destination; must have room for numVertices() normals
+///
+void Canvas::writeNormals( float *dst )
+{
+	if( !normals.empty() ) {
+		memcpy( dst, normals.data(), normals.size() * sizeof(float) );
+	}
+}
+
+///
+/// Write the texture coordinates (UV) into caller-supplied memory
+///
+/// @param dst  Destination; must have room for numVertices() pairs
+///
+void Canvas::writeUV( float *dst )
+{
+	if( !uv.empty() ) {
+		memcpy( dst, uv.data(), uv.size() * sizeof(float) );
+	}
+}
+
+///
+/// Write the colors (RGBA) into caller-supplied memory
+///
+/// @param dst  Destination; must have room for numVertices() colors
+///
+void Canvas::writeColors( float *dst )
+{
+	if( !colors.empty() ) {
+		memcpy( dst, colors.data(), colors.size() * sizeof(float) );
+	}
+}
+
+///
+/// Write the element (connectivity) data into caller-supplied memory
+///
+/// @param dst  Destination; must have room for numIndices() indices
+///
+void Canvas::writeElements( GLuint *dst )
+{
+	if( indexed ) {
+		if( !elements.empty() ) {
+			memcpy( dst, elements.data(), elements.size() * sizeof(GLuint) );
+		}
+		return;
+	}
+
+	// until the vertices are welded, each one is used exactly once
+	for( int i = 0; i < numElements; i++ ) {
+		dst[i] = i;
+	}
+}
+
+///
+/// Write the element data as 16-bit indices; the Canvas must not
+/// hold more than 65536 vertices
+///
+/// @param dst  Destination; must have room for numIndices() indices
+///
+void Canvas::writeElements( GLushort *dst )
+{
+	if( indexed ) {
+		for( size_t i = 0; i < elements.size(); i++ ) {
+			dst[i] = (GLushort) elements[i];
+		}
+		return;
+	}
+
+	for( int i = 0; i < numElements; i++ ) {
+		dst[i] = (GLushort) i;
+	}
+}
+
+///
+/// Determine the bounding box of the vertex locations
+///
+/// @param lo   Receives the smallest X, Y, and Z
+/// @param hi   Receives the largest X, Y, and Z
+///
+void Canvas::getBounds( float lo[3], float hi[3] )
+{
+	for( int j = 0; j < 3; j++ ) {
+		lo[j] = hi[j] = numElements > 0 ? points[j] : 0.0f;
+	}
+
+	for( int i = 1; i < numElements; i++ ) {
+		for( int j = 0; j < 3; j++ ) {
+			float v = points[i*4+j];
+			if( v < lo[j] ) lo[j] = v;
+			if( v > hi[j] ) hi[j] = v;
+		}
+	}
+}
+
+///
+/// Determine how many bytes each vertex occupies when packed
+///
+/// @return the number of bytes per packed vertex
+///
+int Canvas::packedSize( void )
+{
+	int nbytes = 4 * sizeof(GLshort);
+
+	if( hasNormals() ) nbytes += sizeof(GLuint);
+	if( hasUV() )      nbytes += 2 * sizeof(GLushort);
+	if( hasColors() )  nbytes += 4 * sizeof(GLubyte);
+
+	return( nbytes );
+}
+
+///
+/// Write all the vertex data into caller-supplied memory, packed
+///
+/// Each vertex is stored as XYZW in 16-bit normalized integers
+/// (relative to 'offset' and 'scale'), followed by the normal in
+/// 2_10_10_10_REV format, the texture coordinates as two half
+/// floats, and the color as four unsigned bytes, each of those
+/// only if the Canvas holds that kind of data.
+///
+/// @param dst      Destination; must have room for numVertices() *
+///                 packedSize() bytes
+/// @param scale    Half the extent of the data along each axis
+/// @param offset   Center of the data along each axis
+/// @param err      Receives the largest errors introduced
+///
+void Canvas::writePacked( void *dst, const float scale[3],
+	const float offset[3], PackError &err )
+{
+	unsigned char *out = (unsigned char *) dst;
+	int n = numElements;
+	bool withNormals = hasNormals();
+	bool withUV = hasUV();
+	bool withColors = hasColors();
+
+	err.position = err.normal = err.uv = 0.0f;
+
+	for( int i = 0; i < n; i++ ) {
+
+		// location, relative to the center of the bounding box
+		GLshort pos[4];
+		for( int j = 0; j < 3; j++ ) {
+			float v = points[i*4+j];
+			pos[j] = toSnorm16( (v - offset[j]) / scale[j] );
+			float back = (pos[j] / 32767.0f) * scale[j] + offset[j];
+			err.position = fmaxf( err.position, fabsf( back - v ) );
+		}
+		pos[3] = 32767;
+		memcpy( out, pos, sizeof(pos) );
+		out += sizeof(pos);
+
+		if( withNormals ) {
+			float nx = normals[i*3], ny = normals[i*3+1], nz = normals[i*3+2];
+			float len = sqrtf( nx*nx + ny*ny + nz*nz );
+			if( len > 0.0f ) {
+				nx /= len; ny /= len; nz /= len;
+			}
+			int qx = toSnorm10( nx ), qy = toSnorm10( ny ),
+				qz = toSnorm10( nz );
+			GLuint packed = (qx & 0x3ff) | ((qy & 0x3ff) << 10) |
+							((qz & 0x3ff) << 20);
+			memcpy( out, &packed, sizeof(packed) );
+			out += sizeof(packed);
+
+			// how far off is the direction we'll get back?
+			float bx = qx / 511.0f, by = qy / 511.0f, bz = qz / 511.0f;
+			float blen = sqrtf( bx*bx + by*by + bz*bz );
+			if( len > 0.0f && blen > 0.0f ) {
+				float d = (nx*bx + ny*by + nz*bz) / blen;
+				d = d > 1.0f ? 1.0f : d;
+				err.normal = fmaxf( err.normal,
+					acosf( d ) * 180.0f / (float) M_PI );
+			}
+		}
+
+		if( withUV ) {
+			GLushort t[2];
+			for( int j = 0; j < 2; j++ ) {
+				t[j] = toHalf( uv[i*2+j] );
+				err.uv = fmaxf( err.uv, fabsf( fromHalf( t[j] ) - uv[i*2+j] ) );
+			}
+			memcpy( out, t, sizeof(t) );
+			out += sizeof(t);
+		}
+
+		if( withColors ) {
+			for( int j = 0; j < 4; j++ ) {
+				float c = colors[i*4+j];
+				c = c < 0.0f ? 0.0f : (c > 1.0f ? 1.0f : c);
+				*out++ = (GLubyte) lroundf( c * 255.0f );
+			}
+		}
+	}
+}
+
+///
+/// Determine how many floats each vertex occupies when interleaved
+///
+/// @return the number of floats per interleaved vertex
+///
+int Canvas::interleavedFloats( void )
+{
+	int nfloats = 3;
+
+	if( hasNormals() ) nfloats += 3;
+	if( hasUV() )      nfloats += 2;
+	if( hasColors() )  nfloats += 4;
+
+	return( nfloats );
+}
+
+///
+/// Write all the vertex data into caller-supplied memory, interleaved
+///
+/// Each vertex is stored as XYZ, followed by the normal (XYZ),
+/// the texture coordinates (UV), and the color (RGBA), each of
+/// those only if the Canvas holds that kind of data.
+///
+/// @param dst  Destination; must have room for numVertices() *
+///             interleavedFloats() floats
+///
+void Canvas::writeInterleaved( float *dst )
+{
+	int n = numElements;
+	bool withNormals = hasNormals();
+	bool withUV = hasUV();
+	bool withColors = hasColors();
+
+	for( int i = 0; i < n; i++ ) {
+		*dst++ = points[i*4];
+		*dst++ = points[i*4+1];
+		*dst++ = points[i*4+2];
+		if( withNormals ) {
+			*dst++ = normals[i*3];
+			*dst++ = normals[i*3+1];
+			*dst++ = normals[i*3+2];
+		}
+		if( withUV ) {
+			*dst++ = uv[i*2];
+			*dst++ = uv[i*2+1];
+		}
+		if( withColors ) {
+			*dst++ = colors[i*4];
+			*dst++ = colors[i*4+1];
+			*dst++ = colors[i*4+2];
+			*dst++ = colors[i*4+3];
+		}
+	}
+}
+
+///
+/// Write the vertex locations as tightly packed XYZ triples into
+/// caller-supplied memory (e.g., for depth-only drawing)
+///
+/// @param dst  Destination; must have room for numVertices() triples
+///
+void Canvas::writePositions( float *dst )
+{
+	int n = numElements;
+
+	for( int i = 0; i < n; i++ ) {
+		*dst++ = points[i*4];
+		*dst++ = points[i*4+1];
+		*dst++ = points[i*4+2];
+	}
+}
+
 ///
 /// Retrieve the vertex count from this Canvas
 ///
@@ -479,3 +1086,201 @@ int Canvas::numVertices( void )
 {
 	return numElements;
 }
+
+///
+/// Retrieve the index count from this Canvas (three per triangle)
+///
+/// @return The number of indices in the canvas
+///
+int Canvas::numIndices( void )
+{
+	return( indexed ? (int) elements.size() : numElements );
+}
+
+///
+/// Compute a hash of everything in the Canvas
+///
+/// @return the hash
+///
+uint64_t Canvas::contentHash( void )
+{
+	uint64_t h = 14695981039346656037ull;
+
+	h = hashWords( h, points.data(), points.size() );
+	h = hashWords( h, normals.data(), normals.size() );
+	h = hashWords( h, uv.data(), uv.size() );
+	h = hashWords( h, colors.data(), colors.size() );
+	h = hashWords( h, elements.data(), elements.size() );
+
+	return( h );
+}
+
+///
+/// Weld identical vertices together
+///
+/// Vertices with exactly the same location, normal, texture
+/// coordinates, and color are merged, leaving a compact set of
+/// vertices and an index list that refers to them.  Data added
+/// afterward is indexed as it arrives, and can be welded by
+/// calling this again.
+///
+/// @return The number of vertices remaining
+///
+int Canvas::weld( void )
+{
+	int n = numElements;
+
+	// every kind of data we hold must cover every vertex
+	bool withNormals = hasNormals();
+	bool withUV = hasUV();
+	bool withColors = hasColors();
+	if( (withNormals && normals.size() != (size_t) n * 3) ||
+		(withUV && uv.size() != (size_t) n * 2) ||
+		(withColors && colors.size() != (size_t) n * 4) ) {
+		cerr << "weld: incomplete vertex data, not welded" << endl;
+		return( n );
+	}
+
+	// first occurrence of each distinct vertex, and where
+	// each of the current vertices ends up
+	unordered_map<WeldKey,GLuint,WeldHash> seen;
+	seen.reserve( n );
+	IndexVec remap( n, 0, &pool );
+
+	FloatVec newPoints( &pool ), newNormals( &pool ),
+		newUV( &pool ), newColors( &pool );
+	newPoints.reserve( points.size() );
+	newNormals.reserve( normals.size() );
+	newUV.reserve( uv.size() );
+	newColors.reserve( colors.size() );
+
+	GLuint count = 0;
+	for( int i = 0; i < n; i++ ) {
+		WeldKey k;
+		k.n = 0;
+		for( int j = 0; j < 3; j++ ) k.v[k.n++] = points[i*4+j];
+		if( withNormals ) {
+			for( int j = 0; j < 3; j++ ) k.v[k.n++] = normals[i*3+j];
+		}
+		if( withUV ) {
+			for( int j = 0; j < 2; j++ ) k.v[k.n++] = uv[i*2+j];
+		}
+		if( withColors ) {
+			for( int j = 0; j < 4; j++ ) k.v[k.n++] = colors[i*4+j];
+		}
+
+		auto found = seen.emplace( k, count );
+		if( found.second ) {
+			// first time we've seen this one - keep it
+			newPoints.insert( newPoints.end(),
+				&points[i*4], &points[i*4] + 4 );
+			if( withNormals ) {
+				newNormals.insert( newNormals.end(),
+					&normals[i*3], &normals[i*3] + 3 );
+			}
+			if( withUV ) {
+				newUV.insert( newUV.end(), &uv[i*2], &uv[i*2] + 2 );
+			}
+			if( withColors ) {
+				newColors.insert( newColors.end(),
+					&colors[i*4], &colors[i*4] + 4 );
+			}
+			count += 1;
+		}
+		remap[i] = found.first->second;
+	}
+
+	// the index list refers to the surviving vertices
+	if( indexed ) {
+		for( size_t i = 0; i < elements.size(); i++ ) {
+			elements[i] = remap[ elements[i] ];
+		}
+	} else {
+		elements.swap( remap );
+		indexed = true;
+	}
+
+	points.swap( newPoints );
+	normals.swap( newNormals );
+	uv.swap( newUV );
+	colors.swap( newColors );
+	numElements = count;
+
+	return( count );
+}
+
+///
+/// Replace the index list (e.g., with a reordered copy)
+///
+/// The Canvas must already be indexed, and the new list must
+/// refer only to existing vertices.
+///
+/// @param e   The new index list
+/// @return true if the list was accepted, else false
+///
+bool Canvas::setElements( const vector<GLuint> &e )
+{
+	if( !indexed ) {
+		return( false );
+	}
+
+	for( size_t i = 0; i < e.size(); i++ ) {
+		if( e[i] >= (GLuint) numElements ) {
+			cerr << "setElements: index " << e[i] << " out of range" << endl;
+			return( false );
+		}
+	}
+
+	elements.assign( e.begin(), e.end() );
+	return( true );
+}
+
+///
+/// Apply a remapping to one kind of vertex data
+///
+/// @param data     The data to be moved
+/// @param comps    Number of values per vertex
+/// @param remap    New position of each vertex (~0u to drop it)
+/// @param count    Number of vertices remaining
+///
+static void remapData( FloatVec &data, int comps,
+	const vector<GLuint> &remap, int count )
+{
+	if( data.empty() ) {
+		return;
+	}
+
+	FloatVec moved( (size_t) count * comps, 0.0f, data.get_allocator() );
+	for( size_t i = 0; i < remap.size(); i++ ) {
+		if( remap[i] != ~0u ) {
+			for( int j = 0; j < comps; j++ ) {
+				moved[remap[i] * comps + j] = data[i * comps + j];
+			}
+		}
+	}
+	data.swap( moved );
+}
+
+///
+/// Move the vertices to new positions, updating the index list
+///
+/// @param remap   New position of each vertex (~0u to drop it)
+/// @param count   Number of vertices remaining
+///
+void Canvas::remapVertices( const vector<GLuint> &remap, int count )
+{
+	if( !indexed || remap.size() != (size_t) numElements ) {
+		cerr << "remapVertices: remap doesn't match the vertices" << endl;
+		return;
+	}
+
+	remapData( points, 4, remap, count );
+	remapData( normals, 3, remap, count );
+	remapData( uv, 2, remap, count );
+	remapData( colors, 4, remap, count );
+
+	for( size_t i = 0; i < elements.size(); i++ ) {
+		elements[i] = remap[ elements[i] ];
+	}
+	numElements = count;
+}
@@ -46,11 +46,28 @@
 #include <GLFW/glfw3.h>
 
 #include "Types.h"
+#include "Arena.h"
 
 using namespace std;
 
+#include <cstdint>
 #include <vector>
 
+///
+/// Per-vertex data and index lists, drawn from a Canvas' arena
+///
+typedef vector<float, ArenaAllocator<float> > FloatVec;
+typedef vector<GLuint, ArenaAllocator<GLuint> > IndexVec;
+
+///
+/// Largest errors introduced by packing a Canvas' vertex data
+///
+typedef struct st_packerr {
+	float position;   // model-space distance, per component
+	float normal;     // angle, in degrees
+	float uv;         // texture-space distance, per component
+} PackError;
+
 ///
 /// Simple canvas class that allows for pixel-by-pixel rendering.
 ///
@@ -63,30 +80,39 @@ class Canvas {
 	int width;
 	int height;
 
+	//
+	// storage for everything below; reused from one shape to the next
+	//
+	MemArena pool;
+
 	//
 	// point-related data
 	//
 
 	// vertex locations
-	vector<float> points;
+	FloatVec points;
 	float *pointArray;
 
 	// associated normal vectors
-	vector<float> normals;
+	FloatVec normals;
 	float *normalArray;
 
 	// associated (u,v) coordinates
-	vector<float> uv;
+	FloatVec uv;
 	float *uvArray;
 
 	// associated color data
-	vector<float> colors;
+	FloatVec colors;
 	float *colorArray;
 
 	// element count and connectivity data
 	int numElements;
 	GLuint *elemArray;
 
+	// real index list, once the vertices have been welded
+	IndexVec elements;
+	bool indexed;
+
 	//
 	// other Canvas defaults
 	//
@@ -111,6 +137,10 @@ public:
 	///
 	~Canvas( void );
 
+	// a Canvas owns its storage, so it can't be copied
+	Canvas( const Canvas & ) = delete;
+	Canvas &operator=( const Canvas & ) = delete;
+
 	/////////////////////////////////////
 	// Basic Canvas manipulation
 	/////////////////////////////////////
@@ -118,8 +148,29 @@ public:
 	///
 	/// Clear the canvas
 	///
+	/// Its storage is kept for the next shape; arrays returned by
+	/// the get*() functions are no longer valid afterward.
+	///
 	void clear( void );
 
+	///
+	/// Reserve space for the vertices of the next shape
+	///
+	/// Optional; with a good estimate, the shape's data is built
+	/// without any reallocation.
+	///
+	/// @param nverts   expected number of vertices
+	///
+	void reserve( int nverts );
+
+	///
+	/// Access the arena holding this Canvas' data (e.g., for statistics,
+	/// or to enable huge pages)
+	///
+	/// @return the arena
+	///
+	MemArena &storage( void ) { return( pool ); }
+
 	///
 	/// Set the pixel Z coordinate
 	///
@@ -238,6 +289,40 @@ public:
 	///
 	void addTextureCoords( TexCoord uv0, TexCoord uv1, TexCoord uv2 );
 
+	///
+	/// Add many triangles at once from indexed tables of data
+	///
+	/// Space for all the new data is reserved up front.  Unless normals
+	/// are supplied, each triangle gets its face normal (as with
+	/// addTriangle()), computed several triangles at a time with SSE
+	/// where it is available.
+	///
+	/// @param verts   vertex locations
+	/// @param tris    three indices into 'verts' (and the other tables)
+	///                for each triangle
+	/// @param ntris   number of triangles
+	/// @param uvs     (u,v) data for each vertex (or NULL)
+	/// @param norms   normal for each vertex (or NULL for face normals)
+	///
+	void addTriangles( const Vertex *verts, const GLuint *tris, int ntris,
+		const TexCoord *uvs = nullptr, const Normal *norms = nullptr );
+
+	///
+	/// Add an indexed mesh whose vertices are already shared
+	///
+	/// The Canvas becomes indexed (see weld()); anything added to it
+	/// before keeps its own vertices.
+	///
+	/// @param verts    vertex locations
+	/// @param norms    normal for each vertex (or NULL)
+	/// @param uvs      (u,v) data for each vertex (or NULL)
+	/// @param nverts   number of vertices
+	/// @param idx      indices into the vertex tables, three per triangle
+	/// @param nidx     number of indices
+	///
+	void addMesh( const Vertex *verts, const Normal *norms,
+		const TexCoord *uvs, int nverts, const GLuint *idx, int nidx );
+
 	/////////////////////////////////////
 	//
 	// Retrieving things from the Canvas
@@ -279,6 +364,119 @@ public:
 	///
 	float *getColors( void );
 
+	///
+	/// Write the vertex locations (XYZW) into caller-supplied memory
+	/// (e.g., a mapped buffer object), without an intermediate copy
+	///
+	/// @param dst  Destination; must have room for numVertices() vertices
+	///
+	void writeVertices( float *dst );
+
+	///
+	/// Write the normals (XYZ) into caller-supplied memory
+	///
+	/// @param dst  Destination; must have room for numVertices() normals
+	///
+	void writeNormals( float *dst );
+
+	///
+	/// Write the texture coordinates (UV) into caller-supplied memory
+	///
+	/// @param dst  Destination; must have room for numVertices() pairs
+	///
+	void writeUV( float *dst );
+
+	///
+	/// Write the colors (RGBA) into caller-supplied memory
+	///
+	/// @param dst  Destination; must have room for numVertices() colors
+	///
+	void writeColors( float *dst );
+
+	///
+	/// Write the element (connectivity) data into caller-supplied memory
+	///
+	/// @param dst  Destination; must have room for numIndices() indices
+	///
+	void writeElements( GLuint *dst );
+
+	///
+	/// Write the element data as 16-bit indices; the Canvas must not
+	/// hold more than 65536 vertices
+	///
+	/// @param dst  Destination; must have room for numIndices() indices
+	///
+	void writeElements( GLushort *dst );
+
+	///
+	/// Determine how many floats each vertex occupies when interleaved
+	///
+	/// @return the number of floats per interleaved vertex
+	///
+	int interleavedFloats( void );
+
+	///
+	/// Write all the vertex data into caller-supplied memory, interleaved
+	///
+	/// Each vertex is stored as XYZ, followed by the normal (XYZ),
+	/// the texture coordinates (UV), and the color (RGBA), each of
+	/// those only if the Canvas holds that kind of data.
+	///
+	/// @param dst  Destination; must have room for numVertices() *
+	///             interleavedFloats() floats
+	///
+	void writeInterleaved( float *dst );
+
+	///
+	/// Write the vertex locations as tightly packed XYZ triples into
+	/// caller-supplied memory (e.g., for depth-only drawing)
+	///
+	/// @param dst  Destination; must have room for numVertices() triples
+	///
+	void writePositions( float *dst );
+
+	///
+	/// Determine the bounding box of the vertex locations
+	///
+	/// @param lo   Receives the smallest X, Y, and Z
+	/// @param hi   Receives the largest X, Y, and Z
+	///
+	void getBounds( float lo[3], float hi[3] );
+
+	///
+	/// Write all the vertex data into caller-supplied memory, packed
+	///
+	/// Each vertex is stored as XYZW in 16-bit normalized integers
+	/// (relative to 'offset' and 'scale'), followed by the normal in
+	/// 2_10_10_10_REV format, the texture coordinates as two half
+	/// floats, and the color as four unsigned bytes, each of those
+	/// only if the Canvas holds that kind of data.
+	///
+	/// @param dst      Destination; must have room for numVertices() *
+	///                 packedSize() bytes
+	/// @param scale    Half the extent of the data along each axis
+	/// @param offset   Center of the data along each axis
+	/// @param err      Receives the largest errors introduced
+	///
+	void writePacked( void *dst, const float scale[3],
+		const float offset[3], PackError &err );
+
+	///
+	/// Determine how many bytes each vertex occupies when packed
+	///
+	/// @return the number of bytes per packed vertex
+	///
+	int packedSize( void );
+
+	///
+	/// Determine which kinds of per-vertex data this Canvas holds
+	///
+	/// @return true if the data is present, else false
+	///
+	bool hasNormals( void ) { return( normals.size() > 0 ); }
+	bool hasUV( void ) { return( uv.size() > 0 ); }
+	bool hasColors( void ) { return( colors.size() > 0 ); }
+
 	///
 	/// Retrieve the vertex count from this Canvas
 	///
@@ -286,6 +484,60 @@ public:
 	///
 	int numVertices( void );
 
+	///
+	/// Retrieve the index count from this Canvas (three per triangle)
+	///
+	/// @return The number of indices in the canvas
+	///
+	int numIndices( void );
+
+	///
+	/// Determine whether the vertices have been welded
+	///
+	/// @return true if the element data is a real index list
+	///
+	bool isIndexed( void ) { return( indexed ); }
+
+	///
+	/// Compute a hash of everything in the Canvas (vertex data and
+	/// index list); Canvases with the same contents hash the same
+	///
+	/// @return the hash
+	///
+	uint64_t contentHash( void );
+
+	///
+	/// Weld identical vertices together
+	///
+	/// Vertices with exactly the same location, normal, texture
+	/// coordinates, and color are merged, leaving a compact set of
+	/// vertices and an index list that refers to them.  Data added
+	/// afterward is indexed as it arrives, and can be welded by
+	/// calling this again.
+	///
+	/// @return The number of vertices remaining
+	///
+	int weld( void );
+
+	///
+	/// Replace the index list (e.g., with a reordered copy)
+	///
+	/// The Canvas must already be indexed, and the new list must
+	/// refer only to existing vertices.
+	///
+	/// @param e   The new index list
+	/// @return true if the list was accepted, else false
+	///
+	bool setElements( const vector<GLuint> &e );
+
+	///
+	/// Move the vertices to new positions, updating the index list
+	///
+	/// @param remap   New position of each vertex (~0u to drop it)
+	/// @param count   Number of vertices remaining
+	///
+	void remapVertices( const vector<GLuint> &remap, int count );
+
 };
 
 #endif
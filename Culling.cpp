@@ -0,0 +1,285 @@
+//
+//  Culling.cpp
+//
+//  Bounding volumes, and view frustum culling of large numbers of
+//  objects.
+//
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "Culling.h"
+#include "ThreadPool.h"
+
+// test four objects at a time with SSE where we have it
+#if defined(__SSE__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CULL_SSE
+#include <xmmintrin.h>
+#endif
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// Make a plane's normal unit length
+///
+/// @param p   the plane (a,b,c,d)
+///
+/// @return the normalized plane
+///
+static glm::vec4 normalizePlane( const glm::vec4 &p )
+{
+	float len = sqrtf( p.x * p.x + p.y * p.y + p.z * p.z );
+
+	return( len > 0.0f ? p / len : p );
+}
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Compute the bounds of a set of vertices
+///
+/// @param pts   the vertices (x, y, z, w for each)
+/// @param n     how many there are
+/// @param b     receives their bounds
+///
+void computeBounds( const float *pts, int n, Bounds &b )
+{
+	glm::vec3 lo( FLT_MAX ), hi( -FLT_MAX );
+
+	if( pts == nullptr || n < 1 ) {
+		b.center = b.extent = glm::vec3( 0.0f );
+		b.radius = 0.0f;
+		return;
+	}
+
+	for( int i = 0; i < n; ++i ) {
+		const float *p = pts + 4 * i;
+		for( int k = 0; k < 3; ++k ) {
+			lo[k] = std::min( lo[k], p[k] );
+			hi[k] = std::max( hi[k], p[k] );
+		}
+	}
+
+	b.center = (lo + hi) * 0.5f;
+	b.extent = (hi - lo) * 0.5f;
+
+	// the sphere is centered on the box, so it is never larger than
+	// the box's corners, and is often smaller
+	float r2 = 0.0f;
+	for( int i = 0; i < n; ++i ) {
+		const float *p = pts + 4 * i;
+		float dx = p[0] - b.center.x;
+		float dy = p[1] - b.center.y;
+		float dz = p[2] - b.center.z;
+		r2 = std::max( r2, dx * dx + dy * dy + dz * dz );
+	}
+	b.radius = sqrtf( r2 );
+}
+
+///
+/// Extract the planes of the view frustum
+///
+/// @param projView   the projection matrix times the view matrix
+/// @param planes     receives the left, right, bottom, top, near,
+///                   and far planes (in world coordinates)
+///
+void extractPlanes( const glm::mat4 &projView, glm::vec4 planes[6] )
+{
+	// a clip-space point is inside when -w <= x,y,z <= w; each
+	// of those is a plane made from two rows of the matrix
+	glm::vec4 row[4];
+	for( int r = 0; r < 4; ++r ) {
+		row[r] = glm::vec4( projView[0][r], projView[1][r],
+			projView[2][r], projView[3][r] );
+	}
+
+	planes[0] = normalizePlane( row[3] + row[0] );   // left
+	planes[1] = normalizePlane( row[3] - row[0] );   // right
+	planes[2] = normalizePlane( row[3] + row[1] );   // bottom
+	planes[3] = normalizePlane( row[3] - row[1] );   // top
+	planes[4] = normalizePlane( row[3] + row[2] );   // near
+	planes[5] = normalizePlane( row[3] - row[2] );   // far
+}
+
+///
+/// Constructor
+///
+CullSet::CullSet( void ) {
+	clear();
+}
+
+///
+/// clear() - empty the set at the start of a frame
+///
+void CullSet::clear( void ) {
+	cx.clear(); cy.clear(); cz.clear();
+	ex.clear(); ey.clear(); ez.clear();
+	radius.clear();
+	visible.clear();
+	count = 0;
+	numVisible = numCulled = 0;
+}
+
+///
+/// add(b,model) - add an object
+///
+/// @param b       the bounds of its mesh
+/// @param model   its model transformation
+///
+/// @return its position in the set
+///
+int CullSet::add( const Bounds &b, const glm::mat4 &model ) {
+	const glm::mat4 &m = model;
+
+	// drop any padding left by the last cull()
+	if( (int) cx.size() != count ) {
+		cx.resize( count ); cy.resize( count ); cz.resize( count );
+		ex.resize( count ); ey.resize( count ); ez.resize( count );
+		radius.resize( count );
+	}
+
+	glm::vec4 c = m * glm::vec4( b.center, 1.0f );
+	cx.push_back( c.x );
+	cy.push_back( c.y );
+	cz.push_back( c.z );
+
+	// the box that holds the transformed box
+	ex.push_back( fabsf(m[0][0]) * b.extent.x + fabsf(m[1][0]) * b.extent.y +
+		fabsf(m[2][0]) * b.extent.z );
+	ey.push_back( fabsf(m[0][1]) * b.extent.x + fabsf(m[1][1]) * b.extent.y +
+		fabsf(m[2][1]) * b.extent.z );
+	ez.push_back( fabsf(m[0][2]) * b.extent.x + fabsf(m[1][2]) * b.extent.y +
+		fabsf(m[2][2]) * b.extent.z );
+
+	// the sphere grows by the largest scale factor
+	float s2 = 0.0f;
+	for( int k = 0; k < 3; ++k ) {
+		s2 = std::max( s2, m[k][0] * m[k][0] + m[k][1] * m[k][1] +
+			m[k][2] * m[k][2] );
+	}
+	radius.push_back( b.radius * sqrtf( s2 ) );
+
+	return( count++ );
+}
+
+///
+/// cull(projView) - decide which of the objects may be visible
+///
+/// @param projView   the projection matrix times the view matrix
+///
+void CullSet::cull( const glm::mat4 &projView ) {
+	glm::vec4 planes[6];
+
+	extractPlanes( projView, planes );
+
+	// pad the arrays so the last group of objects can be loaded whole
+	size_t padded = (count + CULL_WIDTH - 1) / CULL_WIDTH * CULL_WIDTH;
+	cx.resize( padded ); cy.resize( padded ); cz.resize( padded );
+	ex.resize( padded ); ey.resize( padded ); ez.resize( padded );
+	radius.resize( padded );
+	visible.resize( count );
+
+	if( count <= CULL_JOB ) {
+		numVisible = cullRange( planes, 0, count );
+	} else {
+		int njobs = (count + CULL_JOB - 1) / CULL_JOB;
+		vector<long> found( njobs );
+
+		ThreadPool::shared().run( njobs, [&]( int job, int ) {
+			int first = job * CULL_JOB;
+			found[job] = cullRange( planes, first,
+				std::min( count, first + CULL_JOB ) );
+		} );
+
+		numVisible = 0;
+		for( int i = 0; i < njobs; ++i ) {
+			numVisible += found[i];
+		}
+	}
+
+	numCulled = count - numVisible;
+}
+
+///
+/// cullRange(planes,first,last) - test objects first through last-1
+///
+/// @param planes   the frustum planes
+/// @param first    first object (a multiple of CULL_WIDTH)
+/// @param last     one past the last object
+///
+/// @return the number of those objects that may be visible
+///
+long CullSet::cullRange( const glm::vec4 planes[6], int first, int last ) {
+	long n = 0;
+
+#if defined(CULL_SSE)
+	__m128 zero = _mm_setzero_ps();
+	__m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+
+	for( int p = 0; p < 6; ++p ) {
+		px[p] = _mm_set1_ps( planes[p].x );
+		py[p] = _mm_set1_ps( planes[p].y );
+		pz[p] = _mm_set1_ps( planes[p].z );
+		pw[p] = _mm_set1_ps( planes[p].w );
+		ax[p] = _mm_set1_ps( fabsf( planes[p].x ) );
+		ay[p] = _mm_set1_ps( fabsf( planes[p].y ) );
+		az[p] = _mm_set1_ps( fabsf( planes[p].z ) );
+	}
+
+	for( int i = first; i < last; i += CULL_WIDTH ) {
+		__m128 x = _mm_loadu_ps( &cx[i] );
+		__m128 y = _mm_loadu_ps( &cy[i] );
+		__m128 z = _mm_loadu_ps( &cz[i] );
+		__m128 sx = _mm_loadu_ps( &ex[i] );
+		__m128 sy = _mm_loadu_ps( &ey[i] );
+		__m128 sz = _mm_loadu_ps( &ez[i] );
+		__m128 r = _mm_loadu_ps( &radius[i] );
+		__m128 in = _mm_cmpeq_ps( zero, zero );
+
+		for( int p = 0; p < 6; ++p ) {
+			// distance from the plane to the center
+			__m128 d = _mm_add_ps(
+				_mm_add_ps( _mm_mul_ps( px[p], x ), _mm_mul_ps( py[p], y ) ),
+				_mm_add_ps( _mm_mul_ps( pz[p], z ), pw[p] ) );
+
+			// how far toward the plane the box reaches
+			__m128 reach = _mm_add_ps(
+				_mm_add_ps( _mm_mul_ps( ax[p], sx ), _mm_mul_ps( ay[p], sy ) ),
+				_mm_mul_ps( az[p], sz ) );
+
+			reach = _mm_min_ps( reach, r );
+			in = _mm_and_ps( in, _mm_cmpge_ps( _mm_add_ps( d, reach ), zero ) );
+		}
+
+		int bits = _mm_movemask_ps( in );
+		int m = std::min( CULL_WIDTH, last - i );
+		for( int k = 0; k < m; ++k ) {
+			visible[i + k] = (bits >> k) & 1;
+			n += visible[i + k];
+		}
+	}
+#else
+	for( int i = first; i < last; ++i ) {
+		bool in = true;
+
+		for( int p = 0; p < 6 && in; ++p ) {
+			const glm::vec4 &pl = planes[p];
+			float d = pl.x * cx[i] + pl.y * cy[i] + pl.z * cz[i] + pl.w;
+			float reach = fabsf(pl.x) * ex[i] + fabsf(pl.y) * ey[i] +
+				fabsf(pl.z) * ez[i];
+			in = d + std::min( reach, radius[i] ) >= 0.0f;
+		}
+
+		visible[i] = in;
+		n += in;
+	}
+#endif
+
+	return( n );
+}
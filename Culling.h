@@ -0,0 +1,137 @@
+//
+//  Culling.h
+//
+//  Bounding volumes, and view frustum culling of large numbers of
+//  objects.
+//
+//  Each mesh gets a bounding box and a bounding sphere (both centered
+//  on the middle of the box) when it is built.  Every frame, the bounds
+//  of each object to be drawn are moved into world space by its model
+//  transformation and added to a CullSet, which then tests them all
+//  against the six planes of the view frustum.
+//
+//  The CullSet keeps its bounds as a structure of arrays (all the
+//  center X values together, then all the Y values, ...), so that
+//  each plane can be tested against four objects at a time with SSE.
+//  Large sets are split into jobs on the shared ThreadPool.
+//
+//  An object is culled if either of its bounding volumes lies entirely
+//  outside any one plane; at each plane, the test uses whichever of the
+//  two volumes reaches less far toward the plane.
+//
+
+#ifndef CULLING_H_
+#define CULLING_H_
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+using namespace std;
+
+//
+// Objects are tested this many at a time
+//
+#define CULL_WIDTH      4
+
+//
+// Sets larger than this are split into jobs of this many objects
+//
+#define CULL_JOB        16384
+
+///
+/// Bounding volumes for a mesh (in model coordinates)
+///
+typedef struct st_bounds {
+	glm::vec3 center;    // center of the box and of the sphere
+	glm::vec3 extent;    // half the box's size along each axis
+	float radius;        // radius of the sphere
+} Bounds;
+
+///
+/// Compute the bounds of a set of vertices
+///
+/// @param pts   the vertices (x, y, z, w for each)
+/// @param n     how many there are
+/// @param b     receives their bounds
+///
+void computeBounds( const float *pts, int n, Bounds &b );
+
+///
+/// Extract the planes of the view frustum
+///
+/// Each plane is (a,b,c,d) with (a,b,c) its unit normal pointing into
+/// the frustum, so a point p is inside when dot(p,(a,b,c)) + d >= 0.
+///
+/// @param projView   the projection matrix times the view matrix
+/// @param planes     receives the left, right, bottom, top, near,
+///                   and far planes (in world coordinates)
+///
+void extractPlanes( const glm::mat4 &projView, glm::vec4 planes[6] );
+
+class CullSet {
+
+public:
+	// world-space bounds of each object, one array per component
+	// (padded with zeros to a multiple of CULL_WIDTH)
+	vector<float> cx, cy, cz;
+	vector<float> ex, ey, ez;
+	vector<float> radius;
+
+	// results of the last cull():  nonzero for each object that may
+	// be visible
+	vector<unsigned char> visible;
+
+	// number of objects in the set
+	int count;
+
+	// what the last cull() found
+	long numVisible, numCulled;
+
+public:
+
+	///
+	/// Constructor
+	///
+	CullSet( void );
+
+	///
+	/// clear() - empty the set at the start of a frame
+	///
+	void clear( void );
+
+	///
+	/// add(b,model) - add an object
+	///
+	/// @param b       the bounds of its mesh
+	/// @param model   its model transformation
+	///
+	/// @return its position in the set
+	///
+	int add( const Bounds &b, const glm::mat4 &model );
+
+	///
+	/// cull(projView) - decide which of the objects may be visible
+	///
+	/// @param projView   the projection matrix times the view matrix
+	///
+	void cull( const glm::mat4 &projView );
+
+private:
+
+	///
+	/// cullRange(planes,first,last) - test objects first through last-1
+	///
+	/// @param planes   the frustum planes
+	/// @param first    first object (a multiple of CULL_WIDTH)
+	/// @param last     one past the last object
+	///
+	/// @return the number of those objects that may be visible
+	///
+	long cullRange( const glm::vec4 planes[6], int first, int last );
+
+};
+
+#endif
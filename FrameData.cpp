@@ -0,0 +1,113 @@
+//
+//  FrameData.cpp
+//
+//  Per-frame uniform block shared by all shader programs.
+//
+//  The camera, projection, and lighting values are the same for every
+//  object drawn in a frame, so rather than sending them to each program
+//  for each object, they are kept in a single std140 uniform buffer
+//  that is bound to every program which declares the FrameData block.
+//  The buffer is only rewritten when one of the values changes.
+//
+
+#include <cstring>
+#include <iostream>
+
+#include "FrameData.h"
+
+#include "Lighting.h"
+#include "Utils.h"
+#include "Viewing.h"
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+using namespace std;
+
+//
+// Layout of the FrameData block.  Under std140 rules a mat4 is four
+// vec4 columns, and every member here is a multiple of 16 bytes, so
+// the C++ structure matches the GLSL block with no padding.
+//
+struct FrameBlock {
+	glm::mat4 viewMat;
+	glm::mat4 projMat;
+	glm::vec4 lightPosition;
+	glm::vec4 lightColor;
+	glm::vec4 ambientLight;
+};
+
+// the uniform buffer
+static GLuint ubo = 0;
+
+// what we last sent to it
+static FrameBlock current;
+static bool valid = false;
+
+///
+/// Create the uniform buffer holding the per-frame data
+///
+void initFrameData( void )
+{
+	glGenBuffers( 1, &ubo );
+	glBindBuffer( GL_UNIFORM_BUFFER, ubo );
+	glBufferData( GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr,
+				  GL_DYNAMIC_DRAW );
+	glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_BINDING, ubo );
+	valid = false;
+}
+
+///
+/// Connect a shader program's FrameData block to the shared buffer
+///
+/// @param program   The ID of an OpenGL (GLSL) shader program
+/// @return true if the program uses the block, false if its per-frame
+///         values must be sent as individual uniforms instead
+///
+bool bindFrameData( GLuint program )
+{
+	GLuint index = glGetUniformBlockIndex( program, "FrameData" );
+	if( index == GL_INVALID_INDEX ) {
+		return( false );
+	}
+
+	GLint size;
+	glGetActiveUniformBlockiv( program, index,
+							   GL_UNIFORM_BLOCK_DATA_SIZE, &size );
+	if( size != (GLint) sizeof(FrameBlock) ) {
+		cerr << "bindFrameData: program " << program << " block is "
+			 << size << " bytes, expected " << sizeof(FrameBlock) << endl;
+		return( false );
+	}
+
+	glUniformBlockBinding( program, index, FRAME_BINDING );
+
+	return( true );
+}
+
+///
+/// Gather the current camera, projection, and lighting values, and
+/// upload them to the shared buffer if any of them have changed
+///
+/// @return true if the buffer was rewritten
+///
+bool updateFrameData( void )
+{
+	FrameBlock fb;
+
+	fb.viewMat = cameraMatrix();
+	fb.projMat = projectionMatrix();
+	getLighting( fb.lightPosition, fb.lightColor, fb.ambientLight );
+
+	if( valid && memcmp(&fb, &current, sizeof(FrameBlock)) == 0 ) {
+		return( false );
+	}
+
+	glBindBuffer( GL_UNIFORM_BUFFER, ubo );
+	glBufferSubData( GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &fb );
+
+	current = fb;
+	valid = true;
+
+	return( true );
+}
@@ -0,0 +1,48 @@
+//
+//  FrameData.h
+//
+//  Per-frame uniform block shared by all shader programs.
+//
+//  The camera, projection, and lighting values are the same for every
+//  object drawn in a frame, so rather than sending them to each program
+//  for each object, they are kept in a single std140 uniform buffer
+//  that is bound to every program which declares the FrameData block.
+//  The buffer is only rewritten when one of the values changes.
+//
+
+#ifndef FRAMEDATA_H_
+#define FRAMEDATA_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+// uniform buffer binding point used for the FrameData block
+#define FRAME_BINDING   0
+
+///
+/// Create the uniform buffer holding the per-frame data
+///
+void initFrameData( void );
+
+///
+/// Connect a shader program's FrameData block to the shared buffer
+///
+/// @param program   The ID of an OpenGL (GLSL) shader program
+/// @return true if the program uses the block, false if its per-frame
+///         values must be sent as individual uniforms instead
+///
+bool bindFrameData( GLuint program );
+
+///
+/// Gather the current camera, projection, and lighting values, and
+/// upload them to the shared buffer if any of them have changed
+///
+/// @return true if the buffer was rewritten
+///
+bool updateFrameData( void );
+
+#endif
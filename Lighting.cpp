@@ -31,6 +31,20 @@ glm::vec4 lightpos(  15.0f, 18.0f, 20.0f, 1.0f );
 static glm::vec4 lightcolor( 1.0f, 1.0f, 1.0f, 1.0f );
 static glm::vec4 amblight(   0.7f, 0.7f, 0.7f, 1.0f );
 
+///
+/// This function retrieves the current lighting parameters.
+///
+/// @param pos      Receives the light position (in world space)
+/// @param color    Receives the light color
+/// @param ambient  Receives the ambient light color
+///
+void getLighting( glm::vec4 &pos, glm::vec4 &color, glm::vec4 &ambient )
+{
+	pos = lightpos;
+	color = lightcolor;
+	ambient = amblight;
+}
+
 ///
 /// This function sets up the lighting, material, and shading parameters
 /// for the shaders.
@@ -43,17 +57,17 @@ void setLighting( GLuint program )
 	GLint loc;
 
 	// Lighting parameters
-	loc = getUniformLoc( program, "lightPosition" );
+	loc = getUniformLoc( program, U_LIGHT_POSITION );
 	if( loc >= 0 ) {
 		glUniform4fv( loc, 1, glm::value_ptr(lightpos) );
 	}
 
-	loc = getUniformLoc( program, "lightColor" );
+	loc = getUniformLoc( program, U_LIGHT_COLOR );
 	if( loc >= 0 ) {
 		glUniform4fv( loc, 1, glm::value_ptr(lightcolor) );
 	}
 
-	loc = getUniformLoc( program, "ambientLight" );
+	loc = getUniformLoc( program, U_AMBIENT_LIGHT );
 	if( loc >= 0 ) {
 		glUniform4fv( loc, 1, glm::value_ptr(amblight) );
 	}
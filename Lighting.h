@@ -30,6 +30,15 @@
 extern glm::vec4 lpDefault;
 extern glm::vec4 lightpos;
 
+///
+/// This function retrieves the current lighting parameters.
+///
+/// @param pos      Receives the light position (in world space)
+/// @param color    Receives the light color
+/// @param ambient  Receives the ambient light color
+///
+void getLighting( glm::vec4 &pos, glm::vec4 &color, glm::vec4 &ambient );
+
 ///
 /// This function sets up the lighting parameters for the shaders.
 ///
@@ -0,0 +1,425 @@
+//
+//  MaskedOcclusion.cpp
+//
+//  Software occlusion culling with a masked, tiled depth buffer.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "MaskedOcclusion.h"
+#include "ThreadPool.h"
+
+// find pixel coverage four pixels at a time with SSE where we have it
+#if defined(__SSE__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MOC_SSE
+#include <xmmintrin.h>
+#endif
+
+//
+// PRIVATE GLOBALS
+//
+
+// tile rows in each band
+#define MOC_BAND_ROWS   (MOC_TILES_Y / MOC_BANDS)
+
+// the faces of a box, as corner numbers (bit 0 set for +X, bit 1 for
+// +Y, bit 2 for +Z), each counter-clockwise seen from outside
+static const int boxFaces[6][4] = {
+	{ 0, 2, 3, 1 }, { 4, 5, 7, 6 },     // -Z, +Z
+	{ 0, 1, 5, 4 }, { 2, 6, 7, 3 },     // -Y, +Y
+	{ 0, 4, 6, 2 }, { 1, 3, 7, 5 }      // -X, +X
+};
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// Find the corners of a box on the screen
+///
+/// @param m        projection * view * model for the box
+/// @param center   center of the box
+/// @param extent   half its size along each axis
+/// @param pts      receives the corners (pixels, pixels, window depth)
+///
+/// @return false if the box reaches the eye or the near plane (so
+///         the corners are not meaningful)
+///
+static bool projectBox( const glm::mat4 &m, const glm::vec3 &center,
+	const glm::vec3 &extent, glm::vec3 pts[8] )
+{
+	glm::vec4 c = m * glm::vec4( center, 1.0f );
+	glm::vec4 ax = m[0] * extent.x;
+	glm::vec4 ay = m[1] * extent.y;
+	glm::vec4 az = m[2] * extent.z;
+
+	for( int k = 0; k < 8; ++k ) {
+		glm::vec4 v = c + ((k & 1) ? ax : ax * -1.0f)
+						+ ((k & 2) ? ay : ay * -1.0f)
+						+ ((k & 4) ? az : az * -1.0f);
+
+		if( v.w <= 0.0f || v.z < -v.w ) {
+			return( false );
+		}
+
+		pts[k] = glm::vec3( (v.x / v.w * 0.5f + 0.5f) * MOC_WIDTH,
+							(v.y / v.w * 0.5f + 0.5f) * MOC_HEIGHT,
+							v.z / v.w * 0.5f + 0.5f );
+	}
+
+	return( true );
+}
+
+///
+/// The bits of a 32-pixel row from column c0 through c1
+///
+/// @param c0   first column (0-31)
+/// @param c1   last column (c0-31)
+///
+/// @return the mask
+///
+static uint32_t rowBits( int c0, int c1 )
+{
+	uint32_t n = c1 - c0 + 1;
+
+	return( (n >= 32 ? ~0u : ((1u << n) - 1u)) << c0 );
+}
+
+///
+/// addTriangle(a,b,c) - add an occluder triangle, unless it faces
+///     away or is off the screen
+///
+/// @param a,b,c   its corners (pixels, pixels, window depth)
+///
+void MaskedOcclusion::addTriangle( const glm::vec3 &a, const glm::vec3 &b,
+	const glm::vec3 &c ) {
+
+	// window Y is up, so front faces have positive area
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if( !(area > 0.0f) ) {
+		return;
+	}
+
+	if( std::max( a.x, std::max( b.x, c.x ) ) < 0.0f ||
+		std::min( a.x, std::min( b.x, c.x ) ) >= MOC_WIDTH ||
+		std::max( a.y, std::max( b.y, c.y ) ) < 0.0f ||
+		std::min( a.y, std::min( b.y, c.y ) ) >= MOC_HEIGHT ) {
+		return;
+	}
+
+	vx[0].push_back( a.x ); vy[0].push_back( a.y );
+	vx[1].push_back( b.x ); vy[1].push_back( b.y );
+	vx[2].push_back( c.x ); vy[2].push_back( c.y );
+	tz.push_back( std::max( a.z, std::max( b.z, c.z ) ) );
+	triangles += 1;
+}
+
+///
+/// drawTriangle(t,rowFirst,rowLast) - draw the part of a triangle
+///     in tile rows rowFirst through rowLast
+///
+/// A pixel is covered if its center is strictly inside the triangle,
+/// so shared edges are left uncovered rather than covered twice; an
+/// occluder may cover too little, but never too much.
+///
+/// @param t          which triangle
+/// @param rowFirst   first tile row
+/// @param rowLast    last tile row
+///
+void MaskedOcclusion::drawTriangle( int t, int rowFirst, int rowLast ) {
+	float A[3], B[3], C[3];
+
+	// edge k runs from corner k to the next; inside is positive
+	for( int k = 0; k < 3; ++k ) {
+		int j = (k + 1) % 3;
+		A[k] = vy[k][t] - vy[j][t];
+		B[k] = vx[j][t] - vx[k][t];
+		C[k] = -(A[k] * vx[k][t] + B[k] * vy[k][t]);
+	}
+
+	float xlo = std::min( vx[0][t], std::min( vx[1][t], vx[2][t] ) );
+	float xhi = std::max( vx[0][t], std::max( vx[1][t], vx[2][t] ) );
+	float ylo = std::min( vy[0][t], std::min( vy[1][t], vy[2][t] ) );
+	float yhi = std::max( vy[0][t], std::max( vy[1][t], vy[2][t] ) );
+
+	int x0 = std::max( 0, (int) xlo );
+	int x1 = std::min( MOC_WIDTH - 1, (int) xhi );
+	int y0 = std::max( 0, (int) ylo );
+	int y1 = std::min( MOC_HEIGHT - 1, (int) yhi );
+
+	int ty0 = std::max( rowFirst, y0 / MOC_TILE_H );
+	int ty1 = std::min( rowLast, y1 / MOC_TILE_H );
+
+	for( int ty = ty0; ty <= ty1; ++ty ) {
+		for( int tx = x0 / MOC_TILE_W; tx <= x1 / MOC_TILE_W; ++tx ) {
+			uint32_t cover[MOC_TILE_H];
+			uint32_t any = 0;
+			float left = tx * MOC_TILE_W + 0.5f;
+
+			for( int r = 0; r < MOC_TILE_H; ++r ) {
+				int y = ty * MOC_TILE_H + r;
+				cover[r] = 0;
+				if( y < y0 || y > y1 ) {
+					continue;
+				}
+				float py = y + 0.5f;
+
+#if defined(MOC_SSE)
+				__m128 zero = _mm_setzero_ps();
+				__m128 xs = _mm_add_ps( _mm_set1_ps( left ),
+					_mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f ) );
+				__m128 e[3], step[3];
+				for( int k = 0; k < 3; ++k ) {
+					e[k] = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( A[k] ), xs ),
+						_mm_set1_ps( B[k] * py + C[k] ) );
+					step[k] = _mm_set1_ps( 4.0f * A[k] );
+				}
+				for( int q = 0; q < MOC_TILE_W / 4; ++q ) {
+					__m128 in = _mm_and_ps(
+						_mm_and_ps( _mm_cmpgt_ps( e[0], zero ),
+									_mm_cmpgt_ps( e[1], zero ) ),
+						_mm_cmpgt_ps( e[2], zero ) );
+					cover[r] |= (uint32_t) _mm_movemask_ps( in ) << (4 * q);
+					for( int k = 0; k < 3; ++k ) {
+						e[k] = _mm_add_ps( e[k], step[k] );
+					}
+				}
+#else
+				for( int c = 0; c < MOC_TILE_W; ++c ) {
+					float px = left + c;
+					if( A[0] * px + B[0] * py + C[0] > 0.0f &&
+						A[1] * px + B[1] * py + C[1] > 0.0f &&
+						A[2] * px + B[2] * py + C[2] > 0.0f ) {
+						cover[r] |= 1u << c;
+					}
+				}
+#endif
+				any |= cover[r];
+			}
+
+			if( any != 0 ) {
+				updateTile( ty * MOC_TILES_X + tx, cover, tz[t] );
+			}
+		}
+	}
+}
+
+///
+/// updateTile(tile,cover,z) - merge a triangle into a tile
+///
+/// @param tile    which tile
+/// @param cover   the pixels it covers (a mask per row)
+/// @param z       its farthest depth
+///
+void MaskedOcclusion::updateTile( int tile, const uint32_t cover[MOC_TILE_H],
+	float z ) {
+	uint32_t *m = &masks[tile * MOC_TILE_H];
+
+	// nothing here is farther than the reference layer already says
+	if( z >= zMax0[tile] ) {
+		return;
+	}
+
+	// a triangle much farther than the working layer would only make
+	// it a poor bound; start the working layer over instead
+	if( z - zMax1[tile] > zMax0[tile] - z ) {
+		zMax1[tile] = 0.0f;
+		for( int r = 0; r < MOC_TILE_H; ++r ) {
+			m[r] = 0;
+		}
+	}
+
+	zMax1[tile] = std::max( zMax1[tile], z );
+	uint32_t full = ~0u;
+	for( int r = 0; r < MOC_TILE_H; ++r ) {
+		m[r] |= cover[r];
+		full &= m[r];
+	}
+
+	// once the working layer covers the tile, it bounds all of it
+	if( full == ~0u ) {
+		zMax0[tile] = std::min( zMax0[tile], zMax1[tile] );
+		zMax1[tile] = 0.0f;
+		for( int r = 0; r < MOC_TILE_H; ++r ) {
+			m[r] = 0;
+		}
+	}
+}
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Constructor
+///
+MaskedOcclusion::MaskedOcclusion( void ) :
+	masks( MOC_TILES_X * MOC_TILES_Y * MOC_TILE_H ),
+	zMax0( MOC_TILES_X * MOC_TILES_Y ), zMax1( MOC_TILES_X * MOC_TILES_Y ),
+	bins( MOC_BANDS ), projView( 1.0f ),
+	occluders(0), triangles(0), tested(0), culled(0) {
+}
+
+///
+/// begin(projView) - clear the buffer for a new frame
+///
+/// @param pv   the projection matrix times the view matrix
+///
+void MaskedOcclusion::begin( const glm::mat4 &pv ) {
+
+	projView = pv;
+
+	std::fill( masks.begin(), masks.end(), 0u );
+	std::fill( zMax0.begin(), zMax0.end(), 1.0f );
+	std::fill( zMax1.begin(), zMax1.end(), 0.0f );
+
+	for( int k = 0; k < 3; ++k ) {
+		vx[k].clear();
+		vy[k].clear();
+	}
+	tz.clear();
+
+	occluders = triangles = tested = culled = 0;
+}
+
+///
+/// addOccluder(box,model) - add a box lying entirely inside an
+///     object to this frame's occluders
+///
+/// @param box     the box (in model coordinates)
+/// @param model   the object's model transformation
+///
+void MaskedOcclusion::addOccluder( const Bounds &box,
+	const glm::mat4 &model ) {
+	glm::vec3 p[8];
+
+	// an occluder that is partly behind the eye is simply left out
+	if( !projectBox( projView * model, box.center, box.extent, p ) ) {
+		return;
+	}
+
+	// so is one too small to hide much
+	glm::vec2 lo( p[0].x, p[0].y ), hi( lo );
+	for( int k = 1; k < 8; ++k ) {
+		lo.x = std::min( lo.x, p[k].x );
+		lo.y = std::min( lo.y, p[k].y );
+		hi.x = std::max( hi.x, p[k].x );
+		hi.y = std::max( hi.y, p[k].y );
+	}
+	float w = std::min( hi.x, (float) MOC_WIDTH ) - std::max( lo.x, 0.0f );
+	float h = std::min( hi.y, (float) MOC_HEIGHT ) - std::max( lo.y, 0.0f );
+	if( w <= 0.0f || h <= 0.0f || w * h < MOC_MIN_OCCLUDER ) {
+		return;
+	}
+
+	for( int f = 0; f < 6; ++f ) {
+		const int *q = boxFaces[f];
+		addTriangle( p[q[0]], p[q[1]], p[q[2]] );
+		addTriangle( p[q[0]], p[q[2]], p[q[3]] );
+	}
+	occluders += 1;
+}
+
+///
+/// rasterize() - draw this frame's occluders into the buffer
+///
+void MaskedOcclusion::rasterize( void ) {
+	int n = (int) tz.size();
+
+	// sort the triangles into the bands they touch
+	for( int b = 0; b < MOC_BANDS; ++b ) {
+		bins[b].clear();
+	}
+	for( int t = 0; t < n; ++t ) {
+		float ylo = std::min( vy[0][t], std::min( vy[1][t], vy[2][t] ) );
+		float yhi = std::max( vy[0][t], std::max( vy[1][t], vy[2][t] ) );
+		int r0 = std::max( 0, (int) ylo / MOC_TILE_H );
+		int r1 = std::min( MOC_TILES_Y - 1, (int) yhi / MOC_TILE_H );
+		for( int b = r0 / MOC_BAND_ROWS; b <= r1 / MOC_BAND_ROWS; ++b ) {
+			bins[b].push_back( t );
+		}
+	}
+
+	// each band has its own tiles, so the bands can be drawn at once
+	ThreadPool::shared().run( MOC_BANDS, [&]( int b, int ) {
+		int first = b * MOC_BAND_ROWS;
+		int last = first + MOC_BAND_ROWS - 1;
+		for( size_t k = 0; k < bins[b].size(); ++k ) {
+			drawTriangle( bins[b][k], first, last );
+		}
+	} );
+}
+
+///
+/// hidden(set,i) - determine whether an object is certainly hidden
+///     by the occluders
+///
+/// @param set   this frame's CullSet
+/// @param i     the object's position in it
+///
+/// @return true if it is hidden
+///
+bool MaskedOcclusion::hidden( const CullSet &set, size_t i ) {
+	glm::vec3 p[8];
+
+	tested += 1;
+
+	if( !projectBox( projView, glm::vec3( set.cx[i], set.cy[i], set.cz[i] ),
+			glm::vec3( set.ex[i], set.ey[i], set.ez[i] ), p ) ) {
+		return( false );
+	}
+
+	glm::vec2 lo( p[0].x, p[0].y ), hi( lo );
+	float zmin = p[0].z;
+	for( int k = 1; k < 8; ++k ) {
+		lo.x = std::min( lo.x, p[k].x );
+		lo.y = std::min( lo.y, p[k].y );
+		hi.x = std::max( hi.x, p[k].x );
+		hi.y = std::max( hi.y, p[k].y );
+		zmin = std::min( zmin, p[k].z );
+	}
+
+	// off the screen is for the frustum test to decide
+	if( hi.x < 0.0f || lo.x >= MOC_WIDTH || hi.y < 0.0f ||
+		lo.y >= MOC_HEIGHT ) {
+		return( false );
+	}
+
+	// every pixel the box touches
+	int x0 = std::max( 0, (int) floorf( lo.x ) );
+	int x1 = std::min( MOC_WIDTH - 1, (int) floorf( hi.x ) );
+	int y0 = std::max( 0, (int) floorf( lo.y ) );
+	int y1 = std::min( MOC_HEIGHT - 1, (int) floorf( hi.y ) );
+
+	for( int ty = y0 / MOC_TILE_H; ty <= y1 / MOC_TILE_H; ++ty ) {
+		for( int tx = x0 / MOC_TILE_W; tx <= x1 / MOC_TILE_W; ++tx ) {
+			int tile = ty * MOC_TILES_X + tx;
+
+			// behind everything in the tile
+			if( zmin > zMax0[tile] ) {
+				continue;
+			}
+
+			// or behind the working layer, where that covers the box
+			if( zmin <= zMax1[tile] ) {
+				return( false );
+			}
+			int c0 = std::max( x0, tx * MOC_TILE_W ) - tx * MOC_TILE_W;
+			int c1 = std::min( x1, tx * MOC_TILE_W + MOC_TILE_W - 1 ) -
+				tx * MOC_TILE_W;
+			uint32_t want = rowBits( c0, c1 );
+			const uint32_t *m = &masks[tile * MOC_TILE_H];
+			for( int r = 0; r < MOC_TILE_H; ++r ) {
+				int y = ty * MOC_TILE_H + r;
+				if( y >= y0 && y <= y1 && (m[r] & want) != want ) {
+					return( false );
+				}
+			}
+		}
+	}
+
+	culled += 1;
+	return( true );
+}
@@ -0,0 +1,165 @@
+//
+//  MaskedOcclusion.h
+//
+//  Software occlusion culling:  a small depth buffer rasterized on the
+//  CPU from simple occluders, used to reject hidden objects before any
+//  OpenGL work is done for them.
+//
+//  The buffer is MOC_WIDTH x MOC_HEIGHT pixels in tiles of 32 x 4.
+//  Rather than a depth per pixel, each tile keeps (as in "masked"
+//  occlusion culling) two layers:
+//
+//    - a reference layer:  the farthest depth anywhere in the tile
+//      (zMax0), and
+//    - a working layer:  a coverage mask (one bit per pixel) and the
+//      farthest depth of the triangles covering those pixels (zMax1).
+//
+//  When the working layer covers the whole tile, it becomes the
+//  reference layer.  If a triangle is much farther than the working
+//  layer, the working layer is discarded instead of letting it become
+//  a poor bound.  Either way, both depths stay upper bounds on what
+//  is really there, so the culling never hides a visible object.
+//
+//  Occluders are boxes that lie entirely inside an object (see
+//  getOccluder() in Models.h); only their front faces are drawn, and
+//  only if they are large enough on the screen to be worth it.  Pixel
+//  coverage is found four pixels at a time with SSE edge functions,
+//  and the tile rows are split into bands that are rasterized in
+//  parallel on the shared ThreadPool.
+//
+//  Objects are tested by their world-space bounding boxes from the
+//  frame's CullSet.
+//
+
+#ifndef MASKEDOCCLUSION_H_
+#define MASKEDOCCLUSION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Culling.h"
+
+using namespace std;
+
+//
+// Buffer and tile sizes (pixels)
+//
+#define MOC_WIDTH       256
+#define MOC_HEIGHT      256
+#define MOC_TILE_W      32
+#define MOC_TILE_H      4
+
+#define MOC_TILES_X     (MOC_WIDTH / MOC_TILE_W)
+#define MOC_TILES_Y     (MOC_HEIGHT / MOC_TILE_H)
+
+//
+// Bands of tile rows rasterized in parallel
+//
+#define MOC_BANDS       8
+
+//
+// Occluders smaller than this on the screen (pixels) are skipped
+//
+#define MOC_MIN_OCCLUDER    64.0f
+
+class MaskedOcclusion {
+
+public:
+	// the tiles, a row at a time from the bottom of the screen:  the
+	// working layer's coverage (a mask for each row of pixels) and
+	// the farthest depths of the reference and working layers
+	vector<uint32_t> masks;
+	vector<float> zMax0, zMax1;
+
+	// this frame's occluder triangles, in screen space (pixels, with
+	// window depth), counter-clockwise, and the farthest depth of each
+	vector<float> vx[3], vy[3];
+	vector<float> tz;
+
+	// the triangles touching each band
+	vector< vector<int> > bins;
+
+	// the view the buffer is being drawn for
+	glm::mat4 projView;
+
+	// what happened this frame
+	long occluders;      // occluder boxes drawn
+	long triangles;      // triangles drawn
+	long tested;         // objects tested
+	long culled;         // objects found to be hidden
+
+public:
+
+	///
+	/// Constructor
+	///
+	MaskedOcclusion( void );
+
+	///
+	/// begin(projView) - clear the buffer for a new frame
+	///
+	/// @param pv   the projection matrix times the view matrix
+	///
+	void begin( const glm::mat4 &pv );
+
+	///
+	/// addOccluder(box,model) - add a box lying entirely inside an
+	///     object to this frame's occluders
+	///
+	/// @param box     the box (in model coordinates)
+	/// @param model   the object's model transformation
+	///
+	void addOccluder( const Bounds &box, const glm::mat4 &model );
+
+	///
+	/// rasterize() - draw this frame's occluders into the buffer
+	///
+	void rasterize( void );
+
+	///
+	/// hidden(set,i) - determine whether an object is certainly hidden
+	///     by the occluders
+	///
+	/// @param set   this frame's CullSet
+	/// @param i     the object's position in it
+	///
+	/// @return true if it is hidden
+	///
+	bool hidden( const CullSet &set, size_t i );
+
+private:
+
+	///
+	/// addTriangle(a,b,c) - add an occluder triangle, unless it faces
+	///     away or is off the screen
+	///
+	/// @param a,b,c   its corners (pixels, pixels, window depth)
+	///
+	void addTriangle( const glm::vec3 &a, const glm::vec3 &b,
+		const glm::vec3 &c );
+
+	///
+	/// drawTriangle(t,rowFirst,rowLast) - draw the part of a triangle
+	///     in tile rows rowFirst through rowLast
+	///
+	/// @param t          which triangle
+	/// @param rowFirst   first tile row
+	/// @param rowLast    last tile row
+	///
+	void drawTriangle( int t, int rowFirst, int rowLast );
+
+	///
+	/// updateTile(tile,cover,z) - merge a triangle into a tile
+	///
+	/// @param tile    which tile
+	/// @param cover   the pixels it covers (a mask per row)
+	/// @param z       its farthest depth
+	///
+	void updateTile( int tile, const uint32_t cover[MOC_TILE_H], float z );
+
+};
+
+#endif
@@ -58,6 +58,36 @@ static GLuint redWoodTexture = 0;
 static GLuint roadTexture = 0;
 static GLuint roofTexture = 0;
 
+// texture used for each object (order must match the Object type
+// in Models.h)
+static GLuint *objTexture[N_OBJECTS] = {
+	&dirtyTileTexture,  // SiloBody
+	&metalRoofTexture,  // SiloRoof
+	&brickTexture,      // MainBarnBody
+	&roofTexture,       // MainBarnRoof
+	&redWoodTexture,    // AltBarnBody
+	&roofTexture,       // AltBarnRoof
+	&redWoodTexture,    // MiniBarnBody
+	&roofTexture,       // MiniBarnRoof
+	&roadTexture        // Floor
+};
+
+// which specExp[] entry each object uses (same order)
+static int objSpecExp[N_OBJECTS] = {
+	1,  // SiloBody
+	2,  // SiloRoof
+	1,  // MainBarnBody
+	1,  // MainBarnRoof
+	0,  // AltBarnBody
+	0,  // AltBarnRoof
+	0,  // MiniBarnBody
+	0,  // MiniBarnRoof
+	0   // Floor
+};
+
+// material ID for each object; objects with the same texture and
+// specular exponent share an ID (filled in by initTextures())
+static int objMaterial[N_OBJECTS];
 
 ///
 /// Load an image into the current texture unit
@@ -162,7 +192,40 @@ void initTextures( void )
         roadTexture = load_texture( "roadTexture.png" );
         roofTexture = load_texture( "roofTexture.png" );
 
+	// each object's material ID is the first object that looks like it
+	for( int i = 0; i < N_OBJECTS; ++i ) {
+		objMaterial[i] = i;
+		for( int j = 0; j < i; ++j ) {
+			if( *objTexture[j] == *objTexture[i] &&
+				specExp[objSpecExp[j]] == specExp[objSpecExp[i]] ) {
+				objMaterial[i] = objMaterial[j];
+				break;
+			}
+		}
+	}
+}
+
+///
+/// This function returns the texture used by an object.
+///
+/// @param obj   The object type
+/// @return the texture ID
+///
+GLuint getTexture( Object obj )
+{
+	return( *objTexture[obj] );
+}
 
+///
+/// This function returns the material ID of an object.  Objects with
+/// the same material ID have identical appearance parameters.
+///
+/// @param obj   The object type
+/// @return the material ID
+///
+int getMaterialID( Object obj )
+{
+	return( objMaterial[obj] );
 }
 
 ///
@@ -182,7 +245,7 @@ void setMaterials( GLuint program, Object obj, bool usingTextures )
 	///////////////////////////////////////////////////
 
 	// Send down the reflective coefficients
-	GLint loc = getUniformLoc( program, "kCoeff" );
+	GLint loc = getUniformLoc( program, U_K_COEFF );
 	if( loc >= 0 ) {
 		glUniform3fv( loc, 1, glm::value_ptr(k) );
 	}
@@ -236,36 +299,9 @@ void setMaterials( GLuint program, Object obj, bool usingTextures )
 	///////////////////////////////////////////////////////////
 
 	// Set the specular exponent for the object
-	loc  = getUniformLoc( program, "specExp" );
-	switch( obj ) {
-    //TODO
-    case SiloBody:
-        glUniform1f( loc, specExp[1] );
-		break;
-    case SiloRoof:
-        glUniform1f( loc, specExp[2] );
-		break;
-    case MainBarnBody:
-        glUniform1f( loc, specExp[1] );
-		break;
-    case MainBarnRoof:
-        glUniform1f( loc, specExp[1] );
-		break;
-    case AltBarnBody:
-        glUniform1f( loc, specExp[0] );
-		break;
-    case AltBarnRoof: 
-        glUniform1f( loc, specExp[0] );
-		break;
-    case MiniBarnBody: 
-        glUniform1f( loc, specExp[0] );
-		break;
-    case MiniBarnRoof: 
-        glUniform1f( loc, specExp[0] );
-		break;
-    case Floor:
-        glUniform1f( loc, specExp[0] );
-		break;
+	loc  = getUniformLoc( program, U_SPEC_EXP );
+	if( loc >= 0 ) {
+		glUniform1f( loc, specExp[objSpecExp[obj]] );
 	}
 
 	//
@@ -274,157 +310,21 @@ void setMaterials( GLuint program, Object obj, bool usingTextures )
 	// data you've put into your texture units.
 	//
 
-        ///////////////////////////////////////////////////////////
-        // Bind textures for each object (Quad, Cylinder, Discs)
-        ///////////////////////////////////////////////////////////
-        GLint texLoc;
-
-        switch( obj ) {
-            case SiloBody:
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, dirtyTileTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, dirtyTileTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case SiloRoof:
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, metalRoofTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, metalRoofTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case MainBarnBody:
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, brickTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, brickTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case MainBarnRoof:
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, roofTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, roofTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case AltBarnBody:
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, redWoodTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, redWoodTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case AltBarnRoof: 
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, roofTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, roofTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case MiniBarnBody: 
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, redWoodTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, redWoodTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case MiniBarnRoof: 
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, roofTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, roofTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-            case Floor:
-                glActiveTexture(GL_TEXTURE0);  // Texture unit 0
-                glBindTexture(GL_TEXTURE_2D, roadTexture);  // Front texture
-                texLoc = getUniformLoc(program, "mainTex");
-                if (texLoc >= 0) {
-                        glUniform1i(texLoc, 0);  // Set the sampler to texture unit 0
-                }
-
-                //Send same texture for back
-                glActiveTexture(GL_TEXTURE1);  // Texture unit 1
-                glBindTexture(GL_TEXTURE_2D, roadTexture);  // Back texture
-                texLoc = getUniformLoc(program, "backTex");
-                if (texLoc >= 0) {
-                glUniform1i(texLoc, 1);  // Set the sampler to texture unit 1
-                }
-                break;
-        }
+	// The same texture is used for the front (unit 0) and the
+	// back (unit 1) of each object
+	GLuint tex = *objTexture[obj];
 
+	glActiveTexture( GL_TEXTURE0 );
+	glBindTexture( GL_TEXTURE_2D, tex );
+	loc = getUniformLoc( program, U_MAIN_TEX );
+	if( loc >= 0 ) {
+		glUniform1i( loc, 0 );
+	}
 
+	glActiveTexture( GL_TEXTURE1 );
+	glBindTexture( GL_TEXTURE_2D, tex );
+	loc = getUniformLoc( program, U_BACK_TEX );
+	if( loc >= 0 ) {
+		glUniform1i( loc, 1 );
+	}
 }
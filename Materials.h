@@ -34,6 +34,23 @@
 ///
 void initTextures( void );
 
+///
+/// This function returns the texture used by an object.
+///
+/// @param obj   The object type
+/// @return the texture ID
+///
+GLuint getTexture( Object obj );
+
+///
+/// This function returns the material ID of an object.  Objects with
+/// the same material ID have identical appearance parameters.
+///
+/// @param obj   The object type
+/// @return the material ID
+///
+int getMaterialID( Object obj );
+
 ///
 /// This function sets up the appearance parameters for the object.
 ///
@@ -0,0 +1,435 @@
+//
+//  MeshOpt.cpp
+//
+//  Triangle and vertex reordering for indexed meshes.
+//
+//  Vertex cache ordering follows Tom Forsyth's "Linear-Speed Vertex
+//  Cache Optimisation":  each vertex is scored by its position in a
+//  simulated LRU cache and by how many unemitted triangles still use
+//  it, and the next triangle emitted is the highest-scoring one that
+//  uses a vertex in the cache.
+//
+//  Overdraw ordering follows the second half of Tipsify:  the cache
+//  ordered triangles are cut into clusters wherever the cache would
+//  have to be refilled from scratch (so the cut costs almost nothing),
+//  and the clusters are sorted so that those facing away from the
+//  middle of the mesh, which are most likely to be in front, go first.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "MeshOpt.h"
+
+using namespace std;
+
+//
+// PRIVATE GLOBALS
+//
+
+// size of the LRU cache modeled while ordering for the vertex cache
+#define FORSYTH_CACHE   32
+
+// vertex scoring parameters (Forsyth's suggested values)
+static const float cacheDecayPower = 1.5f;
+static const float lastTriScore = 0.75f;
+static const float valenceBoostScale = 2.0f;
+static const float valenceBoostPower = 0.5f;
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// Score a vertex for the vertex cache ordering
+///
+/// @param cachePos    position in the LRU cache (-1 if not there)
+/// @param remaining   number of unemitted triangles using it
+///
+/// @return the vertex score
+///
+static float vertexScore( int cachePos, int remaining )
+{
+	// no more triangles need this one
+	if( remaining == 0 ) {
+		return( -1.0f );
+	}
+
+	float score = 0.0f;
+
+	if( cachePos >= 0 ) {
+		if( cachePos < 3 ) {
+			// used by the last triangle; it gets a fixed score so
+			// that we don't favor strips over fans
+			score = lastTriScore;
+		} else {
+			float s = 1.0f - (cachePos - 3) / (float) (FORSYTH_CACHE - 3);
+			score = powf( s, cacheDecayPower );
+		}
+	}
+
+	// favor vertices with few triangles left, to finish them off
+	score += valenceBoostScale * powf( (float) remaining, -valenceBoostPower );
+
+	return( score );
+}
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Compute the average cache miss ratio of an index list
+///
+/// @param idx      the index list (three per triangle)
+/// @param nidx     number of indices
+/// @param nverts   number of vertices the indices refer to
+/// @param cache    FIFO cache size to simulate
+///
+/// @return transformed vertices per triangle
+///
+float meshACMR( const GLuint *idx, int nidx, int nverts, int cache )
+{
+	if( nidx < 3 ) {
+		return( 0.0f );
+	}
+
+	// a vertex is in the FIFO if fewer than 'cache' misses have
+	// happened since it was loaded
+	vector<int> loaded( nverts, 0 );
+	int stamp = cache + 1;
+	int misses = 0;
+
+	for( int i = 0; i < nidx; ++i ) {
+		GLuint v = idx[i];
+		if( stamp - loaded[v] > cache ) {
+			loaded[v] = stamp++;
+			misses += 1;
+		}
+	}
+
+	return( (float) misses / (nidx / 3) );
+}
+
+///
+/// Reorder the triangles of an index list for post-transform
+/// cache locality (Forsyth's linear-speed algorithm)
+///
+/// @param idx      the index list; reordered in place
+/// @param nidx     number of indices
+/// @param nverts   number of vertices the indices refer to
+///
+void optimizeVertexCache( GLuint *idx, int nidx, int nverts )
+{
+	int ntris = nidx / 3;
+
+	if( ntris < 2 ) {
+		return;
+	}
+
+	// the triangles using each vertex; the first 'remaining[v]'
+	// entries for vertex v are the ones not yet emitted
+	vector<int> remaining( nverts, 0 );
+	for( int i = 0; i < ntris * 3; ++i ) {
+		remaining[ idx[i] ] += 1;
+	}
+
+	vector<int> adjStart( nverts + 1, 0 );
+	for( int v = 0; v < nverts; ++v ) {
+		adjStart[v+1] = adjStart[v] + remaining[v];
+	}
+
+	vector<int> adj( ntris * 3 );
+	vector<int> fill( adjStart.begin(), adjStart.end() - 1 );
+	for( int i = 0; i < ntris * 3; ++i ) {
+		adj[ fill[ idx[i] ]++ ] = i / 3;
+	}
+
+	// initial scores
+	vector<int> cachePos( nverts, -1 );
+	vector<float> vScore( nverts );
+	for( int v = 0; v < nverts; ++v ) {
+		vScore[v] = vertexScore( -1, remaining[v] );
+	}
+
+	vector<float> tScore( ntris );
+	vector<bool> emitted( ntris, false );
+	int best = 0;
+	for( int t = 0; t < ntris; ++t ) {
+		tScore[t] = vScore[idx[t*3]] + vScore[idx[t*3+1]] +
+					vScore[idx[t*3+2]];
+		if( tScore[t] > tScore[best] ) {
+			best = t;
+		}
+	}
+
+	vector<GLuint> out;
+	out.reserve( ntris * 3 );
+
+	int cache[FORSYTH_CACHE + 3];
+	int cacheSize = 0;
+	int scan = 0;
+
+	for( int n = 0; n < ntris; ++n ) {
+
+		// nothing in the cache is any use; start somewhere new
+		if( best < 0 ) {
+			while( emitted[scan] ) {
+				++scan;
+			}
+			best = scan;
+		}
+
+		// emit the chosen triangle
+		const GLuint *tri = &idx[best * 3];
+		emitted[best] = true;
+		for( int k = 0; k < 3; ++k ) {
+			GLuint v = tri[k];
+			out.push_back( v );
+
+			// take it out of the vertex's list of live triangles
+			int *list = &adj[ adjStart[v] ];
+			for( int j = 0; j < remaining[v]; ++j ) {
+				if( list[j] == best ) {
+					list[j] = list[ remaining[v] - 1 ];
+					list[ remaining[v] - 1 ] = best;
+					remaining[v] -= 1;
+					break;
+				}
+			}
+		}
+
+		// its vertices move to the front of the cache
+		int newCache[FORSYTH_CACHE + 3];
+		int newSize = 0;
+		for( int k = 0; k < 3; ++k ) {
+			int v = tri[k];
+			if( find( newCache, newCache + newSize, v ) == newCache + newSize ) {
+				newCache[newSize++] = v;
+			}
+		}
+		for( int i = 0; i < cacheSize; ++i ) {
+			int v = cache[i];
+			if( find( newCache, newCache + newSize, v ) == newCache + newSize ) {
+				newCache[newSize++] = v;
+			}
+		}
+
+		// rescore everything that was in the cache (including the
+		// ones that just fell out of it)
+		for( int i = 0; i < newSize; ++i ) {
+			int v = newCache[i];
+			cachePos[v] = i < FORSYTH_CACHE ? i : -1;
+			vScore[v] = vertexScore( cachePos[v], remaining[v] );
+		}
+
+		// rescore their triangles, and choose the best one
+		best = -1;
+		float bestScore = -1.0f;
+		for( int i = 0; i < newSize; ++i ) {
+			int v = newCache[i];
+			const int *list = &adj[ adjStart[v] ];
+			for( int j = 0; j < remaining[v]; ++j ) {
+				int t = list[j];
+				tScore[t] = vScore[idx[t*3]] + vScore[idx[t*3+1]] +
+							vScore[idx[t*3+2]];
+				if( tScore[t] > bestScore ) {
+					bestScore = tScore[t];
+					best = t;
+				}
+			}
+		}
+
+		cacheSize = min( newSize, FORSYTH_CACHE );
+		copy( newCache, newCache + cacheSize, cache );
+	}
+
+	copy( out.begin(), out.end(), idx );
+}
+
+///
+/// Reorder clusters of triangles to reduce overdraw, keeping the
+/// result only if its ACMR stays within a factor of the original
+///
+/// @param idx      the (cache-optimized) index list; reordered in place
+/// @param nidx     number of indices
+/// @param pos      vertex locations (XYZW)
+/// @param nverts   number of vertices
+/// @param limit    greatest acceptable ACMR ratio
+///
+/// @return true if the new order was kept
+///
+bool optimizeOverdraw( GLuint *idx, int nidx, const float *pos,
+	int nverts, float limit )
+{
+	int ntris = nidx / 3;
+
+	if( ntris < 2 ) {
+		return( false );
+	}
+
+	// cut the triangles into clusters wherever all three of a
+	// triangle's vertices miss the (simulated) cache
+	vector<int> clusters;
+	vector<int> loaded( nverts, 0 );
+	int stamp = MESHOPT_FIFO + 1;
+	for( int t = 0; t < ntris; ++t ) {
+		int misses = 0;
+		for( int k = 0; k < 3; ++k ) {
+			GLuint v = idx[t*3+k];
+			if( stamp - loaded[v] > MESHOPT_FIFO ) {
+				loaded[v] = stamp++;
+				misses += 1;
+			}
+		}
+		if( t == 0 || misses == 3 ) {
+			clusters.push_back( t );
+		}
+	}
+	clusters.push_back( ntris );
+
+	int nclusters = clusters.size() - 1;
+	if( nclusters < 2 ) {
+		return( false );
+	}
+
+	// area-weighted centroid and normal of each cluster, and
+	// the centroid of the whole mesh
+	vector<float> cc( nclusters * 3, 0.0f ), cn( nclusters * 3, 0.0f );
+	vector<float> carea( nclusters, 0.0f );
+	float mc[3] = { 0.0f, 0.0f, 0.0f };
+	float marea = 0.0f;
+
+	for( int c = 0; c < nclusters; ++c ) {
+		for( int t = clusters[c]; t < clusters[c+1]; ++t ) {
+			const float *p0 = &pos[ idx[t*3] * 4 ];
+			const float *p1 = &pos[ idx[t*3+1] * 4 ];
+			const float *p2 = &pos[ idx[t*3+2] * 4 ];
+
+			float u[3] = { p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2] };
+			float v[3] = { p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2] };
+			float n[3] = { u[1]*v[2] - u[2]*v[1],
+						   u[2]*v[0] - u[0]*v[2],
+						   u[0]*v[1] - u[1]*v[0] };
+			float area = 0.5f * sqrtf( n[0]*n[0] + n[1]*n[1] + n[2]*n[2] );
+
+			for( int k = 0; k < 3; ++k ) {
+				float centroid = (p0[k] + p1[k] + p2[k]) / 3.0f;
+				cc[c*3+k] += centroid * area;
+				cn[c*3+k] += n[k];
+				mc[k] += centroid * area;
+			}
+			carea[c] += area;
+			marea += area;
+		}
+	}
+
+	if( marea <= 0.0f ) {
+		return( false );
+	}
+	for( int k = 0; k < 3; ++k ) {
+		mc[k] /= marea;
+	}
+
+	// sort key:  how far the cluster lies out along its own normal
+	vector<float> key( nclusters, 0.0f );
+	for( int c = 0; c < nclusters; ++c ) {
+		if( carea[c] <= 0.0f ) {
+			continue;
+		}
+		float len = sqrtf( cn[c*3]*cn[c*3] + cn[c*3+1]*cn[c*3+1] +
+						   cn[c*3+2]*cn[c*3+2] );
+		if( len <= 0.0f ) {
+			continue;
+		}
+		for( int k = 0; k < 3; ++k ) {
+			key[c] += (cc[c*3+k] / carea[c] - mc[k]) * cn[c*3+k] / len;
+		}
+	}
+
+	vector<int> order( nclusters );
+	for( int c = 0; c < nclusters; ++c ) {
+		order[c] = c;
+	}
+	stable_sort( order.begin(), order.end(),
+		[&]( int a, int b ) { return( key[a] > key[b] ); } );
+
+	vector<GLuint> out;
+	out.reserve( ntris * 3 );
+	for( int c : order ) {
+		out.insert( out.end(), idx + clusters[c] * 3,
+			idx + clusters[c+1] * 3 );
+	}
+
+	// only keep it if the cache doesn't suffer much
+	float oldACMR = meshACMR( idx, ntris * 3, nverts, MESHOPT_FIFO );
+	float newACMR = meshACMR( out.data(), ntris * 3, nverts, MESHOPT_FIFO );
+	if( newACMR > oldACMR * limit ) {
+		return( false );
+	}
+
+	copy( out.begin(), out.end(), idx );
+	return( true );
+}
+
+///
+/// Optimize the mesh held in a Canvas:  triangle order for the
+/// vertex cache and for overdraw, then vertex order for fetching
+///
+/// The Canvas must be indexed (i.e., its vertices welded).
+///
+/// @param C        the Canvas holding the mesh
+/// @param before   receives the ACMR of the original order
+/// @param after    receives the ACMR of the optimized order
+///
+/// @return true if the mesh was optimized
+///
+bool optimizeMesh( Canvas &C, float &before, float &after )
+{
+	int nidx = C.numIndices();
+	int nverts = C.numVertices();
+
+	before = after = 0.0f;
+	if( !C.isIndexed() || nidx < 3 ) {
+		return( false );
+	}
+
+	vector<GLuint> idx( nidx );
+	C.writeElements( idx.data() );
+	vector<float> pos( nverts * 4 );
+	C.writeVertices( pos.data() );
+
+	before = meshACMR( idx.data(), nidx, nverts, MESHOPT_FIFO );
+
+	vector<GLuint> original( idx );
+	optimizeVertexCache( idx.data(), nidx, nverts );
+	optimizeOverdraw( idx.data(), nidx, pos.data(), nverts,
+		MESHOPT_OVERDRAW_LIMIT );
+
+	after = meshACMR( idx.data(), nidx, nverts, MESHOPT_FIFO );
+
+	// the generator's own order was better (e.g., a tiny mesh)
+	if( after > before ) {
+		idx.swap( original );
+		after = before;
+	}
+
+	if( !C.setElements( idx ) ) {
+		return( false );
+	}
+
+	// renumber the vertices in the order they're first used; any
+	// that no triangle uses are dropped
+	vector<GLuint> remap( nverts, ~0u );
+	int count = 0;
+	for( int i = 0; i < nidx; ++i ) {
+		if( remap[ idx[i] ] == ~0u ) {
+			remap[ idx[i] ] = count++;
+		}
+	}
+	C.remapVertices( remap, count );
+
+	return( true );
+}
@@ -0,0 +1,96 @@
+//
+//  MeshOpt.h
+//
+//  Triangle and vertex reordering for indexed meshes.
+//
+//  The shape generators emit triangles in whatever order they walk
+//  the surface.  Between building a (welded) mesh in a Canvas and
+//  creating its buffers, this module reorders:
+//
+//    - the triangles, so that vertices are reused while they are
+//      still in the GPU's post-transform cache (Forsyth's algorithm);
+//    - groups of those triangles, so that outward-facing parts of the
+//      mesh tend to be drawn first and hide what's behind them
+//      (the cluster sort from Sander, Nehab, and Barczak's Tipsify);
+//    - the vertices, into the order the triangles first use them,
+//      so that vertex fetching walks through memory sequentially.
+//
+//  The ACMR (average cache miss ratio:  transformed vertices per
+//  triangle, between 0.5 and 3.0) is measured before and after.
+//
+
+#ifndef MESHOPT_H_
+#define MESHOPT_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "Canvas.h"
+
+//
+// Size of the FIFO post-transform cache used to measure ACMR
+//
+#define MESHOPT_FIFO    16
+
+//
+// How much worse than the cache-optimized order (as a ratio of
+// ACMRs) the overdraw ordering is allowed to be
+//
+#define MESHOPT_OVERDRAW_LIMIT  1.05f
+
+///
+/// Compute the average cache miss ratio of an index list
+///
+/// @param idx      the index list (three per triangle)
+/// @param nidx     number of indices
+/// @param nverts   number of vertices the indices refer to
+/// @param cache    FIFO cache size to simulate
+///
+/// @return transformed vertices per triangle
+///
+float meshACMR( const GLuint *idx, int nidx, int nverts, int cache );
+
+///
+/// Reorder the triangles of an index list for post-transform
+/// cache locality (Forsyth's linear-speed algorithm)
+///
+/// @param idx      the index list; reordered in place
+/// @param nidx     number of indices
+/// @param nverts   number of vertices the indices refer to
+///
+void optimizeVertexCache( GLuint *idx, int nidx, int nverts );
+
+///
+/// Reorder clusters of triangles to reduce overdraw, keeping the
+/// result only if its ACMR stays within a factor of the original
+///
+/// @param idx      the (cache-optimized) index list; reordered in place
+/// @param nidx     number of indices
+/// @param pos      vertex locations (XYZW)
+/// @param nverts   number of vertices
+/// @param limit    greatest acceptable ACMR ratio
+///
+/// @return true if the new order was kept
+///
+bool optimizeOverdraw( GLuint *idx, int nidx, const float *pos,
+	int nverts, float limit );
+
+///
+/// Optimize the mesh held in a Canvas:  triangle order for the
+/// vertex cache and for overdraw, then vertex order for fetching
+///
+/// The Canvas must be indexed (i.e., its vertices welded).
+///
+/// @param C        the Canvas holding the mesh
+/// @param before   receives the ACMR of the original order
+/// @param after    receives the ACMR of the optimized order
+///
+/// @return true if the mesh was optimized
+///
+bool optimizeMesh( Canvas &C, float &before, float &after );
+
+#endif
@@ -0,0 +1,260 @@
+//
+//  MeshTables.h
+//
+//  The cylinder and quad, generated at compile time.
+//
+//  These replace the hand-written tables that were in CylinderData.h
+//  and QuadData.h.  The tables are built by constexpr constructors
+//  from the tessellation given as template parameters, so they cost
+//  nothing at run time; the instances at the bottom of this file are
+//  C++17 inline variables, so there is exactly one (read-only) copy of
+//  each no matter how many files include this one.
+//
+//  The layouts match the old tables:
+//
+//    - the cylinder (diameter 1, height 1, centered at the origin) is
+//      the bottom disc, then the body, then the top disc, each as a
+//      list of separate triangles; its element list is just 0, 1, 2, ...
+//    - the quad (1 x 1, in the XY plane, facing +Z) has each vertex
+//      once, in rows from top to bottom, and an element list that
+//      refers to them.
+//
+//  The old cylinder was generated by adding up an angle step based on
+//  pi = 3.14, so its slices didn't quite close up (and drifted a little
+//  further around at each step up the body).  CylinderTable<10,10,false>
+//  reproduces it (to the six places the table was printed with); the
+//  default, CylinderTable<10,10>, closes up properly.
+//
+//  NOTE: OpenGL (etc.) headers must be included before this file, as
+//  this file does not include any GL-related header files.
+//
+
+#ifndef MESHTABLES_H_
+#define MESHTABLES_H_
+
+#include "Types.h"
+
+//
+// Default tessellations
+//
+#define CYLINDER_TESS   10
+#define QUAD_TESS       4
+
+//
+// Compile-time arithmetic (the <cmath> functions aren't constexpr)
+//
+
+#define CT_PI   3.14159265358979323846
+
+///
+/// Sine, for use in constant expressions
+///
+/// @param x   the angle (radians)
+///
+/// @return sin(x), to double precision
+///
+constexpr double ctSin( double x )
+{
+	// bring the angle into [-pi,pi]
+	long long turns = (long long) (x / (2.0 * CT_PI) + (x < 0.0 ? -0.5 : 0.5));
+	x -= turns * 2.0 * CT_PI;
+
+	// Taylor series; at most pi^31/31! < 1e-18 is left over
+	double term = x, sum = x;
+	for( int i = 1; i < 16; ++i ) {
+		term *= -x * x / ((2.0 * i) * (2.0 * i + 1.0));
+		sum += term;
+	}
+
+	return( sum );
+}
+
+///
+/// Cosine, for use in constant expressions
+///
+/// @param x   the angle (radians)
+///
+/// @return cos(x), to double precision
+///
+constexpr double ctCos( double x )
+{
+	return( ctSin( x + CT_PI / 2.0 ) );
+}
+
+///
+/// If we want to draw the parts independently, we need to know which
+/// vertices belong to the discs and the body of the cylinder.
+///
+typedef struct cylparts_s {
+	int nverts;   // number of vertices in this part
+	int first;    // starting vertex/element index
+	int last;     // ending vertex/element index
+} CylParts;
+
+///
+/// A cylinder with 'Slices' divisions around and 'Stacks' along the
+/// body; with 'Exact' false, angles use pi = 3.14 (as the old table did)
+///
+template <int Slices, int Stacks, bool Exact = true>
+struct CylinderTable {
+
+	static constexpr int discVerts = 3 * Slices;
+	static constexpr int bodyVerts = 6 * Slices * Stacks;
+	static constexpr int nverts = 2 * discVerts + bodyVerts;
+	static constexpr int nelems = nverts;
+
+	Vertex verts[ nverts ];
+	GLuint elements[ nelems ];
+
+	CylParts bdisc;   // the bottom disc
+	CylParts body;    // the body of the cylinder
+	CylParts tdisc;   // the top disc
+
+	///
+	/// The point at step 'i' around the rim (steps continue past a
+	/// full turn, as they did in the original generator)
+	///
+	static constexpr Vertex rim( int i, float y )
+	{
+		double angle = i * 2.0 * CT_PI / Slices;
+
+		// the original added up a single-precision step
+		if( !Exact ) {
+			float sum = 0.0f;
+			for( int j = 0; j < i; ++j ) {
+				sum += (float) (2.0 * 3.14 / Slices);
+			}
+			angle = sum;
+		}
+
+		Vertex v = { (float) (0.5 * ctSin( angle )), y,
+			(float) (0.5 * ctCos( angle )), 1.0f };
+
+		return( v );
+	}
+
+	constexpr CylinderTable( void ) : verts(), elements(),
+		bdisc{ discVerts, 0, discVerts - 1 },
+		body{ bodyVerts, discVerts, discVerts + bodyVerts - 1 },
+		tdisc{ discVerts, discVerts + bodyVerts, nverts - 1 }
+	{
+		int n = 0;
+		Vertex bottom = { 0.0f, -0.5f, 0.0f, 1.0f };
+		Vertex top = { 0.0f, 0.5f, 0.0f, 1.0f };
+
+		// the bottom disc:  rim, center, next rim point
+		for( int k = 0; k < Slices; ++k ) {
+			verts[n++] = rim( k, -0.5f );
+			verts[n++] = bottom;
+			verts[n++] = rim( k + 1, -0.5f );
+		}
+
+		// the body, one stack at a time from the bottom
+		for( int s = 0; s < Stacks; ++s ) {
+			float y0 = (float) (-0.5 + (double) s / Stacks);
+			float y1 = (float) (-0.5 + (double) (s + 1) / Stacks);
+			for( int k = 0; k < Slices; ++k ) {
+				int i = s * Slices + k;
+				verts[n++] = rim( i, y0 );
+				verts[n++] = rim( i + 1, y0 );
+				verts[n++] = rim( i, y1 );
+				verts[n++] = rim( i + 1, y0 );
+				verts[n++] = rim( i + 1, y1 );
+				verts[n++] = rim( i, y1 );
+			}
+		}
+
+		// the top disc, wound the other way
+		for( int k = 0; k < Slices; ++k ) {
+			verts[n++] = rim( k + 1, 0.5f );
+			verts[n++] = top;
+			verts[n++] = rim( k, 0.5f );
+		}
+
+		for( int i = 0; i < nelems; ++i ) {
+			elements[i] = i;
+		}
+	}
+};
+
+///
+/// A quad divided into N x N squares
+///
+template <int N>
+struct QuadTable {
+
+	static constexpr int nverts = (N + 1) * (N + 1);
+	static constexpr int nelems = 6 * N * N;
+
+	Vertex verts[ nverts ];
+	TexCoord uv[ nverts ];
+	GLuint elements[ nelems ];
+
+	// because the quad faces +Z, all the normals are (0,0,1)
+	Normal normal;
+
+	constexpr QuadTable( void ) : verts(), uv(), elements(),
+		normal{ 0.0f, 0.0f, 1.0f }
+	{
+		// each vertex once, a row at a time from the top
+		for( int r = 0; r <= N; ++r ) {
+			for( int c = 0; c <= N; ++c ) {
+				int i = r * (N + 1) + c;
+				verts[i].x = (float) ((double) c / N - 0.5);
+				verts[i].y = (float) (0.5 - (double) r / N);
+				verts[i].z = 0.0f;
+				verts[i].w = 1.0f;
+				uv[i].u = (float) ((double) c / N);
+				uv[i].v = (float) (1.0 - (double) r / N);
+			}
+		}
+
+		// two triangles for each square
+		int n = 0;
+		for( int r = 0; r < N; ++r ) {
+			for( int c = 0; c < N; ++c ) {
+				GLuint a = r * (N + 1) + c;
+				GLuint b = a + N + 1;
+				elements[n++] = a;
+				elements[n++] = b;
+				elements[n++] = a + 1;
+				elements[n++] = b;
+				elements[n++] = b + 1;
+				elements[n++] = a + 1;
+			}
+		}
+	}
+};
+
+//
+// The shapes themselves
+//
+inline constexpr CylinderTable<CYLINDER_TESS, CYLINDER_TESS> cylinder{};
+inline constexpr QuadTable<QUAD_TESS> quad{};
+
+//
+// Spot checks against entries of the old tables
+//
+constexpr bool ctNear( float a, float b )
+{
+	return( a - b < 1.0e-6f && b - a < 1.0e-6f );
+}
+
+namespace meshtables_check {
+	constexpr CylinderTable<10, 10, false> old{};
+	static_assert( old.nverts == 660 && old.body.first == 30 &&
+		old.tdisc.last == 659, "cylinder layout changed" );
+	static_assert( ctNear( old.verts[2].x, 0.293764f ) &&
+		ctNear( old.verts[2].z, 0.404602f ), "bottom disc differs" );
+	static_assert( ctNear( old.verts[627].x, -0.015959f ) &&
+		ctNear( old.verts[627].y, 0.4f ) &&
+		ctNear( old.verts[627].z, 0.499745f ), "body differs" );
+	static_assert( ctNear( old.verts[657].x, -0.001592f ) &&
+		ctNear( old.verts[657].z, 0.499997f ), "top disc differs" );
+	static_assert( quad.nverts == 25 && quad.nelems == 96 &&
+		quad.elements[3] == 5 && quad.elements[95] == 19 &&
+		ctNear( quad.verts[6].x, -0.25f ) &&
+		ctNear( quad.uv[6].v, 0.75f ), "quad differs" );
+}
+
+#endif
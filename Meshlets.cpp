@@ -0,0 +1,512 @@
+//
+//  Meshlets.cpp
+//
+//  Clusters of triangles, and culling them a frame at a time.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/matrix.hpp>
+
+#include "Culling.h"
+#include "Meshlets.h"
+#include "ThreadPool.h"
+
+// test four meshlets at a time with SSE where we have it
+#if defined(__SSE__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MESHLET_SSE
+#include <xmmintrin.h>
+#endif
+
+//
+// PRIVATE GLOBALS
+//
+
+// a meshlet whose normals spread farther than this from their average
+// (as the cosine of the angle) never faces entirely away
+#define MESHLET_MIN_SPREAD  0.1f
+
+// locations this close together (as a fraction of the mesh's size)
+// are the same one when deciding whether a mesh is closed
+#define MESHLET_WELD        1.0e-5f
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// Does every edge of a mesh belong to exactly two triangles?
+///
+/// Vertices within MESHLET_WELD (relative to the size of the mesh) of
+/// each other are treated as one, so seams where a location was given
+/// a second normal or texture coordinate, or was computed twice with
+/// different rounding, don't count as open edges.
+///
+/// @param idx      the mesh's index list (three per triangle)
+/// @param nidx     number of indices
+/// @param pos      vertex locations (XYZW)
+/// @param nverts   number of vertices
+///
+/// @return true if the mesh is closed
+///
+static bool isClosed( const GLuint *idx, int nidx, const float *pos,
+	int nverts )
+{
+	// snap the locations to a grid, and number the distinct cells
+	float extent = 0.0f;
+	for( int i = 0; i < nverts * 4; ++i ) {
+		if( (i & 3) != 3 ) {
+			extent = std::max( extent, fabsf( pos[i] ) );
+		}
+	}
+	float scale = extent > 0.0f ? 1.0f / (extent * MESHLET_WELD) : 1.0f;
+
+	vector<int64_t> cell( nverts * 3 );
+	for( int i = 0; i < nverts; ++i ) {
+		for( int k = 0; k < 3; ++k ) {
+			cell[3 * i + k] = (int64_t) llroundf( pos[4 * i + k] * scale );
+		}
+	}
+
+	vector<int> order( nverts ), where( nverts );
+	for( int i = 0; i < nverts; ++i ) {
+		order[i] = i;
+	}
+	auto less = [&cell]( int a, int b ) {
+		const int64_t *p = &cell[3 * a], *q = &cell[3 * b];
+		return( p[0] < q[0] || (p[0] == q[0] && (p[1] < q[1] ||
+			(p[1] == q[1] && p[2] < q[2]))) );
+	};
+	std::sort( order.begin(), order.end(), less );
+	for( int i = 0, id = -1; i < nverts; ++i ) {
+		if( i == 0 || less( order[i - 1], order[i] ) ) {
+			++id;
+		}
+		where[ order[i] ] = id;
+	}
+
+	// list every edge of every (non-degenerate) triangle
+	vector<uint64_t> edges;
+	edges.reserve( nidx );
+	for( int t = 0; t + 2 < nidx; t += 3 ) {
+		uint64_t v[3];
+		for( int k = 0; k < 3; ++k ) {
+			v[k] = (uint64_t) where[ idx[t + k] ];
+		}
+		if( v[0] == v[1] || v[1] == v[2] || v[2] == v[0] ) {
+			continue;
+		}
+		for( int k = 0; k < 3; ++k ) {
+			uint64_t a = v[k], b = v[(k + 1) % 3];
+			edges.push_back( a < b ? (a << 32) | b : (b << 32) | a );
+		}
+	}
+
+	// and make sure each one is there exactly twice
+	std::sort( edges.begin(), edges.end() );
+	for( size_t i = 0; i < edges.size(); ) {
+		size_t j = i + 1;
+		while( j < edges.size() && edges[j] == edges[i] ) {
+			++j;
+		}
+		if( j - i != 2 ) {
+			return( false );
+		}
+		i = j;
+	}
+
+	return( !edges.empty() );
+}
+
+///
+/// Add a meshlet to an object's draw ranges, extending the last range
+/// if the meshlet follows right after it
+///
+/// @param s       the object's meshlets
+/// @param k       which meshlet
+/// @param first   the object's range starts
+/// @param count   the object's range lengths
+/// @param n       number of ranges so far (updated)
+///
+static void keepMeshlet( const MeshletSet &s, int k, GLsizei *first,
+	GLsizei *count, int &n )
+{
+	if( n > 0 && first[n - 1] + count[n - 1] == s.first[k] ) {
+		count[n - 1] += s.count[k];
+	} else {
+		first[n] = s.first[k];
+		count[n] = s.count[k];
+		n += 1;
+	}
+}
+
+//
+// MeshletSet
+//
+
+///
+/// Constructor
+///
+MeshletSet::MeshletSet( void ) : numMeshlets(0), triangles(0),
+	closed(false) {
+}
+
+///
+/// build(idx,nidx,pos,nverts) - divide a mesh into meshlets
+///
+/// @param idx      the mesh's index list (three per triangle)
+/// @param nidx     number of indices
+/// @param pos      vertex locations (XYZW)
+/// @param nverts   number of vertices
+///
+void MeshletSet::build( const GLuint *idx, int nidx, const float *pos,
+	int nverts ) {
+
+	first.clear(); count.clear();
+	cx.clear(); cy.clear(); cz.clear(); radius.clear();
+	ax.clear(); ay.clear(); az.clear(); cutoff.clear();
+	numMeshlets = 0;
+	triangles = nidx / 3;
+	closed = false;
+
+	if( nidx < 3 || nverts < 1 ) {
+		return;
+	}
+
+	// take the triangles in order until the next one won't fit; a
+	// vertex is in the current meshlet if its stamp is the meshlet's
+	vector<int> stamp( nverts, -1 );
+	int start = 0, verts = 0;
+
+	for( int t = 0; t + 2 < nidx; t += 3 ) {
+		int fresh = 0;
+		for( int k = 0; k < 3; ++k ) {
+			fresh += stamp[ idx[t + k] ] != numMeshlets;
+		}
+
+		if( verts + fresh > MESHLET_VERTICES ||
+			t - start >= 3 * MESHLET_TRIANGLES ) {
+			addBounds( idx, start, t - start, pos );
+			start = t;
+			verts = 0;
+		}
+
+		for( int k = 0; k < 3; ++k ) {
+			if( stamp[ idx[t + k] ] != numMeshlets ) {
+				stamp[ idx[t + k] ] = numMeshlets;
+				verts += 1;
+			}
+		}
+	}
+	addBounds( idx, start, (nidx / 3) * 3 - start, pos );
+
+	// pad the bounds so the last group can be loaded whole; padding
+	// is never tested
+	size_t padded = (numMeshlets + MESHLET_WIDTH - 1) / MESHLET_WIDTH *
+		MESHLET_WIDTH;
+	cx.resize( padded ); cy.resize( padded ); cz.resize( padded );
+	radius.resize( padded );
+	ax.resize( padded ); ay.resize( padded ); az.resize( padded );
+	cutoff.resize( padded, 1.0f );
+
+	closed = isClosed( idx, nidx, pos, nverts );
+}
+
+///
+/// addBounds(idx,first,count,pos) - add a meshlet and find its bounds
+///
+/// The sphere is centered on the meshlet's bounding box.  The cone's
+/// axis is the average of the triangles' normals, and its cutoff is the
+/// sine of the widest angle between that and any of them:  the meshlet
+/// faces entirely away from a viewer looking along a direction within
+/// 90 degrees minus that angle of the axis.
+///
+/// @param idx     the mesh's index list
+/// @param first   the meshlet's first index
+/// @param count   its number of indices
+/// @param pos     vertex locations (XYZW)
+///
+void MeshletSet::addBounds( const GLuint *idx, int first, int count,
+	const float *pos ) {
+	glm::vec3 lo( pos[4 * idx[first]], pos[4 * idx[first] + 1],
+		pos[4 * idx[first] + 2] ), hi( lo );
+
+	for( int i = first; i < first + count; ++i ) {
+		const float *p = pos + 4 * idx[i];
+		lo = glm::vec3( std::min( lo.x, p[0] ), std::min( lo.y, p[1] ),
+			std::min( lo.z, p[2] ) );
+		hi = glm::vec3( std::max( hi.x, p[0] ), std::max( hi.y, p[1] ),
+			std::max( hi.z, p[2] ) );
+	}
+
+	glm::vec3 c = (lo + hi) * 0.5f;
+	float r2 = 0.0f;
+	for( int i = first; i < first + count; ++i ) {
+		const float *p = pos + 4 * idx[i];
+		glm::vec3 d( p[0] - c.x, p[1] - c.y, p[2] - c.z );
+		r2 = std::max( r2, glm::dot( d, d ) );
+	}
+
+	// the unit normal of each triangle, and their sum
+	vector<glm::vec3> normals;
+	glm::vec3 sum( 0.0f );
+	for( int t = first; t + 2 < first + count; t += 3 ) {
+		const float *p0 = pos + 4 * idx[t];
+		const float *p1 = pos + 4 * idx[t + 1];
+		const float *p2 = pos + 4 * idx[t + 2];
+		glm::vec3 e1( p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] );
+		glm::vec3 e2( p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] );
+		glm::vec3 n = glm::cross( e1, e2 );
+		float len = sqrtf( glm::dot( n, n ) );
+		if( len > 0.0f ) {
+			normals.push_back( n / len );
+			sum += n / len;
+		}
+	}
+
+	glm::vec3 axis( 0.0f );
+	float cut = 1.0f;
+	float len = sqrtf( glm::dot( sum, sum ) );
+	if( len > 0.0f ) {
+		axis = sum / len;
+		float spread = 1.0f;
+		for( size_t k = 0; k < normals.size(); ++k ) {
+			spread = std::min( spread, glm::dot( axis, normals[k] ) );
+		}
+		if( spread > MESHLET_MIN_SPREAD ) {
+			cut = sqrtf( 1.0f - spread * spread );
+		}
+	}
+
+	this->first.push_back( first );
+	this->count.push_back( count );
+	cx.push_back( c.x );
+	cy.push_back( c.y );
+	cz.push_back( c.z );
+	radius.push_back( sqrtf( r2 ) );
+	ax.push_back( axis.x );
+	ay.push_back( axis.y );
+	az.push_back( axis.z );
+	cutoff.push_back( cut );
+	numMeshlets += 1;
+}
+
+//
+// MeshletCuller
+//
+
+///
+/// Constructor
+///
+MeshletCuller::MeshletCuller( void ) : meshlets(0), drawn(0), facing(0),
+	outside(0), ranges(0), triangles(0), submitted(0),
+	projView(1.0f), eye(0.0f), used(0) {
+}
+
+///
+/// begin(projView,eye) - start a new frame
+///
+/// @param pv    the projection matrix times the view matrix
+/// @param eye   the camera location (world coordinates)
+///
+void MeshletCuller::begin( const glm::mat4 &pv, const glm::vec3 &eye ) {
+	projView = pv;
+	this->eye = eye;
+	objects.clear();
+	used = 0;
+	meshlets = drawn = facing = outside = ranges = 0;
+	triangles = submitted = 0;
+}
+
+///
+/// add(set,model) - add an object to be culled
+///
+/// Its frustum planes and camera location are moved into its model
+/// coordinates, so its meshlets can be tested as they are.
+///
+/// @param set     its mesh's meshlets
+/// @param model   its model transformation
+///
+/// @return its position in this frame's objects
+///
+int MeshletCuller::add( const MeshletSet *set, const glm::mat4 &model ) {
+	MeshletObject o;
+
+	o.set = set;
+	extractPlanes( projView * model, o.planes );
+	o.eye = glm::inverse( glm::mat3( model ) ) *
+		(eye - glm::vec3( model[3] ));
+	o.slot = used;
+	o.ranges = o.facing = o.outside = 0;
+
+	used += set->numMeshlets;
+	objects.push_back( o );
+
+	return( (int) objects.size() - 1 );
+}
+
+///
+/// cull() - find the meshlets of each object that may be seen, and
+///     build the draw list
+///
+void MeshletCuller::cull( void ) {
+	int n = (int) objects.size();
+
+	first.resize( used );
+	count.resize( used );
+
+	if( n <= MESHLET_JOB ) {
+		for( int i = 0; i < n; ++i ) {
+			cullObject( objects[i] );
+		}
+	} else {
+		int njobs = (n + MESHLET_JOB - 1) / MESHLET_JOB;
+
+		// each object's ranges have a slot of their own, so the
+		// objects can be culled in any order
+		ThreadPool::shared().run( njobs, [&]( int job, int ) {
+			int last = std::min( n, (job + 1) * MESHLET_JOB );
+			for( int i = job * MESHLET_JOB; i < last; ++i ) {
+				cullObject( objects[i] );
+			}
+		} );
+	}
+
+	for( int i = 0; i < n; ++i ) {
+		const MeshletObject &o = objects[i];
+		meshlets += o.set->numMeshlets;
+		facing += o.facing;
+		outside += o.outside;
+		ranges += o.ranges;
+		triangles += o.set->triangles;
+		for( int k = 0; k < o.ranges; ++k ) {
+			submitted += count[o.slot + k] / 3;
+		}
+	}
+	drawn = meshlets - facing - outside;
+}
+
+///
+/// draw(obj,buf) - draw what is left of an object
+///
+/// The buffers must already have been selected.
+///
+/// @param obj   its position in this frame's objects
+/// @param buf   its mesh's buffers
+///
+void MeshletCuller::draw( int obj, BufferSet *buf ) {
+	const MeshletObject &o = objects[obj];
+
+	if( o.ranges > 0 ) {
+		buf->drawRanges( &first[o.slot], &count[o.slot], o.ranges );
+	}
+}
+
+///
+/// cullObject(o) - cull one object's meshlets and build its ranges
+///
+/// A meshlet is dropped if its sphere is entirely outside any plane of
+/// the frustum, or if its mesh is closed and the camera is far enough
+/// behind all of its triangles:  the direction from the camera to the
+/// sphere's center lies within the cone's cutoff of its axis, with the
+/// sphere's radius to spare.
+///
+/// @param o   the object
+///
+void MeshletCuller::cullObject( MeshletObject &o ) {
+	const MeshletSet &s = *o.set;
+	GLsizei *f = &first[o.slot], *c = &count[o.slot];
+	int n = s.numMeshlets;
+	int nr = 0;
+
+#if defined(MESHLET_SSE)
+	__m128 zero = _mm_setzero_ps();
+	__m128 px[6], py[6], pz[6], pw[6];
+
+	for( int p = 0; p < 6; ++p ) {
+		px[p] = _mm_set1_ps( o.planes[p].x );
+		py[p] = _mm_set1_ps( o.planes[p].y );
+		pz[p] = _mm_set1_ps( o.planes[p].z );
+		pw[p] = _mm_set1_ps( o.planes[p].w );
+	}
+	__m128 ex = _mm_set1_ps( o.eye.x );
+	__m128 ey = _mm_set1_ps( o.eye.y );
+	__m128 ez = _mm_set1_ps( o.eye.z );
+
+	for( int i = 0; i < n; i += MESHLET_WIDTH ) {
+		__m128 x = _mm_loadu_ps( &s.cx[i] );
+		__m128 y = _mm_loadu_ps( &s.cy[i] );
+		__m128 z = _mm_loadu_ps( &s.cz[i] );
+		__m128 r = _mm_loadu_ps( &s.radius[i] );
+		__m128 in = _mm_cmpeq_ps( zero, zero );
+
+		for( int p = 0; p < 6; ++p ) {
+			__m128 d = _mm_add_ps(
+				_mm_add_ps( _mm_mul_ps( px[p], x ), _mm_mul_ps( py[p], y ) ),
+				_mm_add_ps( _mm_mul_ps( pz[p], z ), pw[p] ) );
+			in = _mm_and_ps( in, _mm_cmpge_ps( _mm_add_ps( d, r ), zero ) );
+		}
+
+		// from the camera to the center, along the cone's axis
+		__m128 vx = _mm_sub_ps( x, ex );
+		__m128 vy = _mm_sub_ps( y, ey );
+		__m128 vz = _mm_sub_ps( z, ez );
+		__m128 along = _mm_add_ps(
+			_mm_add_ps( _mm_mul_ps( vx, _mm_loadu_ps( &s.ax[i] ) ),
+						_mm_mul_ps( vy, _mm_loadu_ps( &s.ay[i] ) ) ),
+			_mm_mul_ps( vz, _mm_loadu_ps( &s.az[i] ) ) );
+		__m128 dist = _mm_sqrt_ps( _mm_add_ps(
+			_mm_add_ps( _mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) ),
+			_mm_mul_ps( vz, vz ) ) );
+		__m128 away = _mm_cmpge_ps( along, _mm_add_ps(
+			_mm_mul_ps( _mm_loadu_ps( &s.cutoff[i] ), dist ), r ) );
+
+		int inBits = _mm_movemask_ps( in );
+		int awayBits = s.closed ? _mm_movemask_ps( away ) : 0;
+		int m = std::min( MESHLET_WIDTH, n - i );
+		for( int k = 0; k < m; ++k ) {
+			if( ((inBits >> k) & 1) == 0 ) {
+				o.outside += 1;
+			} else if( (awayBits >> k) & 1 ) {
+				o.facing += 1;
+			} else {
+				keepMeshlet( s, i + k, f, c, nr );
+			}
+		}
+	}
+#else
+	for( int i = 0; i < n; ++i ) {
+		bool in = true;
+
+		for( int p = 0; p < 6 && in; ++p ) {
+			const glm::vec4 &pl = o.planes[p];
+			float d = pl.x * s.cx[i] + pl.y * s.cy[i] + pl.z * s.cz[i] + pl.w;
+			in = d + s.radius[i] >= 0.0f;
+		}
+		if( !in ) {
+			o.outside += 1;
+			continue;
+		}
+
+		if( s.closed ) {
+			glm::vec3 v( s.cx[i] - o.eye.x, s.cy[i] - o.eye.y,
+				s.cz[i] - o.eye.z );
+			float along = v.x * s.ax[i] + v.y * s.ay[i] + v.z * s.az[i];
+			if( along >= s.cutoff[i] * sqrtf( glm::dot( v, v ) ) +
+				s.radius[i] ) {
+				o.facing += 1;
+				continue;
+			}
+		}
+
+		keepMeshlet( s, i, f, c, nr );
+	}
+#endif
+
+	o.ranges = nr;
+}
@@ -0,0 +1,211 @@
+//
+//  Meshlets.h
+//
+//  Clusters of triangles ("meshlets"), and culling them a frame at a
+//  time.
+//
+//  A mesh's index list is cut into meshlets of at most MESHLET_VERTICES
+//  distinct vertices and MESHLET_TRIANGLES triangles, taking triangles
+//  in the order they are drawn.  After the vertex cache optimization
+//  (see MeshOpt.h) neighboring triangles are close together in that
+//  order, so each meshlet is a compact patch of the surface; and since
+//  each is a run of consecutive indices, any of them can be drawn on
+//  its own.  Each meshlet gets a bounding sphere, and a cone (an axis
+//  and a cutoff) holding the normals of all its triangles.
+//
+//  Every frame, a MeshletCuller tests the meshlets of each object that
+//  is drawn with them against the view frustum and, if the mesh is
+//  closed (so that its back faces can never be seen), against the
+//  direction to the camera:  a meshlet whose triangles all face away
+//  from the camera is dropped.  The tests are done in each object's
+//  model coordinates, four meshlets at a time with SSE, and the objects
+//  are split into jobs on the shared ThreadPool.  The meshlets that are
+//  left are merged into runs of adjacent ones, giving each object a
+//  compacted list of index ranges to draw with one multi-draw call.
+//
+
+#ifndef MESHLETS_H_
+#define MESHLETS_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Buffers.h"
+
+using namespace std;
+
+//
+// Most vertices and triangles in a meshlet
+//
+#define MESHLET_VERTICES    64
+#define MESHLET_TRIANGLES   124
+
+//
+// Meshlets are tested this many at a time
+//
+#define MESHLET_WIDTH       4
+
+//
+// Meshes with fewer meshlets than this are drawn whole
+//
+#define MESHLET_MIN         4
+
+//
+// Objects culled in each job
+//
+#define MESHLET_JOB         32
+
+class MeshletSet {
+
+public:
+	// where each meshlet's indices begin (counted from the mesh's
+	// first index) and how many it has
+	vector<GLsizei> first, count;
+
+	// bounding spheres and normal cones (model coordinates), one array
+	// per component, padded to a multiple of MESHLET_WIDTH; a cutoff
+	// of 1 marks a meshlet whose normals are too spread out for it
+	// ever to face entirely away
+	vector<float> cx, cy, cz, radius;
+	vector<float> ax, ay, az, cutoff;
+
+	// number of meshlets, and of triangles in all of them
+	int numMeshlets;
+	long triangles;
+
+	// is every edge shared by exactly two triangles?
+	bool closed;
+
+public:
+
+	///
+	/// Constructor
+	///
+	MeshletSet( void );
+
+	///
+	/// build(idx,nidx,pos,nverts) - divide a mesh into meshlets
+	///
+	/// @param idx      the mesh's index list (three per triangle)
+	/// @param nidx     number of indices
+	/// @param pos      vertex locations (XYZW)
+	/// @param nverts   number of vertices
+	///
+	void build( const GLuint *idx, int nidx, const float *pos, int nverts );
+
+private:
+
+	///
+	/// addBounds(idx,first,count,pos) - find the bounds of a meshlet
+	///
+	/// @param idx     the mesh's index list
+	/// @param first   the meshlet's first index
+	/// @param count   its number of indices
+	/// @param pos     vertex locations (XYZW)
+	///
+	void addBounds( const GLuint *idx, int first, int count,
+		const float *pos );
+
+};
+
+//
+// An object whose meshlets are being culled this frame
+//
+typedef struct st_meshletobj {
+	const MeshletSet *set;   // its meshlets
+	glm::vec4 planes[6];     // the view frustum, in model coordinates
+	glm::vec3 eye;           // the camera, in model coordinates
+	int slot;                // where its ranges go in the draw list
+	int ranges;              // how many ranges it has
+	int facing;              // meshlets dropped for facing away
+	int outside;             // meshlets dropped for being off the screen
+} MeshletObject;
+
+class MeshletCuller {
+
+public:
+	// this frame's objects
+	vector<MeshletObject> objects;
+
+	// the compacted draw list:  index ranges (counted from each mesh's
+	// first index), each object's in a slot of its own
+	vector<GLsizei> first, count;
+
+	// what happened this frame
+	long meshlets;        // meshlets tested
+	long drawn;           // meshlets left to draw
+	long facing;          // dropped for facing away
+	long outside;         // dropped for being off the screen
+	long ranges;          // draw ranges they were merged into
+	long triangles;       // triangles in the objects' whole meshes
+	long submitted;       // triangles in the meshlets left
+
+private:
+	// the view for this frame, and where its slots end
+	glm::mat4 projView;
+	glm::vec3 eye;
+	int used;
+
+public:
+
+	///
+	/// Constructor
+	///
+	MeshletCuller( void );
+
+	///
+	/// begin(projView,eye) - start a new frame
+	///
+	/// @param pv    the projection matrix times the view matrix
+	/// @param eye   the camera location (world coordinates)
+	///
+	void begin( const glm::mat4 &pv, const glm::vec3 &eye );
+
+	///
+	/// add(set,model) - add an object to be culled
+	///
+	/// @param set     its mesh's meshlets
+	/// @param model   its model transformation
+	///
+	/// @return its position in this frame's objects
+	///
+	int add( const MeshletSet *set, const glm::mat4 &model );
+
+	///
+	/// cull() - find the meshlets of each object that may be seen,
+	///     and build the draw list
+	///
+	void cull( void );
+
+	///
+	/// draw(obj,buf) - draw what is left of an object
+	///
+	/// The buffers must already have been selected.
+	///
+	/// @param obj   its position in this frame's objects
+	/// @param buf   its mesh's buffers
+	///
+	void draw( int obj, BufferSet *buf );
+
+private:
+
+	///
+	/// cullObject(o) - cull one object's meshlets and build its ranges
+	///
+	/// @param o   the object
+	///
+	void cullObject( MeshletObject &o );
+
+};
+
+#endif
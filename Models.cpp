@@ -12,7 +12,10 @@
 //
 
 #include <iostream>
+#include <iomanip>
 #include <cmath>
+#include <deque>
+#include <unordered_map>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
@@ -22,10 +25,12 @@
 #include <GLFW/glfw3.h>
 
 #include "Models.h"
+#include "MeshOpt.h"
+#include "Simplify.h"
+#include "ThreadPool.h"
 
-// data for the three objects
-#include "CylinderData.h"
-#include "QuadData.h"
+// data for the cylinder and quad, generated at compile time
+#include "MeshTables.h"
 
 using namespace std;
 
@@ -33,6 +38,84 @@ using namespace std;
 // PRIVATE GLOBALS
 //
 
+// weld identical vertices in each object before creating its buffers?
+static bool weldMeshes = true;
+
+// reorder each (welded) object's triangles and vertices for the
+// vertex cache, overdraw, and vertex fetching?
+static bool optimizeMeshes = true;
+
+// build simpler levels of detail of each (welded) object?
+static bool makeLODs = true;
+
+// divide each object's mesh into meshlets (see Meshlets.h)?
+static bool makeMeshlets = true;
+
+// tessellation of each generated shape (see Shapes.h)
+static int shapeTess[ N_SHAPES ] = {
+	32      // SHAPE_SPHERE:   32 slices, 16 stacks
+	, 32    // SHAPE_CONE:     32 slices, 8 stacks
+	, 1     // SHAPE_PYRAMID
+	, 1     // SHAPE_PRISM
+	, 1     // SHAPE_CUBE
+};
+
+// build objects on worker threads in createObjects()?
+static bool useThreads = true;
+
+// the workers' Canvases
+static vector<Canvas *> workerCanvas;
+
+// expected vertex count (before welding) of each object; used to size
+// the Canvas' storage up front, and updated each time the object is built
+static int meshHint[ N_OBJECTS ];
+#define MESH_HINT_DEFAULT   1024
+
+// index and vertex counts for each object, as sent to its buffers
+static int meshIndices[ N_OBJECTS ];
+static int meshVertices[ N_OBJECTS ];
+
+// meshlets of each object's full mesh
+static MeshletSet meshClusters[ N_OBJECTS ];
+
+// ACMR of each object before and after optimization
+static float meshACMRBefore[ N_OBJECTS ];
+static float meshACMRAfter[ N_OBJECTS ];
+
+// levels of detail of each object:  how many there are, and the
+// index count and error (model coordinates) of each
+static int meshLODs[ N_OBJECTS ];
+static GLsizei meshLODIndices[ N_OBJECTS ][ MAX_LODS ];
+static float meshLODError[ N_OBJECTS ][ MAX_LODS ];
+
+// bounding box and sphere of each object, in model coordinates
+static Bounds meshBounds[ N_OBJECTS ];
+
+// vertex size (bytes) and packing error of each object
+static int meshStride[ N_OBJECTS ];
+static PackError meshPackError[ N_OBJECTS ];
+
+// let objects whose meshes come out identical share one set of buffers?
+static bool shareMeshes = true;
+
+// content hash of each object's finished mesh
+static uint64_t meshHash[ N_OBJECTS ];
+
+// the buffers each object is drawn with (its own, or those of the
+// object it shares with), and whose they are
+static BufferSet *meshBuffers[ N_OBJECTS ];
+static Object meshOwner[ N_OBJECTS ];
+
+// the meshes with buffers of their own, by content hash
+typedef struct st_meshentry {
+	BufferSet *buf;      // the buffers
+	Object owner;        // the object they were created for
+	int vertices;        // what's in them (a guard against collisions)
+	int indices;
+} MeshEntry;
+
+static unordered_map<uint64_t,MeshEntry> meshRegistry;
+
 //
 // PUBLIC GLOBALS
 //
@@ -59,23 +142,24 @@ const char *objects[ N_OBJECTS ] = {
 ///
 static void makeQuad( Canvas &C )
 {
-	for( int i = 0; i < quadElementsLength - 2; i += 3 ) {
+	for( int i = 0; i < quad.nelems - 2; i += 3 ) {
 
 		// Calculate the base indices of the three vertices
-		int point1 = quadElements[i];
-		int point2 = quadElements[i + 1];
-		int point3 = quadElements[i + 2];
+		int point1 = quad.elements[i];
+		int point2 = quad.elements[i + 1];
+		int point3 = quad.elements[i + 2];
 
-		Vertex p1 = quadVertices[point1];
-		Vertex p2 = quadVertices[point2];
-		Vertex p3 = quadVertices[point3];
+		Vertex p1 = quad.verts[point1];
+		Vertex p2 = quad.verts[point2];
+		Vertex p3 = quad.verts[point3];
 
 		// Add this triangle to the collection
-		C.addTriangleWithNorms( p1, quadNorm, p2, quadNorm, p3, quadNorm );
+		C.addTriangleWithNorms( p1, quad.normal, p2, quad.normal,
+			p3, quad.normal );
 
 		// Add the texture coordinates
-		C.addTextureCoords( quadUV[point1], quadUV[point2],
-							quadUV[point3] );
+		C.addTextureCoords( quad.uv[point1], quad.uv[point2],
+							quad.uv[point3] );
 	}
 }
 
@@ -85,16 +169,16 @@ static void makeQuad( Canvas &C )
 void makeCylinder( Canvas &C )
 {
 	// Only use the vertices for the body itself
-	for( int i = body.first; i <= body.last - 2; i += 3 ) {
+	for( int i = cylinder.body.first; i <= cylinder.body.last - 2; i += 3 ) {
 
 		// Calculate the base indices of the three vertices
-		int point1 = cylinderElements[i];
-		int point2 = cylinderElements[i + 1];
-		int point3 = cylinderElements[i + 2];
+		int point1 = cylinder.elements[i];
+		int point2 = cylinder.elements[i + 1];
+		int point3 = cylinder.elements[i + 2];
 
-		Vertex p1 = cylinderVertices[point1];
-		Vertex p2 = cylinderVertices[point2];
-		Vertex p3 = cylinderVertices[point3];
+		Vertex p1 = cylinder.verts[point1];
+		Vertex p2 = cylinder.verts[point2];
+		Vertex p3 = cylinder.verts[point3];
 
 		// Calculate the normal vectors for each vertex
 		Normal n1, n2, n3;
@@ -144,11 +228,22 @@ void makeCylinder( Canvas &C )
 }
 
 ///
-/// makeSphere() - create the spehere body
+/// addShape() - add one of the generated shapes to a Canvas
+///
+static void addShape( Canvas &C, Shape shape )
+{
+	const MeshData &m = getShape( shape, shapeTess[shape] );
+
+	C.addMesh( m.verts.data(), m.norms.data(), m.uvs.data(),
+		(int) m.verts.size(), m.elements.data(), (int) m.elements.size() );
+}
+
+///
+/// makeSphere() - create the sphere body
 ///
 void makeSphere( Canvas &C )
 {
-	
+	addShape( C, SHAPE_SPHERE );
 }
 
 ///
@@ -156,23 +251,23 @@ void makeSphere( Canvas &C )
 ///
 void makeCone( Canvas &C )
 {
-	
+	addShape( C, SHAPE_CONE );
 }
 
 ///
-/// makeCone() - create the cone body
+/// makePyramid() - create the pyramid body
 ///
 void makePyramid( Canvas &C )
 {
-	
+	addShape( C, SHAPE_PYRAMID );
 }
 
 ///
-/// makeTriangularPrism() - create a triangular prism????
+/// makeTriangularPrism() - create a triangular prism
 ///
 void makeTriangularPrism( Canvas &C )
 {
-	
+	addShape( C, SHAPE_PRISM );
 }
 
 ///
@@ -180,7 +275,7 @@ void makeTriangularPrism( Canvas &C )
 ///
 void makeCube( Canvas &C )
 {
-	
+	addShape( C, SHAPE_CUBE );
 }
 
 ///
@@ -200,12 +295,12 @@ static void makeDiscs( Canvas &C )
 		Normal nn;
 
 		if( disc == 0 ) { // bottom disc
-			first = bdisc.first;
-			last  = bdisc.last;
+			first = cylinder.bdisc.first;
+			last  = cylinder.bdisc.last;
 			nn = (Normal) { 0.0f, -1.0f, 0.0f };
 		} else {
-			first = tdisc.first;
-			last  = tdisc.last;
+			first = cylinder.tdisc.first;
+			last  = cylinder.tdisc.last;
 			nn = (Normal) { 0.0f, 1.0f, 0.0f };
 		}
 
@@ -213,13 +308,13 @@ static void makeDiscs( Canvas &C )
 		for( int i = first; i <= last - 2; i += 3 ) {
 
 			// Calculate the base indices of the three vertices
-			int point1 = cylinderElements[i];
-			int point2 = cylinderElements[i + 1];
-			int point3 = cylinderElements[i + 2];
+			int point1 = cylinder.elements[i];
+			int point2 = cylinder.elements[i + 1];
+			int point3 = cylinder.elements[i + 2];
 
-			Vertex p1 = cylinderVertices[point1];
-			Vertex p2 = cylinderVertices[point2];
-			Vertex p3 = cylinderVertices[point3];
+			Vertex p1 = cylinder.verts[point1];
+			Vertex p2 = cylinder.verts[point2];
+			Vertex p3 = cylinder.verts[point3];
 
 			// Add this triangle to the collection
 			C.addTriangleWithNorms( p1, nn, p2, nn, p3, nn );
@@ -248,21 +343,95 @@ static void makeDiscs( Canvas &C )
 	}
 }
 
-//
-// PUBLIC FUNCTIONS
-//
+///
+/// buildMeshlets() - divide the full mesh of an object into meshlets
+///
+/// @param C      the Canvas holding the (finished) object
+/// @param obj    which object it is
+///
+static void buildMeshlets( Canvas &C, Object obj )
+{
+	if( !makeMeshlets || !C.isIndexed() ) {
+		meshClusters[obj].build( nullptr, 0, nullptr, 0 );
+		return;
+	}
+
+	int nidx = C.numIndices();
+	int nverts = C.numVertices();
+	vector<GLuint> idx( nidx );
+	C.writeElements( idx.data() );
+	vector<float> pos( nverts * 4 );
+	C.writeVertices( pos.data() );
+
+	meshClusters[obj].build( idx.data(), nidx, pos.data(), nverts );
+}
 
 ///
-/// Create an object
+/// buildLevels() - add the simpler levels of detail of an object to
+///     the end of the index list in its Canvas
 ///
-/// @param C      the Canvas we'll be using
-/// @param obj    which object to draw
-/// @param buf    BufferSet to use for the object
+/// @param C      the Canvas holding the (finished) object
+/// @param obj    which object it is
 ///
-void createObject( Canvas &C, Object obj, BufferSet &buf )
+static void buildLevels( Canvas &C, Object obj )
+{
+	meshLODs[obj] = 1;
+	meshLODIndices[obj][0] = C.numIndices();
+	meshLODError[obj][0] = 0.0f;
+
+	if( !makeLODs || !C.isIndexed() ) {
+		return;
+	}
+
+	int nidx = C.numIndices();
+	int nverts = C.numVertices();
+	vector<GLuint> idx( nidx );
+	C.writeElements( idx.data() );
+	vector<float> pos( nverts * 4 );
+	C.writeVertices( pos.data() );
+
+	vector<GLuint> lods[ MAX_LODS - 1 ];
+	float errors[ MAX_LODS - 1 ];
+	int n = buildLODs( idx.data(), nidx, pos.data(), nverts, MAX_LODS - 1,
+		lods, errors );
+	if( n < 1 ) {
+		return;
+	}
+
+	// each level gets the same vertex cache ordering as the full mesh
+	for( int i = 0; i < n; ++i ) {
+		optimizeVertexCache( lods[i].data(), (int) lods[i].size(), nverts );
+		idx.insert( idx.end(), lods[i].begin(), lods[i].end() );
+		meshLODIndices[obj][i + 1] = (GLsizei) lods[i].size();
+		meshLODError[obj][i + 1] = errors[i];
+	}
+
+	if( C.setElements( idx ) ) {
+		meshLODs[obj] = n + 1;
+	}
+}
+
+///
+/// buildObject() - generate an object's mesh in a Canvas
+///
+/// Touches only the Canvas and this object's entries in the tables
+/// above, so different objects can be built on different threads.
+///
+/// @param C      the Canvas to build it in
+/// @param obj    which object to build
+///
+/// @return true if the object was built
+///
+static bool buildObject( Canvas &C, Object obj )
 {
-	// start with a fresh Canvas
+	// start with a fresh Canvas, sized for this object
 	C.clear();
+	if( obj < N_OBJECTS ) {
+		if( meshHint[obj] == 0 ) {
+			meshHint[obj] = MESH_HINT_DEFAULT;
+		}
+		C.reserve( meshHint[obj] );
+	}
 
 	// create the specified object
 	switch( obj ) {
@@ -279,9 +448,499 @@ void createObject( Canvas &C, Object obj, BufferSet &buf )
 
 	default:
 		cerr << "createObject(" << obj << ") - unknown object type" << endl;
-		return;
+		return( false );
+	}
+
+	// next time, ask for exactly what this one needed
+	if( C.numVertices() > 0 ) {
+		meshHint[obj] = C.numVertices();
+	}
+
+	// merge the vertices the generator duplicated
+	if( weldMeshes ) {
+		C.weld();
+	}
+
+	// then put them in a GPU-friendly order
+	if( optimizeMeshes ) {
+		optimizeMesh( C, meshACMRBefore[obj], meshACMRAfter[obj] );
+	}
+	meshIndices[obj] = C.numIndices();
+	meshVertices[obj] = C.numVertices();
+	computeBounds( C.getVertices(), C.numVertices(), meshBounds[obj] );
+	buildMeshlets( C, obj );
+	buildLevels( C, obj );
+	if( shareMeshes ) {
+		meshHash[obj] = C.contentHash();
+	}
+
+	return( true );
+}
+
+///
+/// uploadObject() - create the buffers for an object built in a Canvas
+///
+/// Must be called on the thread that owns the OpenGL context.
+///
+/// @param C      the Canvas holding the object
+/// @param obj    which object it is
+/// @param buf    BufferSet to use for the object
+///
+static void uploadObject( Canvas &C, Object obj, BufferSet &buf )
+{
+	// whatever these buffers held before is being replaced
+	for( auto it = meshRegistry.begin(); it != meshRegistry.end(); ) {
+		if( it->second.buf == &buf ) {
+			it = meshRegistry.erase( it );
+		} else {
+			++it;
+		}
+	}
+
+	// if an identical mesh already has buffers, use those
+	if( shareMeshes ) {
+		auto found = meshRegistry.find( meshHash[obj] );
+		if( found != meshRegistry.end() &&
+			found->second.vertices == meshVertices[obj] &&
+			found->second.indices == meshIndices[obj] ) {
+			Object owner = found->second.owner;
+			meshBuffers[obj] = found->second.buf;
+			meshOwner[obj] = owner;
+			meshStride[obj] = meshStride[owner];
+			meshPackError[obj] = meshPackError[owner];
+			return;
+		}
 	}
 
 	// create the buffers for the object
 	buf.createBuffers( C );
+	buf.setLODs( meshLODs[obj], meshLODIndices[obj] );
+	meshBuffers[obj] = &buf;
+	meshOwner[obj] = obj;
+
+	if( shareMeshes ) {
+		MeshEntry e = { &buf, obj, meshVertices[obj], meshIndices[obj] };
+		meshRegistry[ meshHash[obj] ] = e;
+	}
+
+	// remember what it cost us
+	meshStride[obj] = buf.stride;
+	meshPackError[obj] = buf.packError;
+}
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Create an object
+///
+/// @param C      the Canvas we'll be using
+/// @param obj    which object to draw
+/// @param buf    BufferSet to use for the object
+///
+void createObject( Canvas &C, Object obj, BufferSet &buf )
+{
+	if( obj >= 0 && obj < N_OBJECTS ) {
+		meshBuffers[obj] = &buf;
+		meshOwner[obj] = obj;
+	}
+
+	if( buildObject( C, obj ) ) {
+		uploadObject( C, obj, buf );
+	}
+}
+
+///
+/// Create several objects, generating their meshes in parallel
+///
+/// Each worker thread builds objects in a Canvas of its own; as each
+/// one is finished, it is handed to this (the context's) thread for
+/// its buffers to be created, and the worker waits until that's done
+/// before reusing its Canvas.  With no workers available, this is
+/// just a series of createObject() calls using C.
+///
+/// @param C      the Canvas to use on this thread
+/// @param objs   the objects to create (each at most once)
+/// @param n      how many there are
+/// @param bufs   BufferSets for all objects, indexed by Object
+/// @param stats  if not NULL, receives what building them cost
+///
+void createObjects( Canvas &C, const Object *objs, int n,
+	BufferSet *bufs, BuildStats *stats )
+{
+	ThreadPool &pool = ThreadPool::shared();
+	int nworkers = useThreads ? pool.size() : 0;
+
+	// one Canvas per worker, kept from one scene build to the next
+	while( (int) workerCanvas.size() < nworkers ) {
+		workerCanvas.push_back( new Canvas( 1, 1 ) );
+		workerCanvas.back()->storage().setHugePages(
+			C.storage().usesHugePages() );
+	}
+
+	C.storage().resetStats();
+	for( int w = 0; w < nworkers; ++w ) {
+		workerCanvas[w]->storage().resetStats();
+	}
+
+	for( int i = 0; i < n; ++i ) {
+		if( objs[i] >= 0 && objs[i] < N_OBJECTS ) {
+			meshBuffers[objs[i]] = &bufs[objs[i]];
+			meshOwner[objs[i]] = objs[i];
+		}
+	}
+
+	if( nworkers == 0 || n < 2 ) {
+
+		for( int i = 0; i < n; ++i ) {
+			createObject( C, objs[i], bufs[objs[i]] );
+		}
+		nworkers = 0;
+
+	} else {
+
+		// finished objects waiting for their buffers:  (job, worker)
+		mutex lock;
+		condition_variable ready, uploaded;
+		deque< pair<int,int> > waiting;
+		vector<bool> busy( nworkers, false );
+		vector<char> built( n, 0 );
+
+		pool.start( n, [&]( int job, int w ) {
+			built[job] = buildObject( *workerCanvas[w], objs[job] );
+
+			// hand it over, and wait for the upload
+			unique_lock<mutex> l( lock );
+			busy[w] = true;
+			waiting.push_back( make_pair( job, w ) );
+			ready.notify_one();
+			uploaded.wait( l, [&] { return( !busy[w] ); } );
+		} );
+
+		for( int done = 0; done < n; ++done ) {
+			unique_lock<mutex> l( lock );
+			ready.wait( l, [&] { return( !waiting.empty() ); } );
+			pair<int,int> item = waiting.front();
+			waiting.pop_front();
+			l.unlock();
+
+			// the worker is blocked, so its Canvas is ours for now
+			if( built[item.first] ) {
+				uploadObject( *workerCanvas[item.second], objs[item.first],
+					bufs[objs[item.first]] );
+			}
+
+			l.lock();
+			busy[item.second] = false;
+			uploaded.notify_all();
+		}
+
+		pool.wait();
+	}
+
+	if( stats != nullptr ) {
+		stats->threads = nworkers;
+		stats->peakBytes = C.storage().peakBytes;
+		stats->reserved = C.storage().reserved;
+		stats->allocations = C.storage().allocations;
+		stats->chunkAllocations = C.storage().chunkAllocations;
+		for( int w = 0; w < nworkers; ++w ) {
+			MemArena &A = workerCanvas[w]->storage();
+			stats->peakBytes += A.peakBytes;
+			stats->reserved += A.reserved;
+			stats->allocations += A.allocations;
+			stats->chunkAllocations += A.chunkAllocations;
+		}
+	}
+}
+
+///
+/// Get the buffers to draw an object with; objects whose meshes are
+/// identical share the buffers of the first one created
+///
+/// @param obj    which object
+///
+/// @return the object's buffers, or NULL if it hasn't been created
+///
+BufferSet *getBuffers( Object obj )
+{
+	if( obj < 0 || obj >= N_OBJECTS ) {
+		return( nullptr );
+	}
+
+	return( meshBuffers[obj] );
+}
+
+///
+/// Get the meshlets of an object's full mesh, found when it was built
+///
+/// @param obj    which object
+///
+/// @return its meshlets (none if it isn't indexed)
+///
+const MeshletSet &getMeshlets( Object obj )
+{
+	static const MeshletSet none;
+
+	if( obj < 0 || obj >= N_OBJECTS ) {
+		return( none );
+	}
+
+	return( meshClusters[obj] );
+}
+
+///
+/// Get the bounds of an object's mesh, found when it was built
+///
+/// @param obj    which object
+///
+/// @return its bounding box and sphere, in model coordinates
+///
+const Bounds &getBounds( Object obj )
+{
+	static const Bounds none = { glm::vec3( 0.0f ), glm::vec3( 0.0f ), 0.0f };
+
+	if( obj < 0 || obj >= N_OBJECTS ) {
+		return( none );
+	}
+
+	return( meshBounds[obj] );
+}
+
+///
+/// Get a box lying entirely inside an object's mesh, for use as an
+/// occluder
+///
+/// The cylinder bodies are open at the ends, but are closed by their
+/// roofs wherever they are used.
+///
+/// @param obj    which object
+/// @param box    receives the box, in model coordinates
+///
+/// @return false if the object is not solid enough to have one
+///
+bool getOccluder( Object obj, Bounds &box )
+{
+	if( obj < 0 || obj >= N_OBJECTS ) {
+		return( false );
+	}
+
+	box = meshBounds[obj];
+
+	switch( obj ) {
+	case SiloBody:
+	case MainBarnBody: {
+		// the square inscribed in the polygon inscribed in the circle
+		float s = cosf( (float) M_PI / CYLINDER_TESS ) / sqrtf( 2.0f );
+		box.extent.x *= s;
+		box.extent.z *= s;
+		break;
+	}
+
+	case AltBarnBody:
+	case MiniBarnBody:
+		break;
+
+	default:
+		return( false );
+	}
+
+	box.radius = sqrtf( box.extent.x * box.extent.x +
+		box.extent.y * box.extent.y + box.extent.z * box.extent.z );
+
+	return( true );
+}
+
+///
+/// Choose the level of detail to draw an object at
+///
+/// The coarsest level whose error covers at most LOD_PIXELS pixels on
+/// the screen is chosen.  So that objects near the distance where two
+/// levels meet don't flicker between them, an object only moves to a
+/// coarser level once that level's error is under LOD_HYSTERESIS
+/// times the limit.
+///
+/// @param obj       which object
+/// @param pixels    pixels covered by one unit of model coordinates at
+///                  the object's distance
+/// @param current   the level it was last drawn at (-1 if none)
+///
+/// @return the level to draw it at
+///
+int selectLOD( Object obj, float pixels, int current )
+{
+	if( obj < 0 || obj >= N_OBJECTS ) {
+		return( 0 );
+	}
+
+	const float *err = meshLODError[obj];
+	int n = meshLODs[obj];
+
+	if( current < 0 ) {
+		current = 0;
+	} else if( current >= n ) {
+		current = n - 1;
+	}
+
+	// too coarse for where it is now
+	while( current > 0 && err[current] * pixels > LOD_PIXELS ) {
+		current -= 1;
+	}
+
+	// or far enough away for a coarser level
+	while( current + 1 < n &&
+		   err[current + 1] * pixels <= LOD_PIXELS * LOD_HYSTERESIS ) {
+		current += 1;
+	}
+
+	return( current );
+}
+
+///
+/// Create the control cage the cylinder bodies are tessellated from
+/// on the GPU
+///
+/// The cage is CAGE_SLICES quad patches around the body, wound and
+/// texture mapped as makeCylinder() does; each has its corners in the
+/// order bottom right, bottom left, top left, top right (as seen from
+/// outside).  The tessellation evaluation shader places every vertex it
+/// generates on the true cylinder using only its interpolated (u,v),
+/// so the corners' locations matter only for choosing how finely to
+/// divide each edge.
+///
+/// @param C      the Canvas to build it in
+/// @param buf    BufferSet to use for it
+///
+void createCage( Canvas &C, BufferSet &buf )
+{
+	Vertex verts[ 2 * (CAGE_SLICES + 1) ];
+	Normal norms[ 2 * (CAGE_SLICES + 1) ];
+	TexCoord uvs[ 2 * (CAGE_SLICES + 1) ];
+	GLuint idx[ 4 * CAGE_SLICES ];
+
+	// a column of two vertices at each step around; the seam gets
+	// two columns, at u = 0 and u = 1
+	for( int k = 0; k <= CAGE_SLICES; ++k ) {
+		float u = (float) k / CAGE_SLICES;
+		float theta = u * 2.0f * (float) M_PI - (float) M_PI;
+		float x = 0.5f * cosf( theta ), z = 0.5f * sinf( theta );
+
+		for( int j = 0; j < 2; ++j ) {
+			int v = 2 * k + j;
+			verts[v] = (Vertex) { x, j - 0.5f, z, 1.0f };
+			norms[v] = (Normal) { x, 0.0f, z };
+			uvs[v] = (TexCoord) { u, (float) j };
+		}
+	}
+
+	// u runs the other way around from the cylinder table's angle, so
+	// each quad is wound from the larger u to the smaller
+	int n = 0;
+	for( int k = 0; k < CAGE_SLICES; ++k ) {
+		GLuint b0 = 2 * k, t0 = b0 + 1, b1 = b0 + 2, t1 = b0 + 3;
+		idx[n++] = b1;  idx[n++] = b0;  idx[n++] = t0;  idx[n++] = t1;
+	}
+
+	C.clear();
+	C.addMesh( verts, norms, uvs, 2 * (CAGE_SLICES + 1), idx, n );
+
+	buf.createBuffers( C );
+	buf.primitive = GL_PATCHES;
+}
+
+///
+/// Is an object drawn from the control cage when the GPU is
+/// tessellating the cylinders?
+///
+/// @param obj    which object
+///
+/// @return true for the cylinder bodies
+///
+bool usesCage( Object obj )
+{
+	return( obj == SiloBody || obj == MainBarnBody );
+}
+
+///
+/// Set the tessellation of a generated shape; objects created
+/// afterward use it
+///
+/// @param shape  which shape
+/// @param tess   its tessellation (see Shapes.h)
+///
+void setTessellation( Shape shape, int tess )
+{
+	if( shape >= 0 && shape < N_SHAPES ) {
+		shapeTess[shape] = tess;
+	}
+}
+
+///
+/// Print the vertex and index counts for each object, how much
+/// welding reduced the vertex count, and how much optimization
+/// reduced the ACMR (vertices transformed per triangle)
+///
+void printMeshStats( void )
+{
+	long indices = 0, vertices = 0;
+	int objs = 0, sets = 0;
+	long saved = 0;
+
+	cout << "Meshes (" << (weldMeshes ? "welded" : "not welded") << "):"
+		 << endl;
+	for( int i = 0; i < N_OBJECTS; ++i ) {
+		if( meshIndices[i] == 0 ) {
+			continue;
+		}
+		cout << "  " << setw(13) << left << objects[i] << right
+			 << setw(7) << meshIndices[i] << " indices "
+			 << setw(7) << meshVertices[i] << " vertices  ("
+			 << fixed << setprecision(1)
+			 << (100.0 * meshVertices[i] / meshIndices[i]) << "%)";
+		if( meshACMRBefore[i] > 0.0f ) {
+			cout << setprecision(3) << "  ACMR " << meshACMRBefore[i]
+				 << " -> " << meshACMRAfter[i];
+		}
+		cout << endl;
+		if( meshLODs[i] > 1 ) {
+			cout << "                levels of detail:";
+			for( int k = 0; k < meshLODs[i]; ++k ) {
+				cout << " " << meshLODIndices[i][k] / 3 << " ("
+					 << setprecision(4) << meshLODError[i][k] << ")";
+			}
+			cout << " triangles (error)" << endl;
+		}
+		if( meshClusters[i].numMeshlets > 0 ) {
+			cout << "                " << meshClusters[i].numMeshlets
+				 << " meshlets" << (meshClusters[i].closed ? "" :
+				 " (open mesh:  no cone culling)") << endl;
+		}
+		objs += 1;
+		if( meshBuffers[i] != nullptr && meshOwner[i] != i ) {
+			cout << "                shares the buffers of "
+				 << objects[meshOwner[i]] << endl;
+			saved += (long) meshVertices[i] * meshStride[i] +
+				(long) meshIndices[i] * meshBuffers[i]->indexSize;
+		} else if( meshStride[i] > 0 ) {
+			sets += 1;
+			cout << "                " << meshStride[i]
+				 << " bytes/vertex, packing error: position "
+				 << meshPackError[i].position << ", normal "
+				 << meshPackError[i].normal << " deg, uv "
+				 << meshPackError[i].uv << endl;
+		}
+		cout.unsetf( ios::fixed );
+		indices += meshIndices[i];
+		vertices += meshVertices[i];
+	}
+	if( indices > 0 ) {
+		cout << "  total " << vertices << " of " << indices
+			 << " vertices kept, dedup ratio " << fixed << setprecision(2)
+			 << ((double) indices / vertices) << ":1" << endl;
+		cout.unsetf( ios::fixed );
+		cout << "  " << objs << " objects drawn from " << sets
+			 << " sets of buffers; sharing saved " << saved << " bytes"
+			 << endl;
+	}
 }
@@ -15,6 +15,9 @@
 
 #include "Buffers.h"
 #include "Canvas.h"
+#include "Culling.h"
+#include "Meshlets.h"
+#include "Shapes.h"
 
 //
 // Object selection
@@ -37,6 +40,31 @@ typedef
 // for the Testing module
 #define N_POLYS    N_OBJECTS
 
+//
+// Level of detail selection:  the most error (pixels) a level may show
+// on the screen, and the fraction of that a coarser level's error must
+// be under before an object is switched to it
+//
+#define LOD_PIXELS        1.0f
+#define LOD_HYSTERESIS    0.5f
+
+//
+// Slices around the control cage the cylinder bodies are tessellated
+// from on the GPU (each slice is one quad patch)
+//
+#define CAGE_SLICES       8
+
+///
+/// What building a set of objects cost
+///
+typedef struct st_buildstats {
+	int threads;              // worker threads used (0: built serially)
+	size_t peakBytes;         // peak Canvas storage, summed over Canvases
+	size_t reserved;          // Canvas storage held afterward
+	long allocations;         // allocations from the Canvas arenas
+	long chunkAllocations;    // allocations from the system
+} BuildStats;
+
 //
 // PUBLIC GLOBALS
 //
@@ -57,4 +85,104 @@ extern const char *objects[ N_OBJECTS ];
 ///
 void createObject( Canvas &C, Object obj, BufferSet &buf );
 
+///
+/// Create several objects, generating their meshes in parallel on
+/// worker threads; their buffers are created on this thread
+///
+/// @param C      the Canvas to use on this thread
+/// @param objs   the objects to create (each at most once)
+/// @param n      how many there are
+/// @param bufs   BufferSets for all objects, indexed by Object
+/// @param stats  if not NULL, receives what building them cost
+///
+void createObjects( Canvas &C, const Object *objs, int n,
+	BufferSet *bufs, BuildStats *stats = nullptr );
+
+///
+/// Get the buffers to draw an object with; objects whose meshes are
+/// identical share the buffers of the first one created
+///
+/// @param obj    which object
+///
+/// @return the object's buffers, or NULL if it hasn't been created
+///
+BufferSet *getBuffers( Object obj );
+
+///
+/// Get the meshlets of an object's full mesh, found when it was built
+///
+/// @param obj    which object
+///
+/// @return its meshlets (none if it isn't indexed)
+///
+const MeshletSet &getMeshlets( Object obj );
+
+///
+/// Get the bounds of an object's mesh, found when it was built
+///
+/// @param obj    which object
+///
+/// @return its bounding box and sphere, in model coordinates
+///
+const Bounds &getBounds( Object obj );
+
+///
+/// Get a box lying entirely inside an object's mesh, for use as an
+/// occluder
+///
+/// @param obj    which object
+/// @param box    receives the box, in model coordinates
+///
+/// @return false if the object is not solid enough to have one
+///
+bool getOccluder( Object obj, Bounds &box );
+
+///
+/// Choose the level of detail to draw an object at
+///
+/// @param obj       which object
+/// @param pixels    pixels covered by one unit of model coordinates at
+///                  the object's distance
+/// @param current   the level it was last drawn at (-1 if none)
+///
+/// @return the level to draw it at
+///
+int selectLOD( Object obj, float pixels, int current );
+
+///
+/// Create the control cage the cylinder bodies are tessellated from
+/// on the GPU:  a coarse ring of quad patches, whose texture
+/// coordinates give each corner's place on the cylinder
+///
+/// @param C      the Canvas to build it in
+/// @param buf    BufferSet to use for it
+///
+void createCage( Canvas &C, BufferSet &buf );
+
+///
+/// Is an object drawn from the control cage when the GPU is
+/// tessellating the cylinders?
+///
+/// @param obj    which object
+///
+/// @return true for the cylinder bodies
+///
+bool usesCage( Object obj );
+
+///
+/// Set the tessellation of a generated shape; objects created
+/// afterward use it
+///
+/// @param shape  which shape
+/// @param tess   its tessellation (see Shapes.h)
+///
+void setTessellation( Shape shape, int tess );
+
+///
+/// Print the vertex and index counts for each object, how much
+/// welding reduced the vertex count, and how much optimization
+/// reduced the ACMR (vertices transformed per triangle)
+///
+void printMeshStats( void );
+
 #endif
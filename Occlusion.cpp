@@ -0,0 +1,563 @@
+//
+//  Occlusion.cpp
+//
+//  Occlusion culling with hardware queries and a depth pyramid.
+//
+
+#include <algorithm>
+#include <iostream>
+
+#include "Buffers.h"
+#include "Occlusion.h"
+
+//
+// PRIVATE GLOBALS
+//
+
+// proxy boxes are made this much larger (relative, then absolute) so
+// that they aren't hidden by the very faces they enclose
+#define OCC_GROW_REL    0.01f
+#define OCC_GROW_ABS    0.001f
+
+// the faces of the unit box, as corner numbers (bit 0 set for +X,
+// bit 1 for +Y, bit 2 for +Z), a quad per face
+static const int boxFaces[6][4] = {
+	{ 0, 2, 3, 1 }, { 4, 5, 7, 6 },     // -Z, +Z
+	{ 0, 1, 5, 4 }, { 2, 6, 7, 3 },     // -Y, +Y
+	{ 0, 4, 6, 2 }, { 1, 3, 7, 5 }      // -X, +X
+};
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Constructor
+///
+OcclusionCuller::OcclusionCuller( void ) : cursor(0), program(0),
+	centerLoc(-1), extentLoc(-1), vao(0), vbuffer(0),
+	target(GL_SAMPLES_PASSED), pyramidValid(false), serial(0),
+	useHiZ(true), lastProjView(1.0f), settle(0), queried(0), queryCulled(0), hizCulled(0), conditional(0) {
+
+	for( int s = 0; s < OCC_READBACKS; ++s ) {
+		pbuffers[s] = 0;
+		fences[s] = 0;
+		readWidth[s] = readHeight[s] = 0;
+		bufWidth[s] = bufHeight[s] = 0;
+		readSerial[s] = 0;
+	}
+}
+
+///
+/// init(proxy) - create the GL objects needed
+///
+/// @param proxy   the proxy box program (already bound to the
+///                FrameData block)
+///
+/// @return true if occlusion culling can be used
+///
+bool OcclusionCuller::init( GLuint proxy ) {
+
+	if( !(GLEW_VERSION_3_2 || GLEW_ARB_sync) ) {
+		return( false );
+	}
+
+	program = proxy;
+	centerLoc = glGetUniformLocation( program, "boxCenter" );
+	extentLoc = glGetUniformLocation( program, "boxExtent" );
+	GLint posLoc = glGetAttribLocation( program, "vPosition" );
+	if( centerLoc < 0 || extentLoc < 0 || posLoc < 0 ) {
+		cerr << "OcclusionCuller: proxy program is missing its inputs" << endl;
+		return( false );
+	}
+
+	// an "any samples" query can stop counting at the first one
+	if( GLEW_VERSION_3_3 || GLEW_ARB_occlusion_query2 ) {
+		target = GL_ANY_SAMPLES_PASSED;
+	}
+
+	// the unit box, as separate triangles
+	float verts[6 * 6 * 3];
+	int n = 0;
+	for( int f = 0; f < 6; ++f ) {
+		static const int tri[6] = { 0, 1, 2, 0, 2, 3 };
+		for( int k = 0; k < 6; ++k ) {
+			int c = boxFaces[f][tri[k]];
+			verts[n++] = (c & 1) ? 1.0f : -1.0f;
+			verts[n++] = (c & 2) ? 1.0f : -1.0f;
+			verts[n++] = (c & 4) ? 1.0f : -1.0f;
+		}
+	}
+
+	// keep whatever VAO the application has bound
+	GLint prev;
+	glGetIntegerv( GL_VERTEX_ARRAY_BINDING, &prev );
+
+	glGenVertexArrays( 1, &vao );
+	glBindVertexArray( vao );
+	glGenBuffers( 1, &vbuffer );
+	glBindBuffer( GL_ARRAY_BUFFER, vbuffer );
+	glBufferData( GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW );
+	glEnableVertexAttribArray( posLoc );
+	glVertexAttribPointer( posLoc, 3, GL_FLOAT, GL_FALSE, 0,
+		BUFFER_OFFSET(0) );
+
+	glBindVertexArray( prev );
+
+	glGenBuffers( OCC_READBACKS, pbuffers );
+
+	return( true );
+}
+
+///
+/// begin(n) - start a frame:  collect the query results and depth
+///     readbacks that have finished
+///
+/// @param n   number of objects in this frame's CullSet
+///
+void OcclusionCuller::begin( size_t n ) {
+
+	// a different set of objects; what we knew no longer applies
+	if( n != queries.size() ) {
+		reset();
+		queries.resize( n, 0 );
+		pending.resize( n, 0 );
+		occluded.resize( n, 0 );
+	}
+
+	// pick up whichever query results have arrived; if any changes
+	// what we knew, the frames after this one must show it
+	bool changed = false;
+	for( size_t i = 0; i < n; ++i ) {
+		if( !pending[i] ) {
+			continue;
+		}
+		GLuint ready = GL_FALSE;
+		glGetQueryObjectuiv( queries[i], GL_QUERY_RESULT_AVAILABLE, &ready );
+		if( ready ) {
+			GLuint samples = 0;
+			glGetQueryObjectuiv( queries[i], GL_QUERY_RESULT, &samples );
+			changed = changed || occluded[i] != (samples == 0);
+			occluded[i] = samples == 0;
+			pending[i] = 0;
+		}
+	}
+
+	collectReadbacks();
+
+	if( changed ) {
+		settle = OCC_SETTLE_FRAMES;
+	} else if( settle > 0 ) {
+		settle -= 1;
+	}
+
+	queried = queryCulled = hizCulled = conditional = 0;
+}
+
+///
+/// test(set,i,projView,query) - decide whether an object should
+///     be drawn
+///
+/// @param set       this frame's CullSet
+/// @param i         the object's position in it
+/// @param projView  the projection matrix times the view matrix
+/// @param query     receives the query to draw it conditionally on
+///
+/// @return what to do with the object
+///
+OccResult OcclusionCuller::test( const CullSet &set, size_t i,
+	const glm::mat4 &projView, GLuint &query ) {
+
+	query = 0;
+
+	if( hizHidden( set, i, projView ) ) {
+		hizCulled += 1;
+		return( OCC_HIDDEN );
+	}
+
+	if( i < occluded.size() && occluded[i] ) {
+		// a newer answer is on its way; let the GPU use it
+		if( pending[i] ) {
+			query = queries[i];
+			conditional += 1;
+			return( OCC_CONDITIONAL );
+		}
+		queryCulled += 1;
+		return( OCC_HIDDEN );
+	}
+
+	return( OCC_VISIBLE );
+}
+
+///
+/// end(set,candidates,projView,width,height) - finish a frame:
+///     issue the queries for it and start a depth readback
+///
+/// Must be called after the frame's objects have been drawn.
+///
+/// @param set         this frame's CullSet
+/// @param candidates  for each object, nonzero if it survived
+///                    frustum culling (NULL if none were culled)
+/// @param projView    the projection matrix times the view matrix
+/// @param width       framebuffer width
+/// @param height      framebuffer height
+///
+void OcclusionCuller::end( const CullSet &set, const unsigned char *candidates,
+	const glm::mat4 &projView, int width, int height ) {
+	size_t n = std::min( queries.size(), (size_t) set.count );
+	long budget = OCC_QUERY_BUDGET;
+
+	// the boxes must be tested against the depth buffer, not drawn
+	glUseProgram( program );
+	glBindVertexArray( vao );
+	glColorMask( GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE );
+	glDepthMask( GL_FALSE );
+
+	// first, everything hidden, so it can reappear as soon as it should;
+	// anything outside the frustum starts over as visible when it returns
+	for( size_t i = 0; i < n; ++i ) {
+		if( candidates != nullptr && !candidates[i] ) {
+			if( !pending[i] ) {
+				occluded[i] = 0;
+			}
+		} else if( occluded[i] && !pending[i] && budget > 0 ) {
+			budget -= issue( set, i, projView );
+		}
+	}
+
+	// then the visible objects take turns
+	size_t start = cursor;
+	for( size_t k = 0; k < n && budget > 0; ++k ) {
+		size_t i = (start + k) % n;
+		if( !occluded[i] && !pending[i] &&
+			(candidates == nullptr || candidates[i]) ) {
+			budget -= issue( set, i, projView );
+			cursor = i + 1;
+		}
+	}
+
+	glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
+	glDepthMask( GL_TRUE );
+
+	if( useHiZ ) {
+		startReadback( projView, width, height );
+	}
+
+	// a new view needs new results
+	if( projView != lastProjView ) {
+		lastProjView = projView;
+		settle = OCC_SETTLE_FRAMES;
+	}
+}
+
+///
+/// reset() - forget everything learned about the objects
+///
+void OcclusionCuller::reset( void ) {
+
+	for( size_t i = 0; i < queries.size(); ++i ) {
+		if( queries[i] != 0 ) {
+			glDeleteQueries( 1, &queries[i] );
+		}
+	}
+	queries.clear();
+	pending.clear();
+	occluded.clear();
+	cursor = 0;
+
+	// depth read back before now shows what we have forgotten
+	for( int s = 0; s < OCC_READBACKS; ++s ) {
+		if( fences[s] != 0 ) {
+			glDeleteSync( fences[s] );
+			fences[s] = 0;
+		}
+	}
+	pyramidValid = false;
+
+	settle = OCC_SETTLE_FRAMES;
+}
+
+///
+/// settling() - determine whether another frame must be drawn to
+///     use results that are still on their way
+///
+/// @return true if the scene should be drawn again
+///
+bool OcclusionCuller::settling( void ) const {
+	return( settle > 0 );
+}
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// crossesEye(set,i,projView,lo,hi,zmin) - find an object's box on
+///     the screen
+///
+/// @param set       this frame's CullSet
+/// @param i         the object's position in it
+/// @param projView  the projection matrix times the view matrix
+/// @param lo        receives the lower left corner (NDC)
+/// @param hi        receives the upper right corner (NDC)
+/// @param zmin      receives the nearest depth (window coordinates)
+///
+/// @return true if the box reaches the eye plane (so none of
+///         that is meaningful)
+///
+bool OcclusionCuller::crossesEye( const CullSet &set, size_t i,
+	const glm::mat4 &projView, glm::vec2 &lo, glm::vec2 &hi, float &zmin ) {
+
+	// the corners are the center plus or minus each edge's half
+	glm::vec4 c = projView *
+		glm::vec4( set.cx[i], set.cy[i], set.cz[i], 1.0f );
+	glm::vec4 ax = projView[0] * set.ex[i];
+	glm::vec4 ay = projView[1] * set.ey[i];
+	glm::vec4 az = projView[2] * set.ez[i];
+
+	lo = glm::vec2( 1.0e30f );
+	hi = glm::vec2( -1.0e30f );
+	zmin = 1.0f;
+
+	for( int k = 0; k < 8; ++k ) {
+		glm::vec4 v = c + ((k & 1) ? ax : ax * -1.0f)
+						+ ((k & 2) ? ay : ay * -1.0f)
+						+ ((k & 4) ? az : az * -1.0f);
+
+		// behind the eye, or in front of the near plane
+		if( v.w <= 0.0f || v.z < -v.w ) {
+			return( true );
+		}
+
+		float x = v.x / v.w, y = v.y / v.w, z = v.z / v.w;
+		lo.x = std::min( lo.x, x );
+		lo.y = std::min( lo.y, y );
+		hi.x = std::max( hi.x, x );
+		hi.y = std::max( hi.y, y );
+		zmin = std::min( zmin, z * 0.5f + 0.5f );
+	}
+
+	return( false );
+}
+
+///
+/// hizHidden(set,i,projView) - test an object against the pyramid
+///
+/// @param set       this frame's CullSet
+/// @param i         the object's position in it
+/// @param projView  the projection matrix times the view matrix
+///
+/// @return true if the object is certainly hidden
+///
+bool OcclusionCuller::hizHidden( const CullSet &set, size_t i,
+	const glm::mat4 &projView ) {
+	glm::vec2 lo, hi;
+	float zmin;
+
+	if( !useHiZ || !pyramidValid || projView != pyramidProjView ) {
+		return( false );
+	}
+
+	if( crossesEye( set, i, projView, lo, hi, zmin ) ) {
+		return( false );
+	}
+
+	// off the screen is for the frustum test to decide
+	if( hi.x < -1.0f || lo.x > 1.0f || hi.y < -1.0f || lo.y > 1.0f ) {
+		return( false );
+	}
+
+	// the covered pixels of level 0
+	int w = levelWidth[0], h = levelHeight[0];
+	int x0 = std::max( 0, (int) ((lo.x * 0.5f + 0.5f) * w) );
+	int x1 = std::min( w - 1, (int) ((hi.x * 0.5f + 0.5f) * w) );
+	int y0 = std::max( 0, (int) ((lo.y * 0.5f + 0.5f) * h) );
+	int y1 = std::min( h - 1, (int) ((hi.y * 0.5f + 0.5f) * h) );
+
+	// go up until the rectangle covers at most three texels each way
+	int span = std::max( x1 - x0, y1 - y0 );
+	size_t level = 0;
+	while( (span >> level) > 1 && level + 1 < levels.size() ) {
+		++level;
+	}
+
+	const vector<float> &depth = levels[level];
+	int lw = levelWidth[level];
+	float farthest = 0.0f;
+	for( int y = y0 >> level; y <= (y1 >> level); ++y ) {
+		for( int x = x0 >> level; x <= (x1 >> level); ++x ) {
+			farthest = std::max( farthest, depth[y * lw + x] );
+		}
+	}
+
+	return( zmin > farthest );
+}
+
+///
+/// buildPyramid(depth,w,h) - build the pyramid from a depth buffer
+///
+/// @param depth   the depth values, a row at a time from the bottom
+/// @param w       width
+/// @param h       height
+///
+void OcclusionCuller::buildPyramid( const float *depth, int w, int h ) {
+
+	levels.resize( 1 );
+	levelWidth.assign( 1, w );
+	levelHeight.assign( 1, h );
+	levels[0].assign( depth, depth + (size_t) w * h );
+
+	// each texel holds the farthest of the (up to) four below it;
+	// on an odd edge, the last one also covers the extra row/column
+	while( w > 1 || h > 1 ) {
+		int nw = std::max( 1, (w + 1) / 2 );
+		int nh = std::max( 1, (h + 1) / 2 );
+		const vector<float> &src = levels.back();
+		vector<float> dst( (size_t) nw * nh );
+
+		for( int y = 0; y < nh; ++y ) {
+			int ya = 2 * y, yb = std::min( 2 * y + 1, h - 1 );
+			for( int x = 0; x < nw; ++x ) {
+				int xa = 2 * x, xb = std::min( 2 * x + 1, w - 1 );
+				dst[y * nw + x] = std::max(
+					std::max( src[ya * w + xa], src[ya * w + xb] ),
+					std::max( src[yb * w + xa], src[yb * w + xb] ) );
+			}
+		}
+
+		levels.push_back( dst );
+		levelWidth.push_back( nw );
+		levelHeight.push_back( nh );
+		w = nw;
+		h = nh;
+	}
+}
+
+///
+/// collectReadbacks() - build the pyramid from the newest finished
+///     depth readback
+///
+void OcclusionCuller::collectReadbacks( void ) {
+	int newest = -1;
+
+	for( int s = 0; s < OCC_READBACKS; ++s ) {
+		if( fences[s] == 0 ) {
+			continue;
+		}
+		// poll; never wait
+		GLenum status = glClientWaitSync( fences[s], 0, 0 );
+		if( status == GL_ALREADY_SIGNALED ||
+			status == GL_CONDITION_SATISFIED ) {
+			if( newest < 0 || readSerial[s] > readSerial[newest] ) {
+				newest = s;
+			}
+		}
+	}
+
+	if( newest < 0 ) {
+		return;
+	}
+
+	GLsizeiptr size = (GLsizeiptr) readWidth[newest] * readHeight[newest] *
+		sizeof(float);
+	glBindBuffer( GL_PIXEL_PACK_BUFFER, pbuffers[newest] );
+	const float *depth = (const float *) glMapBufferRange(
+		GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT );
+	if( depth != nullptr ) {
+		buildPyramid( depth, readWidth[newest], readHeight[newest] );
+		pyramidProjView = readProjView[newest];
+		pyramidValid = true;
+		glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+	}
+	glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+	// anything older than that is no use now
+	for( int s = 0; s < OCC_READBACKS; ++s ) {
+		if( fences[s] != 0 && readSerial[s] <= readSerial[newest] ) {
+			glDeleteSync( fences[s] );
+			fences[s] = 0;
+		}
+	}
+}
+
+///
+/// startReadback(projView,width,height) - begin reading the depth
+///     buffer, if a pixel buffer is free
+///
+/// @param projView  the projection matrix times the view matrix
+/// @param width     framebuffer width
+/// @param height    framebuffer height
+///
+void OcclusionCuller::startReadback( const glm::mat4 &projView,
+	int width, int height ) {
+	int s = 0;
+
+	while( s < OCC_READBACKS && fences[s] != 0 ) {
+		++s;
+	}
+	if( s == OCC_READBACKS || width < 1 || height < 1 ) {
+		return;
+	}
+
+	glBindBuffer( GL_PIXEL_PACK_BUFFER, pbuffers[s] );
+	if( bufWidth[s] != width || bufHeight[s] != height ) {
+		glBufferData( GL_PIXEL_PACK_BUFFER,
+			(GLsizeiptr) width * height * sizeof(float), NULL, GL_STREAM_READ );
+		bufWidth[s] = width;
+		bufHeight[s] = height;
+	}
+
+	// with a pack buffer bound, this returns without waiting
+	glReadPixels( 0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT,
+		BUFFER_OFFSET(0) );
+	glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+	fences[s] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+	readProjView[s] = projView;
+	readWidth[s] = width;
+	readHeight[s] = height;
+	readSerial[s] = ++serial;
+}
+
+///
+/// issue(set,i,projView) - draw an object's box inside its query
+///
+/// Boxes that reach the eye plane would be clipped, and could then
+/// fail to pass even though the object is in plain view, so those
+/// objects are simply treated as visible.
+///
+/// @param set       this frame's CullSet
+/// @param i         the object's position in it
+/// @param projView  the projection matrix times the view matrix
+///
+/// @return true if a query was issued
+///
+bool OcclusionCuller::issue( const CullSet &set, size_t i,
+	const glm::mat4 &projView ) {
+	glm::vec2 lo, hi;
+	float zmin;
+
+	if( crossesEye( set, i, projView, lo, hi, zmin ) ) {
+		occluded[i] = 0;
+		return( false );
+	}
+
+	if( queries[i] == 0 ) {
+		glGenQueries( 1, &queries[i] );
+	}
+
+	glUniform3f( centerLoc, set.cx[i], set.cy[i], set.cz[i] );
+	glUniform3f( extentLoc,
+		set.ex[i] * (1.0f + OCC_GROW_REL) + OCC_GROW_ABS,
+		set.ey[i] * (1.0f + OCC_GROW_REL) + OCC_GROW_ABS,
+		set.ez[i] * (1.0f + OCC_GROW_REL) + OCC_GROW_ABS );
+
+	glBeginQuery( target, queries[i] );
+	glDrawArrays( GL_TRIANGLES, 0, 36 );
+	glEndQuery( target );
+
+	pending[i] = 1;
+	queried += 1;
+
+	return( true );
+}
@@ -0,0 +1,268 @@
+//
+//  Occlusion.h
+//
+//  Occlusion culling:  skipping objects hidden behind other objects.
+//
+//  Two tests are used, both based on what earlier frames drew, so that
+//  neither ever makes the CPU wait for the GPU:
+//
+//    - Hardware occlusion queries.  After a frame is drawn, the world
+//      space bounding boxes of (some of) its objects are drawn with
+//      color and depth writes off, each inside an occlusion query.
+//      The results are collected in later frames, once they are
+//      available; an object whose box produced no samples is hidden.
+//      Hidden objects are queried again every frame so that they
+//      reappear promptly, and the rest take turns within a budget.
+//      A hidden object whose newest query is still in flight is drawn
+//      under conditional rendering, so the GPU (which has the result
+//      by then) decides whether it is drawn.
+//
+//    - A hierarchical depth ("Hi-Z") pyramid.  The depth buffer is
+//      read back into a pixel buffer object without waiting; when a
+//      fence shows that a readback has finished, the farthest depth
+//      in each 2x2 block is taken level by level to build the pyramid.
+//      An object whose box is entirely behind the farthest depth
+//      covering its screen rectangle is hidden.  The pyramid is only
+//      used while the projection and view it was made with are still
+//      current.
+//
+//  Objects are identified by their position in the frame's CullSet,
+//  whose world-space bounds are used for both tests; the state kept
+//  for each object is discarded whenever the number of objects changes.
+//
+//  Requires OpenGL 3.2 (or ARB_sync) for fences, and a proxy program
+//  that uses the shared FrameData block.
+//
+
+#ifndef OCCLUSION_H_
+#define OCCLUSION_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Culling.h"
+
+using namespace std;
+
+//
+// Most occlusion queries issued per frame
+//
+#define OCC_QUERY_BUDGET    2048
+
+//
+// Depth readbacks that may be in flight at once
+//
+#define OCC_READBACKS       2
+
+//
+// Frames drawn after anything changes, so that the queries and
+// readbacks they issue are collected and used
+//
+#define OCC_SETTLE_FRAMES   (OCC_READBACKS + 2)
+
+//
+// What the occlusion tests decided about an object
+//
+typedef enum occ_e {
+	OCC_VISIBLE = 0,     // draw it
+	OCC_HIDDEN,          // skip it
+	OCC_CONDITIONAL      // draw it, conditional on its query
+} OccResult;
+
+class OcclusionCuller {
+
+public:
+	// state for each object in the CullSet
+	vector<GLuint> queries;        // its query object (0 if none yet)
+	vector<char> pending;          // query issued, result not yet read
+	vector<char> occluded;         // its last result showed no samples
+
+	// where the next turn at querying visible objects begins
+	size_t cursor;
+
+	// the proxy box program, and what it draws with
+	GLuint program;
+	GLint centerLoc, extentLoc;
+	GLuint vao, vbuffer;
+
+	// query target (GL_ANY_SAMPLES_PASSED if available)
+	GLenum target;
+
+	// the depth pyramid:  level 0 is the full depth buffer
+	vector< vector<float> > levels;
+	vector<int> levelWidth, levelHeight;
+	glm::mat4 pyramidProjView;
+	bool pyramidValid;
+
+	// depth readbacks in flight (a fence of 0 marks a free slot),
+	// each with the view it was drawn with and the size of its buffer
+	GLuint pbuffers[OCC_READBACKS];
+	GLsync fences[OCC_READBACKS];
+	glm::mat4 readProjView[OCC_READBACKS];
+	int readWidth[OCC_READBACKS], readHeight[OCC_READBACKS];
+	int bufWidth[OCC_READBACKS], bufHeight[OCC_READBACKS];
+	unsigned long readSerial[OCC_READBACKS], serial;
+
+	// use the depth pyramid?
+	bool useHiZ;
+
+	// the view the last frame was drawn with, and how many more frames
+	// must be drawn before its results have all been used
+	glm::mat4 lastProjView;
+	int settle;
+
+	// what happened this frame
+	long queried;          // queries issued
+	long queryCulled;      // objects skipped because of query results
+	long hizCulled;        // objects skipped because of the pyramid
+	long conditional;      // objects drawn conditionally
+
+public:
+
+	///
+	/// Constructor
+	///
+	OcclusionCuller( void );
+
+	///
+	/// init(proxy) - create the GL objects needed
+	///
+	/// @param proxy   the proxy box program (already bound to the
+	///                FrameData block)
+	///
+	/// @return true if occlusion culling can be used
+	///
+	bool init( GLuint proxy );
+
+	///
+	/// begin(n) - start a frame:  collect the query results and depth
+	///     readbacks that have finished
+	///
+	/// @param n   number of objects in this frame's CullSet
+	///
+	void begin( size_t n );
+
+	///
+	/// test(set,i,projView,query) - decide whether an object should
+	///     be drawn
+	///
+	/// @param set       this frame's CullSet
+	/// @param i         the object's position in it
+	/// @param projView  the projection matrix times the view matrix
+	/// @param query     receives the query to draw it conditionally on
+	///
+	/// @return what to do with the object
+	///
+	OccResult test( const CullSet &set, size_t i,
+		const glm::mat4 &projView, GLuint &query );
+
+	///
+	/// end(set,candidates,projView,width,height) - finish a frame:
+	///     issue the queries for it and start a depth readback
+	///
+	/// Must be called after the frame's objects have been drawn.
+	///
+	/// @param set         this frame's CullSet
+	/// @param candidates  for each object, nonzero if it survived
+	///                    frustum culling (NULL if none were culled)
+	/// @param projView    the projection matrix times the view matrix
+	/// @param width       framebuffer width
+	/// @param height      framebuffer height
+	///
+	void end( const CullSet &set, const unsigned char *candidates,
+		const glm::mat4 &projView, int width, int height );
+
+	///
+	/// reset() - forget everything learned about the objects
+	///
+	/// Results still in flight are dropped, so that they can't be
+	/// applied to a different set of objects.
+	///
+	void reset( void );
+
+	///
+	/// settling() - determine whether another frame must be drawn to
+	///     use results that are still on their way
+	///
+	/// @return true if the scene should be drawn again
+	///
+	bool settling( void ) const;
+
+private:
+
+	///
+	/// crossesEye(set,i,projView,lo,hi,zmin) - find an object's box on
+	///     the screen
+	///
+	/// @param set       this frame's CullSet
+	/// @param i         the object's position in it
+	/// @param projView  the projection matrix times the view matrix
+	/// @param lo        receives the lower left corner (NDC)
+	/// @param hi        receives the upper right corner (NDC)
+	/// @param zmin      receives the nearest depth (window coordinates)
+	///
+	/// @return true if the box reaches the eye plane (so none of
+	///         that is meaningful)
+	///
+	bool crossesEye( const CullSet &set, size_t i, const glm::mat4 &projView,
+		glm::vec2 &lo, glm::vec2 &hi, float &zmin );
+
+	///
+	/// hizHidden(set,i,projView) - test an object against the pyramid
+	///
+	/// @param set       this frame's CullSet
+	/// @param i         the object's position in it
+	/// @param projView  the projection matrix times the view matrix
+	///
+	/// @return true if the object is certainly hidden
+	///
+	bool hizHidden( const CullSet &set, size_t i, const glm::mat4 &projView );
+
+	///
+	/// buildPyramid(depth,w,h) - build the pyramid from a depth buffer
+	///
+	/// @param depth   the depth values, a row at a time from the bottom
+	/// @param w       width
+	/// @param h       height
+	///
+	void buildPyramid( const float *depth, int w, int h );
+
+	///
+	/// collectReadbacks() - build the pyramid from the newest finished
+	///     depth readback
+	///
+	void collectReadbacks( void );
+
+	///
+	/// startReadback(projView,width,height) - begin reading the depth
+	///     buffer, if a pixel buffer is free
+	///
+	/// @param projView  the projection matrix times the view matrix
+	/// @param width     framebuffer width
+	/// @param height    framebuffer height
+	///
+	void startReadback( const glm::mat4 &projView, int width, int height );
+
+	///
+	/// issue(set,i,projView) - draw an object's box inside its query
+	///
+	/// @param set       this frame's CullSet
+	/// @param i         the object's position in it
+	/// @param projView  the projection matrix times the view matrix
+	///
+	/// @return true if a query was issued
+	///
+	bool issue( const CullSet &set, size_t i, const glm::mat4 &projView );
+
+};
+
+#endif
@@ -0,0 +1,229 @@
+//
+//  RenderQueue.cpp
+//
+//  Collection and ordering of the draw calls for a frame.
+//
+//  Sort key layout (most significant bits first):
+//
+//      bits 63-56   shader program (its slot in this frame)
+//      bits 55-48   texture (its slot in this frame)
+//      bits 47-40   material (its slot in this frame)
+//      bits 39-8    depth (the IEEE float's bits)
+//      bits 7-0     unused
+//
+//  Non-negative IEEE floats order the same way as their bit patterns,
+//  so the depth can be used directly for a front-to-back ordering
+//  without knowing the depth range.  Packets with equal keys keep the
+//  order they were added in, since the sort is stable.
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include "RenderQueue.h"
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// slotOf(slots,value) - find the slot of a program, texture, or
+///     material in this frame's list, adding it if it is new
+///
+/// @param slots   the values seen so far this frame
+/// @param value   the one to look up
+///
+/// @return its slot (the last one if the list is full)
+///
+template <typename T>
+static uint64_t slotOf( vector<T> &slots, T value ) {
+
+	// there are only a handful of each per frame
+	for( size_t i = 0; i < slots.size(); ++i ) {
+		if( slots[i] == value ) {
+			return( (uint64_t) i );
+		}
+	}
+
+	if( slots.size() < RQ_STATES ) {
+		slots.push_back( value );
+		return( (uint64_t) slots.size() - 1 );
+	}
+
+	return( (uint64_t) RQ_STATES - 1 );
+}
+
+///
+/// sameState(a,b) - determine whether two packets draw with the same
+///     program, texture, and material
+///
+/// @param a   one packet
+/// @param b   the other
+///
+/// @return true if they do
+///
+static bool sameState( const DrawPacket &a, const DrawPacket &b ) {
+	return( a.program == b.program && a.texture == b.texture &&
+			a.material == b.material );
+}
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Constructor
+///
+RenderQueue::RenderQueue( void ) {
+	clear();
+}
+
+///
+/// clear() - empty the queue at the start of a frame
+///
+void RenderQueue::clear( void ) {
+	packets.clear();
+	batches.clear();
+	programSlots.clear();
+	textureSlots.clear();
+	materialSlots.clear();
+	programChanges = textureChanges = changesAvoided = 0;
+}
+
+///
+/// add() - add a draw packet to the queue
+///
+/// @param program   shader program to draw with
+/// @param material  material ID of the object
+/// @param texture   texture used by that material
+/// @param obj       which object
+/// @param buf       the object's buffers
+/// @param model     the object's model transformation
+/// @param depth     distance from the eye along the view axis
+/// @param query     occlusion query to draw it conditionally on
+///                  (0 to draw it unconditionally)
+/// @param lod       level of detail to draw it at
+///
+void RenderQueue::add( GLuint program, int material, GLuint texture,
+		Object obj, BufferSet *buf, const glm::mat4 &model, float depth,
+		GLuint query, int lod ) {
+	DrawPacket p;
+
+	// anything behind the eye sorts as if it were at the eye
+	if( !(depth > 0.0f) ) {
+		depth = 0.0f;
+	}
+
+	uint32_t dbits;
+	memcpy( &dbits, &depth, sizeof(dbits) );
+
+	p.key = (slotOf( programSlots, program ) << 56)
+		  | (slotOf( textureSlots, texture ) << 48)
+		  | (slotOf( materialSlots, material ) << 40)
+		  | ((uint64_t) dbits << 8);
+
+	p.program = program;
+	p.material = material;
+	p.texture = texture;
+	p.obj = obj;
+	p.buf = buf;
+	p.model = model;
+	p.depth = depth;
+	p.query = query;
+	p.lod = lod;
+	p.meshlets = -1;
+
+	packets.push_back( p );
+}
+
+///
+/// countChanges() - count the program and texture switches needed
+///     to draw the packets in their current order
+///
+/// @param progs   receives the number of program switches
+/// @param texs    receives the number of texture switches
+///
+void RenderQueue::countChanges( unsigned long &progs, unsigned long &texs ) {
+	progs = texs = 0;
+
+	for( size_t i = 0; i < packets.size(); ++i ) {
+		if( i == 0 || packets[i].program != packets[i-1].program ) {
+			progs += 1;
+		}
+		if( i == 0 || packets[i].texture != packets[i-1].texture ) {
+			texs += 1;
+		}
+	}
+}
+
+///
+/// sort() - order the packets by their keys, and update the
+///     state change counters
+///
+void RenderQueue::sort( void ) {
+	unsigned long progs, texs;
+
+	// what would drawing them as submitted have cost?
+	countChanges( progs, texs );
+
+	std::stable_sort( packets.begin(), packets.end(),
+		[]( const DrawPacket &a, const DrawPacket &b ) {
+			return( a.key < b.key );
+		} );
+
+	countChanges( programChanges, textureChanges );
+	if( progs + texs > programChanges + textureChanges ) {
+		changesAvoided = (progs + texs) - (programChanges + textureChanges);
+	} else {
+		changesAvoided = 0;
+	}
+}
+
+///
+/// batch() - gather the sorted packets into batches that share a
+///     program, texture, material, set of buffers, and level of
+///     detail, so that each batch can be drawn with one instanced
+///     draw call
+///
+/// Within a batch, the packets keep their front-to-back order.
+/// A packet drawn conditionally is always a batch by itself, as is
+/// one whose meshlets are culled.
+///
+void RenderQueue::batch( void ) {
+	size_t n = packets.size();
+
+	batches.clear();
+
+	// sort() has brought the packets with the same program, texture,
+	// and material together; within each such run, bring the packets
+	// using the same buffers at the same level of detail together
+	for( size_t i = 0; i < n; ) {
+		size_t j = i + 1;
+		while( j < n && sameState( packets[j], packets[i] ) ) {
+			++j;
+		}
+
+		std::stable_sort( packets.begin() + i, packets.begin() + j,
+			[]( const DrawPacket &a, const DrawPacket &b ) {
+				return( a.buf < b.buf || (a.buf == b.buf && a.lod < b.lod) );
+			} );
+
+		for( size_t k = i; k < j; ) {
+			DrawBatch b;
+			b.first = k;
+			if( packets[k].query != 0 || packets[k].meshlets >= 0 ) {
+				++k;
+			} else {
+				while( ++k < j && packets[k].buf == packets[b.first].buf &&
+					   packets[k].lod == packets[b.first].lod &&
+					   packets[k].query == 0 && packets[k].meshlets < 0 ) {
+					;
+				}
+			}
+			b.count = k - b.first;
+			batches.push_back( b );
+		}
+
+		i = j;
+	}
+}
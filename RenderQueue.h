@@ -0,0 +1,158 @@
+//
+//  RenderQueue.h
+//
+//  Collection and ordering of the draw calls for a frame.
+//
+//  Rather than drawing objects in the order they happen to be listed,
+//  display() adds a draw packet for each one to a RenderQueue, sorts
+//  the queue, and then walks it.  The sort key is packed so that
+//  packets using the same shader program are adjacent, within those
+//  packets using the same texture and material are adjacent, and
+//  within those the nearest objects come first; that keeps program
+//  and texture switches to a minimum and lets early depth testing
+//  reject hidden fragments of the farther objects.
+//
+//  Programs, textures, and materials are packed into the key by their
+//  position in the order they were first added to this frame's queue,
+//  not by their GL names or IDs, so each gets RQ_STATE_BITS bits.  Up
+//  to RQ_STATES different ones sort apart; any more share the last
+//  value and merely sort less tightly.  Nothing but the sort order
+//  depends on the key:  the state change counts and batch() compare
+//  the packets' own fields.
+//
+
+//
+// Bits of the sort key for each kind of state, and how many different
+// ones can be told apart
+//
+#define RQ_STATE_BITS   8
+#define RQ_STATES       (1 << RQ_STATE_BITS)
+
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "Buffers.h"
+#include "Models.h"
+
+using namespace std;
+
+//
+// Everything needed to issue one draw call
+//
+typedef struct drawpacket_s {
+	uint64_t key;        // sort key
+	GLuint program;      // shader program
+	int material;        // material ID
+	GLuint texture;      // texture bound by that material
+	Object obj;          // which object
+	BufferSet *buf;      // its buffers
+	glm::mat4 model;     // its model transformation
+	float depth;         // distance from the eye, along the view axis
+	GLuint query;        // draw only if this query passed (0: always)
+	int lod;             // level of detail to draw it at
+	int meshlets;        // its entry in the frame's MeshletCuller (-1: none)
+} DrawPacket;
+
+//
+// A run of packets that can be drawn as instances of one mesh
+//
+typedef struct drawbatch_s {
+	size_t first;        // index of its first packet
+	size_t count;        // number of packets in it
+} DrawBatch;
+
+class RenderQueue {
+
+public:
+	// the packets for the current frame
+	vector<DrawPacket> packets;
+
+	// state changes needed to draw the packets in sorted order
+	unsigned long programChanges, textureChanges;
+
+	// state changes saved by sorting, compared to submission order
+	unsigned long changesAvoided;
+
+	// the instanced batches found by batch() (empty until it is called)
+	vector<DrawBatch> batches;
+
+private:
+	// the programs, textures, and materials added this frame, in the
+	// order they first appeared; a packet's key holds their positions
+	vector<GLuint> programSlots, textureSlots;
+	vector<int> materialSlots;
+
+public:
+
+	///
+	/// Constructor
+	///
+	RenderQueue( void );
+
+	///
+	/// clear() - empty the queue at the start of a frame
+	///
+	void clear( void );
+
+	///
+	/// add() - add a draw packet to the queue
+	///
+	/// @param program   shader program to draw with
+	/// @param material  material ID of the object
+	/// @param texture   texture used by that material
+	/// @param obj       which object
+	/// @param buf       the object's buffers
+	/// @param model     the object's model transformation
+	/// @param depth     distance from the eye along the view axis
+	/// @param query     occlusion query to draw it conditionally on
+	///                  (0 to draw it unconditionally)
+	/// @param lod       level of detail to draw it at
+	///
+	void add( GLuint program, int material, GLuint texture, Object obj,
+			  BufferSet *buf, const glm::mat4 &model, float depth,
+			  GLuint query = 0, int lod = 0 );
+
+	///
+	/// sort() - order the packets by their keys, and update the
+	///     state change counters
+	///
+	void sort( void );
+
+	///
+	/// batch() - gather the sorted packets into batches that share a
+	///     program, texture, material, set of buffers, and level of
+	///     detail, so that each batch can be drawn with one instanced
+	///     draw call
+	///
+	/// Within a batch, the packets keep their front-to-back order.
+	/// A packet drawn conditionally is always a batch by itself, as is
+	/// one whose meshlets are culled.
+	///
+	void batch( void );
+
+private:
+
+	///
+	/// countChanges() - count the program and texture switches needed
+	///     to draw the packets in their current order
+	///
+	/// @param progs   receives the number of program switches
+	/// @param texs    receives the number of texture switches
+	///
+	void countChanges( unsigned long &progs, unsigned long &texs );
+
+};
+
+#endif
@@ -16,7 +16,9 @@
 //
 //     shaderSetup(vsfile,fsfile,err)
 //     shaderSetup(vsfile,fsfile,fsfile,err)
+//     shaderSetup(vsfile,fsfile,gsfile,tcfile,tefile,err)
 //     shaderSetupStr(vsstr,fsstr,gsstr,err)
+//     shaderSetupStr(vsstr,fsstr,gsstr,tcstr,testr,err)
 //         These functions take C-style strings as the first two
 //         parameters.  For shaderSetup(), these are pathnames of files
 //         containing the GLSL code for the vertex and fragment shaders;
@@ -24,6 +26,8 @@
 //         code.  Each will create shader objects, attach the source
 //         code to them, and compile them; next, they create a program
 //         object, attached the shader objects, and link the program.
+//         The longer forms also take geometry, tessellation control,
+//         and tessellation evaluation shaders (any of them NULL).
 //
 //     shaderCreate(src,type,err)
 //     shaderLink(ids,num,err)
@@ -192,6 +196,14 @@ static const char *msgs[E_NUM_ERRORS] = {
 	"Error allocating geometry shader object",  /* E_GS_ALLOC */
 	"Error loading geometry shader code",       /* E_GS_LOAD */
 	"Error compiling geometry shader code",     /* E_GS_COMPILE */
+	// tessellation control shader
+	"Error allocating tess. control shader object",    /* E_TC_ALLOC */
+	"Error loading tess. control shader code",         /* E_TC_LOAD */
+	"Error compiling tess. control shader code",       /* E_TC_COMPILE */
+	// tessellation evaluation shader
+	"Error allocating tess. evaluation shader object", /* E_TE_ALLOC */
+	"Error loading tess. evaluation shader code",      /* E_TE_LOAD */
+	"Error compiling tess. evaluation shader code",    /* E_TE_COMPILE */
 	// program
 	"Error allocating program object",          /* E_PROG_ALLOC */
 	"Error linking shader program"              /* E_PROG_LINK */
@@ -258,6 +270,8 @@ GLuint shaderCreate( const GLchar **src, GLenum type, ShaderError &err ) {
 		case GL_VERTEX_SHADER:    err = E_VS_ALLOC; break;
 		case GL_FRAGMENT_SHADER:  err = E_FS_ALLOC; break;
 		case GL_GEOMETRY_SHADER:  err = E_GS_ALLOC; break;
+		case GL_TESS_CONTROL_SHADER:     err = E_TC_ALLOC; break;
+		case GL_TESS_EVALUATION_SHADER:  err = E_TE_ALLOC; break;
 		default:                  err = E_US_ALLOC; break;
 		}
 		return( 0 );
@@ -278,6 +292,8 @@ GLuint shaderCreate( const GLchar **src, GLenum type, ShaderError &err ) {
 		case GL_VERTEX_SHADER:    err = E_VS_COMPILE; break;
 		case GL_FRAGMENT_SHADER:  err = E_FS_COMPILE; break;
 		case GL_GEOMETRY_SHADER:  err = E_GS_COMPILE; break;
+		case GL_TESS_CONTROL_SHADER:     err = E_TC_COMPILE; break;
+		case GL_TESS_EVALUATION_SHADER:  err = E_TE_COMPILE; break;
 		default:                  err = E_US_COMPILE; break;
 		}
 		return( 0 );
@@ -331,6 +347,9 @@ GLuint shaderLink( GLuint ids[], size_t num, ShaderError &err ) {
 		return( 0 );
 	}
 
+	// record where the program's uniforms live
+	buildUniformTable( prog );
+
 	return( prog );
 }
 
@@ -358,9 +377,44 @@ GLuint shaderLink( GLuint ids[], size_t num, ShaderError &err ) {
 ///
 GLuint shaderSetupStr( const GLchar *vsrc, const GLchar *fsrc,
 					   const GLchar *gsrc, ShaderError &err ) {
-	GLuint vs, fs, gs, prog;
+	// call the five-shader version with no tessellation stages
+	return( shaderSetupStr(vsrc,fsrc,gsrc,nullptr,nullptr,err) );
+}
+
+///
+/// shaderSetupStr(vertex,fragment,geometry,tesscontrol,tesseval,err)
+///
+/// Set up a GLSL shader program, possibly with tessellation stages.
+///
+/// Requires strings containing the source code for the GLSL shaders.
+/// Returns a program ID for the linked program.
+///
+/// @param  vsrc   vertex shader program source code
+/// @param  fsrc   fragment shader program source code, or NULL
+/// @param  gsrc   geometry shader program source code, or NULL
+/// @param  tcsrc  tessellation control shader source code, or NULL
+/// @param  tesrc  tessellation evaluation shader source code, or NULL
+/// @param  err    reference to status variable
+/// @return shader program handle, or 0
+///
+/// On success:
+///      Returns the GLSL shader program handle, and sets the 'err'
+///      parameter to E_NO_ERROR.
+///
+/// On failure:
+///      Returns 0, and assigns an error code to 'err'.
+///
+GLuint shaderSetupStr( const GLchar *vsrc, const GLchar *fsrc,
+					   const GLchar *gsrc, const GLchar *tcsrc,
+					   const GLchar *tesrc, ShaderError &err ) {
+	const GLchar *srcs[5] = { vsrc, fsrc, gsrc, tcsrc, tesrc };
+	static const GLenum types[5] = {
+		GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER,
+		GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER
+	};
+	GLuint ids[5], prog;
 	const GLchar *src[2];
-	int nshaders = 1;
+	int n = 0;
 
 	// must have a vertex shader!
 	if( vsrc == nullptr ) {
@@ -371,85 +425,35 @@ GLuint shaderSetupStr( const GLchar *vsrc, const GLchar *fsrc,
 	// from here on, other functions will set 'err' if something fails
 	err = E_NO_ERROR;
 
-	// Create the shader objects
-	src[0] = vsrc;
+	// Create a shader object for each stage we were given
 	src[1] = 0;
-
-	vs = shaderCreate( src, GL_VERTEX_SHADER, err );
-
-	if( vs == 0 ) {
-		return( 0 );
-	}
-
-	// if we have a fragment shader, create it
-	if( fsrc != nullptr ) {
-		src[0] = fsrc;
-		fs = shaderCreate( src, GL_FRAGMENT_SHADER, err );
-
-		if( fs == 0 ) {
-			glDeleteShader( vs );
-			return( 0 );
+	for( int i = 0; i < 5; ++i ) {
+		if( srcs[i] == nullptr ) {
+			continue;
 		}
 
-		nshaders += 1;
-	}
-
-	// if we have a geometry shader, create it
-	if( gsrc != nullptr ) {
-		src[0] = gsrc;
-		gs = shaderCreate( src, GL_GEOMETRY_SHADER, err );
+		src[0] = srcs[i];
+		ids[n] = shaderCreate( src, types[i], err );
 
-		if( gs == 0 ) {
-			glDeleteShader( vs );
-			if( fsrc != nullptr ) glDeleteShader( fs );
+		if( ids[n] == 0 ) {
+			while( n > 0 ) {
+				glDeleteShader( ids[--n] );
+			}
 			return( 0 );
 		}
 
-		nshaders += 1;
-	}
-
-	// Create the program and attach the shaders
-
-	// This declaration causes Visual Studio to complain bitterly,
-	// so we will dynamically allocate the array instead.
-	// GLuint ids[nshaders];
-	GLuint *ids = new GLuint[nshaders];
-
-	// always have a vertex shader
-	ids[0] = vs;
-	int n = 1;
-
-	// do we have a fragment shader?
-	if( fsrc != nullptr ) {
-		ids[n++] = fs;
-	}
-
-	// do we have a geometry shader?
-	if( gsrc != nullptr ) {
-		ids[n++] = gs;
-	}
-
-	// sanity check!
-	if( n != nshaders ) {
-		cerr << "Internal error: nshaders " << nshaders
-			<< " but only found " << n << " to link?" << endl;
-		glDeleteShader( vs );
-		if( fsrc != nullptr ) glDeleteShader( fs );
-		if( gsrc != nullptr ) glDeleteShader( gs );
-		delete [] ids;
-		return( 0 );
+		n += 1;
 	}
 
 	// OK, we have all the shaders; create the program
 	prog = shaderLink( ids, n, err );
 
 	if( prog == 0 ) {
-		glDeleteShader( vs );
-		if( fsrc != nullptr ) glDeleteShader( fs );
-		if( gsrc != nullptr ) glDeleteShader( gs );
+		for( int i = 0; i < n; ++i ) {
+			glDeleteShader( ids[i] );
+		}
 	}
 
-	delete [] ids;
 	return( prog );
 }
 
@@ -474,8 +478,8 @@ GLuint shaderSetupStr( const GLchar *vsrc, const GLchar *fsrc,
 ///      Returns 0, and assigns an error code to 'err'.
 ///
 GLuint shaderSetup( const char *vert, const char *frag, ShaderError &err ) {
-	// cheat - call the three-shader version with a NULL pointer
-	return( shaderSetup(vert,frag,nullptr,err) );
+	// cheat - call the five-shader version with NULL pointers
+	return( shaderSetup(vert,frag,nullptr,nullptr,nullptr,err) );
 }
 
 ///
@@ -501,44 +505,73 @@ GLuint shaderSetup( const char *vert, const char *frag, ShaderError &err ) {
 ///
 GLuint shaderSetup( const char *vert, const char *frag,
 					const char *geom, ShaderError &err ) {
-	GLchar *vsrc = nullptr, *fsrc = nullptr, *gsrc = nullptr;
-
-	// Must have a vertex shader
-	vsrc = readTextFile( vert );
-	if( vsrc == nullptr ) {
-		cerr << "Error reading vertex shader file " << vert << endl;
-		err = E_VS_LOAD;
-		return( 0 );
-	}
+	// call the five-shader version with no tessellation stages
+	return( shaderSetup(vert,frag,geom,nullptr,nullptr,err) );
+}
 
-	if( frag != nullptr ) {
-		fsrc = readTextFile( frag );
-		if( fsrc == nullptr ) {
-			cerr << "Error reading fragment shader file " << frag << endl;
-			err = E_FS_LOAD;
-			delete [] vsrc;
-			return( 0 );
+///
+/// shaderSetup(vertex,fragment,geometry,tesscontrol,tesseval,err)
+///
+/// Set up a GLSL shader program, possibly with tessellation stages
+/// (which require OpenGL 4.0).
+///
+/// Requires the names of the shader program source files.  Returns
+/// a handle to the created GLSL program.
+///
+/// @param  vert   vertex shader program source file
+/// @param  frag   fragment shader program source file, or NULL
+/// @param  geom   geometry shader program source file, or NULL
+/// @param  tesc   tessellation control shader source file, or NULL
+/// @param  tese   tessellation evaluation shader source file, or NULL
+/// @param  err    reference to status variable
+/// @return shader program handle, or 0
+///
+/// On success:
+///      Returns the GLSL shader program handle, and sets the 'err'
+///      parameter to E_NO_ERROR.
+///
+/// On failure:
+///      Returns 0, and assigns an error code to 'err'.
+///
+GLuint shaderSetup( const char *vert, const char *frag, const char *geom,
+					const char *tesc, const char *tese, ShaderError &err ) {
+	const char *files[5] = { vert, frag, geom, tesc, tese };
+	static const char *stages[5] = {
+		"vertex", "fragment", "geometry",
+		"tessellation control", "tessellation evaluation"
+	};
+	static const ShaderError loadErrors[5] = {
+		E_VS_LOAD, E_FS_LOAD, E_GS_LOAD, E_TC_LOAD, E_TE_LOAD
+	};
+	GLchar *srcs[5] = { nullptr, nullptr, nullptr, nullptr, nullptr };
+	GLuint ret = 0;
+	bool loaded = true;
+
+	// Must have a vertex shader; the others are optional
+	for( int i = 0; i < 5 && loaded; ++i ) {
+		if( files[i] == nullptr && i > 0 ) {
+			continue;
 		}
-	}
 
-	if( geom != nullptr ) {
-		gsrc = readTextFile( geom );
-		if( gsrc == nullptr ) {
-			cerr << "Error reading geometry shader file " << geom << endl;
-			err = E_GS_LOAD;
-			delete [] vsrc;
-			if( fsrc != nullptr ) delete [] fsrc;
-			return( 0 );
+		srcs[i] = readTextFile( files[i] );
+		if( srcs[i] == nullptr ) {
+			cerr << "Error reading " << stages[i] << " shader file "
+				 << (files[i] != nullptr ? files[i] : "(none)") << endl;
+			err = loadErrors[i];
+			loaded = false;
 		}
 	}
 
 	// Do the actual setup
-	GLuint ret = shaderSetupStr( vsrc, fsrc, gsrc, err );
+	if( loaded ) {
+		ret = shaderSetupStr( srcs[0], srcs[1], srcs[2], srcs[3],
+			srcs[4], err );
+	}
 
 	// Whatever happened, we're done with the source code now
-	delete [] vsrc;
-	if( fsrc != nullptr ) delete [] fsrc;
-	if( gsrc != nullptr ) delete [] gsrc;
+	for( int i = 0; i < 5; ++i ) {
+		if( srcs[i] != nullptr ) delete [] srcs[i];
+	}
 
 	return( ret );
 }
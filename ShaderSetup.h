@@ -31,6 +31,10 @@ typedef enum sError {
 	E_FS_ALLOC, E_FS_LOAD, E_FS_COMPILE,
 	// geometry shader-specific
 	E_GS_ALLOC, E_GS_LOAD, E_GS_COMPILE,
+	// tessellation control shader-specific
+	E_TC_ALLOC, E_TC_LOAD, E_TC_COMPILE,
+	// tessellation evaluation shader-specific
+	E_TE_ALLOC, E_TE_LOAD, E_TE_COMPILE,
 	// program-specific
 	E_PROG_ALLOC, E_PROG_LINK,
 	// sentinel
@@ -124,6 +128,32 @@ GLuint shaderLink( GLuint ids[], size_t num, ShaderError &err );
 GLuint shaderSetupStr( const GLchar *vsrc, const GLchar *fsrc,
 					   const GLchar *gsrc, ShaderError &err );
 
+///
+/// shaderSetupStr(vertex,fragment,geometry,tesscontrol,tesseval,err)
+///
+/// Set up a GLSL shader program, possibly with tessellation stages.
+///
+/// Requires strings containing the source code for GLSL shaders.
+/// Returns a program ID for the linked program.
+///
+/// @param  vsrc   vertex shader program source code
+/// @param  fsrc   fragment shader program source code, or NULL
+/// @param  gsrc   geometry shader program source code, or NULL
+/// @param  tcsrc  tessellation control shader source code, or NULL
+/// @param  tesrc  tessellation evaluation shader source code, or NULL
+/// @param  err    reference to status variable
+///
+/// On success:
+///      Returns the GLSL shader program handle, and sets the 'err'
+///      parameter to E_NO_ERROR.
+///
+/// On failure:
+///      Returns 0, and assigns an error code to 'err'.
+///
+GLuint shaderSetupStr( const GLchar *vsrc, const GLchar *fsrc,
+					   const GLchar *gsrc, const GLchar *tcsrc,
+					   const GLchar *tesrc, ShaderError &err );
+
 ///
 /// shaderSetup(vertex,fragment,err)
 ///
@@ -170,4 +200,31 @@ GLuint shaderSetup( const char *vert, const char *frag, ShaderError &err );
 GLuint shaderSetup( const char *vert, const char *frag,
 					const char *geom, ShaderError &err );
 
+///
+/// shaderSetup(vertex,fragment,geometry,tesscontrol,tesseval,err)
+///
+/// Set up a GLSL shader program, possibly with tessellation stages
+/// (which require OpenGL 4.0).
+///
+/// Requires the names of the shader program source files.  Returns
+/// a handle to the created GLSL program.
+///
+/// Arguments:
+/// @param vert   vertex shader program source file
+/// @param frag   fragment shader program source file, or NULL
+/// @param geom   geometry shader program source file, or NULL
+/// @param tesc   tessellation control shader source file, or NULL
+/// @param tese   tessellation evaluation shader source file, or NULL
+/// @param err    reference to status variable
+///
+/// On success:
+///      Returns the GLSL shader program handle, and sets the 'err'
+///      parameter to E_NO_ERROR.
+///
+/// On failure:
+///      Returns 0, and assigns an error code to 'err'.
+///
+GLuint shaderSetup( const char *vert, const char *frag, const char *geom,
+					const char *tesc, const char *tese, ShaderError &err );
+
 #endif
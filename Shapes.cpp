@@ -0,0 +1,376 @@
+//
+//  Shapes.cpp
+//
+//  Parametric generators for simple solids.
+//
+
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "Shapes.h"
+
+using namespace std;
+
+//
+// PRIVATE GLOBALS
+//
+
+// a cached mesh; generated once, by whichever thread asks first
+typedef struct st_cached {
+	once_flag made;
+	MeshData mesh;
+} Cached;
+
+// every mesh generated so far, by (shape, tessellation)
+static map< pair<int,int>, unique_ptr<Cached> > cache;
+static mutex cacheLock;
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// Tessellation limits for each shape
+///
+static int slices( int tess ) { return( tess < 3 ? 3 : tess ); }
+static int sphereStacks( int tess ) { return( tess / 2 < 2 ? 2 : tess / 2 ); }
+static int coneStacks( int tess ) { return( tess / 4 < 1 ? 1 : tess / 4 ); }
+static int divisions( int tess ) { return( tess < 1 ? 1 : tess ); }
+
+///
+/// Add a vertex to a mesh
+///
+/// @return its index
+///
+static GLuint addVert( MeshData &m, float x, float y, float z,
+	Normal n, float u, float v )
+{
+	Vertex p = { x, y, z, 1.0f };
+	TexCoord t = { u, v };
+
+	m.verts.push_back( p );
+	m.norms.push_back( n );
+	m.uvs.push_back( t );
+
+	return( (GLuint) (m.verts.size() - 1) );
+}
+
+///
+/// Add a triangle to a mesh
+///
+static void addTri( MeshData &m, GLuint a, GLuint b, GLuint c )
+{
+	m.elements.push_back( a );
+	m.elements.push_back( b );
+	m.elements.push_back( c );
+}
+
+///
+/// Unit-length normal perpendicular to two edges
+///
+static Normal faceNormal( const float e1[3], const float e2[3] )
+{
+	float x = e1[1] * e2[2] - e1[2] * e2[1];
+	float y = e1[2] * e2[0] - e1[0] * e2[2];
+	float z = e1[0] * e2[1] - e1[1] * e2[0];
+	float len = sqrtf( x * x + y * y + z * z );
+	Normal n = { x / len, y / len, z / len };
+
+	return( n );
+}
+
+///
+/// Add a flat, n x n grid of quads:  the parallelogram with one corner
+/// at 'c' and sides 'du' and 'dv', facing toward du x dv
+///
+static void addGrid( MeshData &m, const float c[3], const float du[3],
+	const float dv[3], int n )
+{
+	Normal nn = faceNormal( du, dv );
+	GLuint base = (GLuint) m.verts.size();
+
+	for( int j = 0; j <= n; ++j ) {
+		float v = (float) j / n;
+		for( int i = 0; i <= n; ++i ) {
+			float u = (float) i / n;
+			addVert( m, c[0] + u * du[0] + v * dv[0],
+				c[1] + u * du[1] + v * dv[1],
+				c[2] + u * du[2] + v * dv[2], nn, u, v );
+		}
+	}
+
+	for( int j = 0; j < n; ++j ) {
+		for( int i = 0; i < n; ++i ) {
+			GLuint a = base + j * (n + 1) + i;
+			GLuint d = a + n + 1;
+			addTri( m, a, a + 1, d + 1 );
+			addTri( m, a, d + 1, d );
+		}
+	}
+}
+
+///
+/// Add a flat triangle (a,b,c), counterclockwise when seen from the
+/// front, divided into n x n smaller ones; 'ta', 'tb', and 'tc' are
+/// the texture coordinates at the corners
+///
+static void addTriFace( MeshData &m, const float a[3], const float b[3],
+	const float c[3], TexCoord ta, TexCoord tb, TexCoord tc, int n )
+{
+	float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	Normal nn = faceNormal( ab, ac );
+	GLuint base = (GLuint) m.verts.size();
+
+	// row r runs from (r,0) on edge ab to (r,r) on edge ac
+	for( int r = 0; r <= n; ++r ) {
+		for( int j = 0; j <= r; ++j ) {
+			float sb = (float) (r - j) / n;
+			float sc = (float) j / n;
+			float sa = 1.0f - sb - sc;
+			addVert( m, sa * a[0] + sb * b[0] + sc * c[0],
+				sa * a[1] + sb * b[1] + sc * c[1],
+				sa * a[2] + sb * b[2] + sc * c[2], nn,
+				sa * ta.u + sb * tb.u + sc * tc.u,
+				sa * ta.v + sb * tb.v + sc * tc.v );
+		}
+	}
+
+	for( int r = 0; r < n; ++r ) {
+		GLuint row = base + r * (r + 1) / 2;
+		GLuint next = row + r + 1;
+		for( int j = 0; j <= r; ++j ) {
+			addTri( m, row + j, next + j, next + j + 1 );
+			if( j < r ) {
+				addTri( m, row + j, next + j + 1, row + j + 1 );
+			}
+		}
+	}
+}
+
+///
+/// makeSphere() - a UV sphere; the seam and poles get one vertex
+/// per slice so each can have its own texture coordinates
+///
+static void makeSphere( MeshData &m, int tess )
+{
+	int ns = slices( tess );
+	int nt = sphereStacks( tess );
+
+	// stack i runs from the north pole (i == 0) to the south
+	for( int i = 0; i <= nt; ++i ) {
+		float phi = (float) M_PI * i / nt;
+		for( int j = 0; j <= ns; ++j ) {
+			float theta = 2.0f * (float) M_PI * j / ns;
+			Normal n = { sinf( phi ) * cosf( theta ), cosf( phi ),
+				-sinf( phi ) * sinf( theta ) };
+			addVert( m, 0.5f * n.x, 0.5f * n.y, 0.5f * n.z, n,
+				(float) j / ns, 1.0f - (float) i / nt );
+		}
+	}
+
+	for( int i = 0; i < nt; ++i ) {
+		for( int j = 0; j < ns; ++j ) {
+			GLuint a = i * (ns + 1) + j;
+			GLuint b = a + ns + 1;
+			// no slivers at the poles
+			if( i > 0 ) {
+				addTri( m, a, b, a + 1 );
+			}
+			if( i < nt - 1 ) {
+				addTri( m, a + 1, b, b + 1 );
+			}
+		}
+	}
+}
+
+///
+/// makeCone() - a cone with its apex up, and its base
+///
+static void makeCone( MeshData &m, int tess )
+{
+	int ns = slices( tess );
+	int nt = coneStacks( tess );
+
+	// the side:  normals lean up by the slope (radius / height)
+	float len = sqrtf( 1.0f + 0.25f );
+	for( int i = 0; i <= nt; ++i ) {
+		float h = (float) i / nt;
+		float r = 0.5f * (1.0f - h);
+		for( int j = 0; j <= ns; ++j ) {
+			// at the apex, each slice's normal points out of its middle
+			float theta = 2.0f * (float) M_PI *
+				(i == nt ? j + 0.5f : (float) j) / ns;
+			Normal n = { cosf( theta ) / len, 0.5f / len,
+				-sinf( theta ) / len };
+			addVert( m, r * cosf( theta ), h - 0.5f, -r * sinf( theta ),
+				n, (float) j / ns, h );
+		}
+	}
+
+	for( int i = 0; i < nt; ++i ) {
+		for( int j = 0; j < ns; ++j ) {
+			GLuint a = i * (ns + 1) + j;
+			GLuint b = a + ns + 1;
+			addTri( m, a, a + 1, b );
+			if( i < nt - 1 ) {
+				addTri( m, a + 1, b + 1, b );
+			}
+		}
+	}
+
+	// the base
+	Normal down = { 0.0f, -1.0f, 0.0f };
+	GLuint center = addVert( m, 0.0f, -0.5f, 0.0f, down, 0.5f, 0.5f );
+	for( int j = 0; j < ns; ++j ) {
+		float theta = 2.0f * (float) M_PI * j / ns;
+		float x = 0.5f * cosf( theta ), z = -0.5f * sinf( theta );
+		addVert( m, x, -0.5f, z, down, x + 0.5f, z + 0.5f );
+	}
+	for( int j = 0; j < ns; ++j ) {
+		addTri( m, center, center + 1 + (j + 1) % ns, center + 1 + j );
+	}
+}
+
+///
+/// makeCube() - a cube
+///
+static void makeCube( MeshData &m, int tess )
+{
+	int n = divisions( tess );
+
+	// a corner and two edges for each face, with du x dv outward
+	static const float faces[6][3][3] = {
+		{ {  0.5f, -0.5f,  0.5f }, {  0, 0, -1 }, { 0, 1,  0 } },  // +X
+		{ { -0.5f, -0.5f, -0.5f }, {  0, 0,  1 }, { 0, 1,  0 } },  // -X
+		{ { -0.5f,  0.5f,  0.5f }, {  1, 0,  0 }, { 0, 0, -1 } },  // +Y
+		{ { -0.5f, -0.5f, -0.5f }, {  1, 0,  0 }, { 0, 0,  1 } },  // -Y
+		{ { -0.5f, -0.5f,  0.5f }, {  1, 0,  0 }, { 0, 1,  0 } },  // +Z
+		{ {  0.5f, -0.5f, -0.5f }, { -1, 0,  0 }, { 0, 1,  0 } }   // -Z
+	};
+
+	for( int f = 0; f < 6; ++f ) {
+		addGrid( m, faces[f][0], faces[f][1], faces[f][2], n );
+	}
+}
+
+///
+/// makePyramid() - a pyramid with a square base
+///
+static void makePyramid( MeshData &m, int tess )
+{
+	int n = divisions( tess );
+
+	// base corners, counterclockwise seen from above
+	static const float corner[4][3] = {
+		{ -0.5f, -0.5f,  0.5f }, {  0.5f, -0.5f,  0.5f },
+		{  0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, -0.5f }
+	};
+	static const float apex[3] = { 0.0f, 0.5f, 0.0f };
+	static const float bx[3] = { 1, 0, 0 }, bz[3] = { 0, 0, 1 };
+	TexCoord t0 = { 0.0f, 0.0f }, t1 = { 1.0f, 0.0f }, t2 = { 0.5f, 1.0f };
+
+	addGrid( m, corner[3], bx, bz, n );
+	for( int s = 0; s < 4; ++s ) {
+		addTriFace( m, corner[s], corner[(s + 1) % 4], apex, t0, t1, t2, n );
+	}
+}
+
+///
+/// makePrism() - a triangular prism, lying along the Z axis with one
+/// edge up (like a roof)
+///
+static void makePrism( MeshData &m, int tess )
+{
+	int n = divisions( tess );
+
+	// the ends
+	static const float f0[3] = { -0.5f, -0.5f,  0.5f };
+	static const float f1[3] = {  0.5f, -0.5f,  0.5f };
+	static const float f2[3] = {  0.0f,  0.5f,  0.5f };
+	static const float b0[3] = {  0.5f, -0.5f, -0.5f };
+	static const float b1[3] = { -0.5f, -0.5f, -0.5f };
+	static const float b2[3] = {  0.0f,  0.5f, -0.5f };
+	TexCoord t0 = { 0.0f, 0.0f }, t1 = { 1.0f, 0.0f }, t2 = { 0.5f, 1.0f };
+
+	addTriFace( m, f0, f1, f2, t0, t1, t2, n );
+	addTriFace( m, b0, b1, b2, t0, t1, t2, n );
+
+	// the bottom and the two slopes
+	static const float bx[3] = { 1, 0, 0 }, bz[3] = { 0, 0, 1 };
+	static const float back[3] = { 0, 0, -1 }, front[3] = { 0, 0, 1 };
+	static const float right[3] = { -0.5f, 1, 0 }, left[3] = { 0.5f, 1, 0 };
+
+	addGrid( m, b1, bx, bz, n );
+	addGrid( m, f1, back, right, n );
+	addGrid( m, b1, front, left, n );
+}
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Retrieve a shape, generating it if this is the first request
+///
+/// @param shape   which shape
+/// @param tess    its tessellation
+///
+/// @return the mesh
+///
+const MeshData &getShape( Shape shape, int tess )
+{
+	Cached *c;
+
+	{
+		lock_guard<mutex> l( cacheLock );
+		unique_ptr<Cached> &slot = cache[ make_pair( (int) shape, tess ) ];
+		if( !slot ) {
+			slot.reset( new Cached );
+		}
+		c = slot.get();
+	}
+
+	// generated outside the lock, so different shapes can be made
+	// at the same time; anyone else wanting this one waits for it
+	call_once( c->made, [&] {
+		MeshData &m = c->mesh;
+		m.elements.reserve( 3 * shapeTriangles( shape, tess ) );
+		switch( shape ) {
+		case SHAPE_SPHERE:   makeSphere( m, tess );   break;
+		case SHAPE_CONE:     makeCone( m, tess );     break;
+		case SHAPE_PYRAMID:  makePyramid( m, tess );  break;
+		case SHAPE_PRISM:    makePrism( m, tess );    break;
+		case SHAPE_CUBE:     makeCube( m, tess );     break;
+		default:
+			cerr << "getShape(" << shape << ") - unknown shape" << endl;
+		}
+	} );
+
+	return( c->mesh );
+}
+
+///
+/// Determine how many triangles a shape will have
+///
+/// @param shape   which shape
+/// @param tess    its tessellation
+///
+/// @return the triangle count
+///
+int shapeTriangles( Shape shape, int tess )
+{
+	int n = divisions( tess );
+
+	switch( shape ) {
+	case SHAPE_SPHERE:   return( slices( tess ) * (2 * sphereStacks( tess ) - 2) );
+	case SHAPE_CONE:     return( slices( tess ) * 2 * coneStacks( tess ) );
+	case SHAPE_PYRAMID:  return( 6 * n * n );
+	case SHAPE_PRISM:    return( 8 * n * n );
+	case SHAPE_CUBE:     return( 12 * n * n );
+	default:             return( 0 );
+	}
+}
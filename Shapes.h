@@ -0,0 +1,86 @@
+//
+//  Shapes.h
+//
+//  Parametric generators for simple solids.
+//
+//  Each shape fits in the unit cube centered at the origin (i.e., it
+//  runs from -0.5 to 0.5 along each axis), like the cylinder and quad
+//  in MeshTables.h.  The tessellation parameter sets the triangle count:
+//
+//      shape             tess means                  triangles
+//      SHAPE_SPHERE      slices (stacks = tess/2)    slices * (2*stacks - 2)
+//      SHAPE_CONE        slices (stacks = tess/4)    slices * 2*stacks
+//      SHAPE_PYRAMID     divisions per edge          6 * tess^2
+//      SHAPE_PRISM       divisions per edge          8 * tess^2
+//      SHAPE_CUBE        divisions per edge          12 * tess^2
+//
+//  (with at least 3 slices, 2 sphere stacks, and 1 of anything else).
+//
+//  Shapes are generated as indexed meshes:  vertices are shared
+//  wherever the position, normal, and texture coordinates all agree.
+//  Each generated mesh is kept, so asking for the same shape and
+//  tessellation again costs nothing; getShape() may be called from
+//  any thread.
+//
+
+#ifndef SHAPES_H_
+#define SHAPES_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+#include "Types.h"
+
+using namespace std;
+
+//
+// The shapes we can generate
+//
+typedef
+	enum shape_e {
+		SHAPE_SPHERE = 0
+		, SHAPE_CONE
+		, SHAPE_PYRAMID
+		, SHAPE_PRISM
+		, SHAPE_CUBE
+		// Sentinel gives us the number of shapes
+		, N_SHAPES
+	} Shape;
+
+///
+/// A generated mesh
+///
+typedef struct st_meshdata {
+	vector<Vertex> verts;
+	vector<Normal> norms;
+	vector<TexCoord> uvs;
+	vector<GLuint> elements;     // three per triangle
+} MeshData;
+
+///
+/// Retrieve a shape, generating it if this is the first request
+///
+/// @param shape   which shape
+/// @param tess    its tessellation (see above)
+///
+/// @return the mesh
+///
+const MeshData &getShape( Shape shape, int tess );
+
+///
+/// Determine how many triangles a shape will have
+///
+/// @param shape   which shape
+/// @param tess    its tessellation
+///
+/// @return the triangle count
+///
+int shapeTriangles( Shape shape, int tess );
+
+#endif
@@ -0,0 +1,444 @@
+//
+//  Simplify.cpp
+//
+//  Level-of-detail generation for indexed meshes.
+//
+//  The candidate collapses wait in a priority queue ordered by cost.
+//  Rather than updating entries in place, a collapse bumps the stamp
+//  of the vertex that survives it and queues the edges around that
+//  vertex again; entries queued before a stamp changed are simply
+//  discarded when they come up.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+
+#include "Simplify.h"
+
+//
+// PRIVATE GLOBALS
+//
+
+// collapses costing no more than this add no error
+#define SIMPLIFY_FREE   1.0e-12
+
+// most neighbors a vertex may be left with by a collapse; long fans
+// make poor triangles, and slow the simplification down
+#define SIMPLIFY_MAX_VALENCE    16
+
+// least cosine of the angle a triangle may turn through from the way
+// it first faced
+#define SIMPLIFY_MIN_FACING     0.25
+
+// a symmetric 4x4 matrix:  the sum of the squared distances to a
+// set of planes, as a function of position
+typedef struct st_quadric {
+	double q[10];
+} Quadric;
+
+// a collapse waiting in the queue:  'from' moves onto 'to'
+typedef struct st_collapse {
+	double cost;
+	int from, to;
+	unsigned stampFrom, stampTo;
+} Collapse;
+
+// orders the queue cheapest first
+struct CollapseOrder {
+	bool operator()( const Collapse &a, const Collapse &b ) const {
+		return( a.cost > b.cost );
+	}
+};
+
+//
+// PRIVATE FUNCTIONS
+//
+
+///
+/// Add the quadric of the plane ax + by + cz + d = 0
+///
+/// @param Q         the quadric
+/// @param a,b,c,d   the plane (unit normal)
+///
+static void addPlane( Quadric &Q, double a, double b, double c, double d )
+{
+	double *q = Q.q;
+
+	q[0] += a * a; q[1] += a * b; q[2] += a * c; q[3] += a * d;
+	q[4] += b * b; q[5] += b * c; q[6] += b * d;
+	q[7] += c * c; q[8] += c * d;
+	q[9] += d * d;
+}
+
+///
+/// The error of a quadric at a point
+///
+/// @param Q    the quadric
+/// @param p    the point (XYZ)
+///
+/// @return the sum of the squared distances to its planes
+///
+static double evaluate( const Quadric &Q, const float *p )
+{
+	const double *q = Q.q;
+	double x = p[0], y = p[1], z = p[2];
+
+	double e = q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z +
+			   2.0 * q[3] * x + q[4] * y * y + 2.0 * q[5] * y * z +
+			   2.0 * q[6] * y + q[7] * z * z + 2.0 * q[8] * z + q[9];
+
+	return( e > 0.0 ? e : 0.0 );
+}
+
+///
+/// The (unnormalized) normal of a triangle
+///
+/// @param a,b,c   its corners (XYZ)
+/// @param n       receives the normal
+///
+static void triNormal( const float *a, const float *b, const float *c,
+	double n[3] )
+{
+	double u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	double v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+	n[0] = u[1] * v[2] - u[2] * v[1];
+	n[1] = u[2] * v[0] - u[0] * v[2];
+	n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+///
+/// Lock the vertices that share their location with another vertex
+///
+/// @param pos      vertex locations (XYZW)
+/// @param nverts   number of vertices
+/// @param locked   set for each one found
+///
+static void lockSeams( const float *pos, int nverts, vector<char> &locked )
+{
+	vector<int> order( nverts );
+	for( int i = 0; i < nverts; ++i ) {
+		order[i] = i;
+	}
+
+	std::sort( order.begin(), order.end(), [pos]( int a, int b ) {
+		const float *p = pos + 4 * a, *q = pos + 4 * b;
+		if( p[0] != q[0] ) return( p[0] < q[0] );
+		if( p[1] != q[1] ) return( p[1] < q[1] );
+		return( p[2] < q[2] );
+	} );
+
+	for( int i = 1; i < nverts; ++i ) {
+		const float *p = pos + 4 * order[i - 1], *q = pos + 4 * order[i];
+		if( p[0] == q[0] && p[1] == q[1] && p[2] == q[2] ) {
+			locked[ order[i - 1] ] = locked[ order[i] ] = 1;
+		}
+	}
+}
+
+///
+/// Lock the vertices on edges that only one triangle uses
+///
+/// @param tri      the index list
+/// @param ntris    number of triangles
+/// @param locked   set for each one found
+///
+static void lockBoundaries( const vector<GLuint> &tri, int ntris,
+	vector<char> &locked )
+{
+	unordered_map<uint64_t,int> uses;
+
+	uses.reserve( ntris * 3 );
+	for( int t = 0; t < ntris; ++t ) {
+		for( int k = 0; k < 3; ++k ) {
+			uint64_t a = tri[3 * t + k], b = tri[3 * t + (k + 1) % 3];
+			uses[ a < b ? (a << 32) | b : (b << 32) | a ] += 1;
+		}
+	}
+
+	for( auto it = uses.begin(); it != uses.end(); ++it ) {
+		if( it->second == 1 ) {
+			locked[ it->first >> 32 ] = 1;
+			locked[ it->first & 0xffffffffu ] = 1;
+		}
+	}
+}
+
+//
+// PUBLIC FUNCTIONS
+//
+
+///
+/// Build progressively simpler versions of an indexed mesh
+///
+/// @param idx      the mesh's index list (three per triangle)
+/// @param nidx     number of indices
+/// @param pos      vertex locations (XYZW)
+/// @param nverts   number of vertices
+/// @param levels   most simplified levels wanted
+/// @param lods     receives the index list of each level
+/// @param errors   receives the error of each level (model coordinates)
+///
+/// @return the number of levels built (0 if none was worth keeping)
+///
+int buildLODs( const GLuint *idx, int nidx, const float *pos, int nverts,
+	int levels, vector<GLuint> lods[], float errors[] )
+{
+	int ntris = nidx / 3;
+
+	if( ntris < SIMPLIFY_MIN_TRIS || levels < 1 ) {
+		return( 0 );
+	}
+
+	vector<GLuint> tri( idx, idx + 3 * ntris );
+	vector<char> dead( ntris, 0 );
+	int alive = ntris;
+
+	// the triangles around each vertex (including, until neighbors()
+	// next visits it, some that have since been removed)
+	vector< vector<int> > around( nverts );
+	for( int t = 0; t < ntris; ++t ) {
+		for( int k = 0; k < 3; ++k ) {
+			around[ tri[3 * t + k] ].push_back( t );
+		}
+	}
+
+	vector<char> locked( nverts, 0 );
+	lockSeams( pos, nverts, locked );
+	lockBoundaries( tri, ntris, locked );
+
+	// each vertex starts with the planes of the triangles around it
+	// (and each triangle remembers which way it faced)
+	vector<Quadric> quad( nverts );
+	vector<double> facing( 3 * ntris );
+	for( int v = 0; v < nverts; ++v ) {
+		std::fill( quad[v].q, quad[v].q + 10, 0.0 );
+	}
+	for( int t = 0; t < ntris; ++t ) {
+		const float *a = pos + 4 * tri[3 * t];
+		double *n = &facing[3 * t];
+		triNormal( a, pos + 4 * tri[3 * t + 1], pos + 4 * tri[3 * t + 2], n );
+		double len = sqrt( n[0] * n[0] + n[1] * n[1] + n[2] * n[2] );
+		if( len == 0.0 ) {
+			continue;
+		}
+		n[0] /= len; n[1] /= len; n[2] /= len;
+		double d = -(n[0] * a[0] + n[1] * a[1] + n[2] * a[2]);
+		for( int k = 0; k < 3; ++k ) {
+			addPlane( quad[ tri[3 * t + k] ], n[0], n[1], n[2], d );
+		}
+	}
+
+	// no collapse may move the surface farther than a fraction of
+	// the mesh's size
+	float lo[3] = { pos[0], pos[1], pos[2] };
+	float hi[3] = { pos[0], pos[1], pos[2] };
+	for( int v = 1; v < nverts; ++v ) {
+		for( int k = 0; k < 3; ++k ) {
+			lo[k] = std::min( lo[k], pos[4 * v + k] );
+			hi[k] = std::max( hi[k], pos[4 * v + k] );
+		}
+	}
+	double size2 = (hi[0] - lo[0]) * (hi[0] - lo[0]) +
+				   (hi[1] - lo[1]) * (hi[1] - lo[1]) +
+				   (hi[2] - lo[2]) * (hi[2] - lo[2]);
+	double limit = SIMPLIFY_MAX_ERROR * SIMPLIFY_MAX_ERROR * size2;
+
+	vector<unsigned> stamp( nverts, 0 );
+	vector<char> removed( nverts, 0 );
+	priority_queue< Collapse, vector<Collapse>, CollapseOrder > heap;
+
+	// queue a collapse of 'from' onto 'to'
+	auto consider = [&]( int from, int to ) {
+		if( locked[from] ) {
+			return;
+		}
+		Quadric Q = quad[from];
+		for( int k = 0; k < 10; ++k ) {
+			Q.q[k] += quad[to].q[k];
+		}
+		Collapse c = { evaluate( Q, pos + 4 * to ), from, to,
+			stamp[from], stamp[to] };
+		heap.push( c );
+	};
+
+	for( int t = 0; t < ntris; ++t ) {
+		for( int k = 0; k < 3; ++k ) {
+			int a = tri[3 * t + k], b = tri[3 * t + (k + 1) % 3];
+			consider( a, b );
+			consider( b, a );
+		}
+	}
+
+	// the live neighbors of a vertex, each marked in 'seen' with a
+	// new visit number (the removed triangles are dropped on the way)
+	vector<int> nfrom, nto;
+	vector<unsigned> seenFrom( nverts, 0 ), seenTo( nverts, 0 );
+	unsigned visit = 0;
+	auto neighbors = [&]( int v, vector<int> &out, vector<unsigned> &seen ) {
+		vector<int> &list = around[v];
+		size_t kept = 0;
+		out.clear();
+		visit += 1;
+		for( size_t i = 0; i < list.size(); ++i ) {
+			int t = list[i];
+			if( dead[t] ) {
+				continue;
+			}
+			list[kept++] = t;
+			for( int k = 0; k < 3; ++k ) {
+				int w = tri[3 * t + k];
+				if( w != v && seen[w] != visit ) {
+					seen[w] = visit;
+					out.push_back( w );
+				}
+			}
+		}
+		list.resize( kept );
+		return( visit );
+	};
+
+	// may 'from' be moved onto 'to' without damaging the surface?
+	auto allowed = [&]( int from, int to ) {
+		unsigned vf = neighbors( from, nfrom, seenFrom );
+		if( seenFrom[to] != vf ) {
+			return( false );
+		}
+
+		// the edge's triangles may be the only ones the two ends share
+		int shared = 0;
+		for( size_t i = 0; i < around[from].size(); ++i ) {
+			int t = around[from][i];
+			if( !dead[t] && (tri[3 * t] == (GLuint) to ||
+				tri[3 * t + 1] == (GLuint) to ||
+				tri[3 * t + 2] == (GLuint) to) ) {
+				shared += 1;
+			}
+		}
+		neighbors( to, nto, seenTo );
+		int common = 0;
+		for( size_t i = 0; i < nto.size(); ++i ) {
+			common += seenFrom[ nto[i] ] == vf;
+		}
+		if( common > shared ) {
+			return( false );
+		}
+
+		// nor leave 'to' with too many neighbors
+		if( (int) (nfrom.size() + nto.size()) - 2 - common >
+			SIMPLIFY_MAX_VALENCE ) {
+			return( false );
+		}
+
+		// and none of the triangles that stay may turn over, or
+		// come to face away from where they faced at first
+		for( size_t i = 0; i < around[from].size(); ++i ) {
+			int t = around[from][i];
+			if( dead[t] ) {
+				continue;
+			}
+			const float *p[3], *q[3];
+			bool hasTo = false;
+			for( int k = 0; k < 3; ++k ) {
+				int v = tri[3 * t + k];
+				hasTo = hasTo || v == to;
+				p[k] = pos + 4 * v;
+				q[k] = pos + 4 * (v == from ? to : v);
+			}
+			if( hasTo ) {
+				continue;
+			}
+			double before[3], after[3];
+			triNormal( p[0], p[1], p[2], before );
+			triNormal( q[0], q[1], q[2], after );
+			const double *first = &facing[3 * t];
+			double len = sqrt( after[0] * after[0] + after[1] * after[1] +
+				after[2] * after[2] );
+			if( before[0] * after[0] + before[1] * after[1] +
+				before[2] * after[2] <= 0.0 ||
+				first[0] * after[0] + first[1] * after[1] +
+				first[2] * after[2] < SIMPLIFY_MIN_FACING * len ) {
+				return( false );
+			}
+		}
+
+		return( true );
+	};
+
+	double worst = 0.0;
+	int made = 0;
+	int prev = ntris;
+
+	while( made < levels ) {
+		int target = (int) (prev * SIMPLIFY_RATIO);
+
+		while( !heap.empty() && heap.top().cost <= limit &&
+			   (alive > target || heap.top().cost <= SIMPLIFY_FREE) ) {
+			Collapse c = heap.top();
+			heap.pop();
+
+			if( removed[c.from] || removed[c.to] ||
+				c.stampFrom != stamp[c.from] || c.stampTo != stamp[c.to] ||
+				!allowed( c.from, c.to ) ) {
+				continue;
+			}
+
+			// move the vertex, dropping the triangles on the edge
+			for( size_t i = 0; i < around[c.from].size(); ++i ) {
+				int t = around[c.from][i];
+				if( dead[t] ) {
+					continue;
+				}
+				GLuint *v = &tri[3 * t];
+				if( v[0] == (GLuint) c.to || v[1] == (GLuint) c.to ||
+					v[2] == (GLuint) c.to ) {
+					dead[t] = 1;
+					alive -= 1;
+				} else {
+					for( int k = 0; k < 3; ++k ) {
+						if( v[k] == (GLuint) c.from ) {
+							v[k] = c.to;
+						}
+					}
+					around[c.to].push_back( t );
+				}
+			}
+			around[c.from].clear();
+			removed[c.from] = 1;
+
+			for( int k = 0; k < 10; ++k ) {
+				quad[c.to].q[k] += quad[c.from].q[k];
+			}
+			stamp[c.to] += 1;
+			worst = std::max( worst, c.cost );
+
+			// the collapses around the survivor have new costs
+			neighbors( c.to, nto, seenTo );
+			for( size_t i = 0; i < nto.size(); ++i ) {
+				consider( nto[i], c.to );
+				consider( c.to, nto[i] );
+			}
+		}
+
+		// stop when the level wouldn't be much simpler than the last
+		if( alive > prev * SIMPLIFY_MIN_GAIN ) {
+			break;
+		}
+
+		lods[made].clear();
+		for( int t = 0; t < ntris; ++t ) {
+			if( !dead[t] ) {
+				lods[made].insert( lods[made].end(),
+					tri.begin() + 3 * t, tri.begin() + 3 * t + 3 );
+			}
+		}
+		errors[made] = (float) sqrt( worst );
+		made += 1;
+		prev = alive;
+	}
+
+	return( made );
+}
@@ -0,0 +1,82 @@
+//
+//  Simplify.h
+//
+//  Level-of-detail generation for indexed meshes.
+//
+//  Simplified versions of a mesh are made by edge collapses chosen by
+//  the quadric error metric of Garland and Heckbert:  each vertex
+//  carries the sum of the squared-distance quadrics of the planes of
+//  the triangles around it, and the edge whose collapse adds the least
+//  error is always collapsed next.
+//
+//  Each collapse moves a vertex onto one of its neighbors (a "half
+//  edge" collapse) rather than to a new, optimal location, so every
+//  level uses a subset of the original vertices; the levels are just
+//  more index lists for the same vertex buffer.  Vertices on an open
+//  boundary, or on a seam where the generator duplicated a location
+//  to give it a second normal or texture coordinate, never move, so
+//  outlines and seams are kept intact.  Collapses that would flip a
+//  triangle, turn it away from the way it first faced, pinch the
+//  surface, or leave a vertex with too many neighbors are refused,
+//  and no collapse may cost more than SIMPLIFY_MAX_ERROR of the size
+//  of the mesh.
+//
+//  Each level aims for SIMPLIFY_RATIO times the triangles of the one
+//  before, and also takes every collapse that adds no error at all.
+//  Its error is the square root of the largest quadric error of any
+//  collapse made so far, a distance in model coordinates.
+//
+
+#ifndef SIMPLIFY_H_
+#define SIMPLIFY_H_
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+using namespace std;
+
+//
+// Triangles in each level, as a fraction of those in the level before
+//
+#define SIMPLIFY_RATIO      0.5f
+
+//
+// A level is kept only if it has at most this fraction of the
+// triangles of the level before
+//
+#define SIMPLIFY_MIN_GAIN   0.8f
+
+//
+// Largest error allowed, as a fraction of the size (bounding box
+// diagonal) of the mesh
+//
+#define SIMPLIFY_MAX_ERROR  0.05f
+
+//
+// Meshes with fewer triangles than this are not simplified
+//
+#define SIMPLIFY_MIN_TRIS   16
+
+///
+/// Build progressively simpler versions of an indexed mesh
+///
+/// @param idx      the mesh's index list (three per triangle)
+/// @param nidx     number of indices
+/// @param pos      vertex locations (XYZW)
+/// @param nverts   number of vertices
+/// @param levels   most simplified levels wanted
+/// @param lods     receives the index list of each level
+/// @param errors   receives the error of each level (model coordinates)
+///
+/// @return the number of levels built (0 if none was worth keeping)
+///
+int buildLODs( const GLuint *idx, int nidx, const float *pos, int nverts,
+	int levels, vector<GLuint> lods[], float errors[] );
+
+#endif
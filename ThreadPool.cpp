@@ -0,0 +1,131 @@
+//
+//  ThreadPool.cpp
+//
+//  A small pool of worker threads.
+//
+
+#include "ThreadPool.h"
+
+///
+/// Constructor
+///
+/// @param n   number of worker threads (0 for one per core, less
+///            one for the calling thread)
+///
+ThreadPool::ThreadPool( int n ) : count(0), next(0), active(0),
+	generation(0), quitting(false) {
+
+	if( n <= 0 ) {
+		n = (int) thread::hardware_concurrency() - 1;
+	}
+
+	for( int i = 0; i < n; ++i ) {
+		workers.push_back( thread( &ThreadPool::work, this, i ) );
+	}
+}
+
+///
+/// Destructor - waits for the workers to finish
+///
+ThreadPool::~ThreadPool( void ) {
+
+	{
+		unique_lock<mutex> l( lock );
+		quitting = true;
+	}
+	wake.notify_all();
+
+	for( size_t i = 0; i < workers.size(); ++i ) {
+		workers[i].join();
+	}
+}
+
+///
+/// A worker's main loop
+///
+/// @param id   the worker's number
+///
+void ThreadPool::work( int id ) {
+	unsigned long seen = 0;
+
+	for( ;; ) {
+		unique_lock<mutex> l( lock );
+		wake.wait( l, [&] { return( quitting || generation != seen ); } );
+		if( quitting ) {
+			return;
+		}
+		seen = generation;
+		l.unlock();
+
+		drain( id );
+
+		l.lock();
+		if( --active == 0 ) {
+			done.notify_all();
+		}
+	}
+}
+
+///
+/// Take and run jobs until the batch has none left
+///
+/// @param id   the number of the worker running them
+///
+void ThreadPool::drain( int id ) {
+	int i;
+
+	while( (i = next++) < count ) {
+		job( i, id );
+	}
+}
+
+///
+/// Start a batch of jobs on the workers, and return immediately
+///
+/// @param n    number of jobs
+/// @param fn   the function to call for each job
+///
+void ThreadPool::start( int n, PoolJob fn ) {
+
+	{
+		unique_lock<mutex> l( lock );
+		job = fn;
+		count = n;
+		next = 0;
+		active = (int) workers.size();
+		generation += 1;
+	}
+	wake.notify_all();
+}
+
+///
+/// Wait for the current batch of jobs to finish
+///
+void ThreadPool::wait( void ) {
+	unique_lock<mutex> l( lock );
+
+	done.wait( l, [&] { return( active == 0 ); } );
+}
+
+///
+/// Run a batch of jobs to completion, helping with them
+///
+/// @param n    number of jobs
+/// @param fn   the function to call for each job
+///
+void ThreadPool::run( int n, PoolJob fn ) {
+	start( n, fn );
+	drain( size() );
+	wait();
+}
+
+///
+/// The pool shared by the rest of the application
+///
+/// @return the pool, created the first time it's needed
+///
+ThreadPool &ThreadPool::shared( void ) {
+	static ThreadPool pool;
+
+	return( pool );
+}
@@ -0,0 +1,128 @@
+//
+//  ThreadPool.h
+//
+//  A small pool of worker threads for CPU-side work that splits into
+//  independent jobs (e.g., building the geometry for several objects).
+//
+//  A batch of jobs is started with start() and finished with wait();
+//  between the two, the calling thread is free to do other things
+//  (such as OpenGL calls, which must stay on the context's thread).
+//  run() does both, with the calling thread helping out.
+//
+//  Each job is told which worker is running it, so per-worker data
+//  (e.g., a scratch Canvas) can be kept in an array indexed by worker.
+//  Workers are numbered 0 through size()-1; the calling thread is
+//  worker size() when it helps in run().
+//
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+///
+/// A job:  fn( job number, worker number )
+///
+typedef function<void(int,int)> PoolJob;
+
+class ThreadPool {
+
+	vector<thread> workers;
+
+	// protects everything below except 'next'
+	mutex lock;
+	condition_variable wake, done;
+
+	// the current batch
+	PoolJob job;
+	int count;
+	atomic<int> next;
+
+	// workers still busy with the current batch
+	int active;
+
+	// incremented for each batch, so workers can tell a new one
+	unsigned long generation;
+
+	bool quitting;
+
+public:
+
+	///
+	/// Constructor
+	///
+	/// @param n   number of worker threads (0 for one per core, less
+	///            one for the calling thread)
+	///
+	ThreadPool( int n = 0 );
+
+	///
+	/// Destructor - waits for the workers to finish
+	///
+	~ThreadPool( void );
+
+	// the workers can't be shared with a copy
+	ThreadPool( const ThreadPool & ) = delete;
+	ThreadPool &operator=( const ThreadPool & ) = delete;
+
+	///
+	/// Number of worker threads
+	///
+	/// @return the number of workers (not counting the calling thread)
+	///
+	int size( void ) { return( (int) workers.size() ); }
+
+	///
+	/// Start a batch of jobs on the workers, and return immediately
+	///
+	/// @param n    number of jobs
+	/// @param fn   the function to call for each job
+	///
+	void start( int n, PoolJob fn );
+
+	///
+	/// Wait for the current batch of jobs to finish
+	///
+	void wait( void );
+
+	///
+	/// Run a batch of jobs to completion, helping with them
+	///
+	/// @param n    number of jobs
+	/// @param fn   the function to call for each job
+	///
+	void run( int n, PoolJob fn );
+
+	///
+	/// The pool shared by the rest of the application
+	///
+	/// @return the pool, created the first time it's needed
+	///
+	static ThreadPool &shared( void );
+
+private:
+
+	///
+	/// A worker's main loop
+	///
+	/// @param id   the worker's number
+	///
+	void work( int id );
+
+	///
+	/// Take and run jobs until the batch has none left
+	///
+	/// @param id   the number of the worker running them
+	///
+	void drain( int id );
+
+};
+
+#endif
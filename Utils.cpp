@@ -14,6 +14,7 @@
 //
 
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 
@@ -47,6 +48,33 @@ static struct emap errormap[] = {
 
 const int nerrors = sizeof(errormap) / sizeof(errormap[0]);
 
+// names of the uniforms we track (order must match UniformID in Utils.h)
+static const char *uniformNames[N_UNIFORMS] = {
+	"viewMat", "projMat", "modelMat",
+	"lightPosition", "lightColor", "ambientLight",
+	"diffuseColor", "ambientColor", "kCoeff", "specExp",
+	"mainTex", "backTex",
+	"posScale", "posOffset"
+};
+
+// maximum number of programs whose uniform tables we keep
+#define MAX_PROGRAMS	8
+
+//
+// Uniform locations for one shader program
+//
+struct utable {
+	GLuint prog;
+	GLint loc[N_UNIFORMS];
+	bool warned[N_UNIFORMS];
+};
+
+static struct utable utables[MAX_PROGRAMS];
+static int nutables = 0;
+
+// the table used most recently
+static struct utable *lastTable = nullptr;
+
 ///
 /// OpenGL error checking
 ///
@@ -211,6 +239,117 @@ GLint getUniformLoc( GLuint prog, const GLchar *name ) {
 	return( loc );
 }
 
+///
+/// Locate the uniform table for a shader program
+///
+/// @param prog  the shader program
+/// @return a pointer to the table, or nullptr if there isn't one
+///
+static struct utable *findTable( GLuint prog ) {
+
+	// consecutive lookups are almost always for the same program
+	if( lastTable != nullptr && lastTable->prog == prog ) {
+		return( lastTable );
+	}
+
+	for( int i = 0; i < nutables; ++i ) {
+		if( utables[i].prog == prog ) {
+			lastTable = &utables[i];
+			return( lastTable );
+		}
+	}
+
+	return( nullptr );
+}
+
+///
+/// Build the table of uniform locations for a shader program
+///
+/// Walks the program's active uniforms and records the location of
+/// each one we know by ID.  Called once, after the program is linked.
+///
+/// @param prog  the shader program
+///
+void buildUniformTable( GLuint prog ) {
+	GLint count, size, maxlen;
+	GLsizei length;
+	GLenum type;
+
+	// reuse the existing table if this program has one
+	struct utable *t = findTable( prog );
+	if( t == nullptr ) {
+		if( nutables >= MAX_PROGRAMS ) {
+			cerr << "buildUniformTable: too many programs, #"
+				 << prog << " not recorded" << endl;
+			return;
+		}
+		t = &utables[nutables++];
+		t->prog = prog;
+	}
+
+	for( int i = 0; i < N_UNIFORMS; ++i ) {
+		t->loc[i] = -1;
+		t->warned[i] = false;
+	}
+
+	glGetProgramiv( prog, GL_ACTIVE_UNIFORMS, &count );
+	glGetProgramiv( prog, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxlen );
+	if( count < 1 || maxlen < 1 ) {
+		return;
+	}
+
+	GLchar *name = new GLchar[ maxlen ];
+
+	for( int i = 0; i < count; ++i ) {
+		glGetActiveUniform( prog, i, maxlen, &length, &size, &type, name );
+
+		// arrays are reported as "name[0]"
+		GLchar *bracket = strchr( name, '[' );
+		if( bracket != nullptr ) {
+			*bracket = '\0';
+		}
+
+		for( int id = 0; id < N_UNIFORMS; ++id ) {
+			if( strcmp(name, uniformNames[id]) == 0 ) {
+				t->loc[id] = glGetUniformLocation( prog, uniformNames[id] );
+				break;
+			}
+		}
+	}
+
+	delete [] name;
+}
+
+///
+/// Retrieve a Uniform variable's location from the program's table
+///
+/// A missing variable is reported only the first time it is requested.
+///
+/// @param prog  the shader program
+/// @param id    which uniform variable
+///
+GLint getUniformLoc( GLuint prog, UniformID id ) {
+
+	struct utable *t = findTable( prog );
+	if( t == nullptr ) {
+		// not built at link time; do it now
+		buildUniformTable( prog );
+		t = findTable( prog );
+		if( t == nullptr ) {
+			return( getUniformLoc(prog, uniformNames[id]) );
+		}
+	}
+
+	GLint loc = t->loc[id];
+	if( loc < 0 && !t->warned[id] ) {
+		cerr << "Bad uniform, program " << prog
+			<< " variable '" << uniformNames[id] << "'" << endl;
+		t->warned[id] = true;
+	}
+
+	return( loc );
+}
+
 ///
 /// Retrieve an Attribute variable's location and verify the result
 ///
@@ -23,6 +23,26 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+//
+// Uniform variables used by our shader programs.  The locations of
+// these are found once per program, when the program is linked, and
+// are retrieved by ID afterward.
+//
+typedef enum uniforms_e {
+	// viewing
+	U_VIEW_MAT = 0, U_PROJ_MAT, U_MODEL_MAT,
+	// lighting
+	U_LIGHT_POSITION, U_LIGHT_COLOR, U_AMBIENT_LIGHT,
+	// materials
+	U_DIFFUSE_COLOR, U_AMBIENT_COLOR, U_K_COEFF, U_SPEC_EXP,
+	// texture samplers
+	U_MAIN_TEX, U_BACK_TEX,
+	// packed position decoding
+	U_POS_SCALE, U_POS_OFFSET,
+	// sentinel
+	N_UNIFORMS
+} UniformID;
+
 ///
 /// OpenGL error checking
 ///
@@ -51,6 +71,26 @@ void dumpActives( const char *desc, GLuint prog );
 ///
 GLint getUniformLoc( GLuint prog, const GLchar *name );
 
+///
+/// Build the table of uniform locations for a shader program
+///
+/// Walks the program's active uniforms and records the location of
+/// each one we know by ID.  Called once, after the program is linked.
+///
+/// @param prog  the shader program
+///
+void buildUniformTable( GLuint prog );
+
+///
+/// Retrieve a Uniform variable's location from the program's table
+///
+/// A missing variable is reported only the first time it is requested.
+///
+/// @param prog  the shader program
+/// @param id    which uniform variable
+///
+GLint getUniformLoc( GLuint prog, UniformID id );
+
 ///
 /// Retrieve an Attribute variable's location and verify the result
 ///
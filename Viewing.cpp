@@ -48,6 +48,26 @@ static GLfloat bounds[] = { -1.0f, 1.0f, 1.0f, -1.0f, 3.0f, 100.5f };
 #define NEAR    bounds[4]
 #define FAR     bounds[5]
 
+///
+/// This function returns the frustum projection matrix for the scene.
+///
+/// @return the projection matrix
+///
+glm::mat4 projectionMatrix( void )
+{
+	return( glm::frustum( LEFT, RIGHT, BOTTOM, TOP, NEAR, FAR ) );
+}
+
+///
+/// This function returns the viewing (camera) matrix for the scene.
+///
+/// @return the camera matrix
+///
+glm::mat4 cameraMatrix( void )
+{
+	return( glm::lookAt( eye, lookat, up ) );
+}
+
 ///
 /// This function sets up a frustum projection of the scene.
 ///
@@ -56,27 +76,25 @@ static GLfloat bounds[] = { -1.0f, 1.0f, 1.0f, -1.0f, 3.0f, 100.5f };
 ///
 void setProjection( GLuint program )
 {
-	glm::mat4 pmat = glm::frustum( LEFT, RIGHT, BOTTOM, TOP, NEAR, FAR );
+	glm::mat4 pmat = projectionMatrix();
 
-	GLint loc = getUniformLoc( program, "projMat" );
+	GLint loc = getUniformLoc( program, U_PROJ_MAT );
 	if( loc >= 0 ) {
 		glUniformMatrix4fv( loc, 1, GL_FALSE, glm::value_ptr(pmat) );
 	}
 }
 
 ///
-/// This function sets up the transformation parameters for the vertices
-/// of the object.  The order of application is fixed: scaling, Z rotation,
-/// Y rotation, X rotation, and then translation.
+/// This function builds the model transformation for an object.  The
+/// order of application is fixed: scaling, Z rotation, Y rotation,
+/// X rotation, and then translation.
 ///
-/// @param program - The ID of an OpenGL (GLSL) shader program to which
-///    parameter values are to be sent
 /// @param scale  - scale factors for each axis
 /// @param rotate - rotation angles around the three axes, in degrees
 /// @param xlate  - amount of translation along each axis
+/// @return the composite model matrix
 ///
-void setTransforms( GLuint program, glm::vec3 scale,
-					glm::vec3 rotate, glm::vec3 xlate )
+glm::mat4 modelMatrix( glm::vec3 scale, glm::vec3 rotate, glm::vec3 xlate )
 {
 	// need an identity matrix
 	glm::mat4 id(1.0f);
@@ -93,14 +111,41 @@ void setTransforms( GLuint program, glm::vec3 scale,
 	glm::mat4 zMat = glm::rotate( id, rads.z, glm::vec3(0.0f,0.0f,1.0f) );
 
 	// combine the transformations
-	glm::mat4 cm = tMat * xMat * yMat * zMat * sMat;
+	return( tMat * xMat * yMat * zMat * sMat );
+}
 
-	GLint loc = getUniformLoc( program, "modelMat" );
+///
+/// This function sends a precomputed model transformation to a program.
+///
+/// @param program - The ID of an OpenGL (GLSL) shader program to which
+///    parameter values are to be sent
+/// @param model   - the composite model matrix
+///
+void setModelMatrix( GLuint program, const glm::mat4 &model )
+{
+	GLint loc = getUniformLoc( program, U_MODEL_MAT );
 	if( loc >= 0 ) {
-		glUniformMatrix4fv( loc, 1, GL_FALSE, glm::value_ptr(cm) );
+		glUniformMatrix4fv( loc, 1, GL_FALSE, glm::value_ptr(model) );
 	}
 }
 
+///
+/// This function sets up the transformation parameters for the vertices
+/// of the object.  The order of application is fixed: scaling, Z rotation,
+/// Y rotation, X rotation, and then translation.
+///
+/// @param program - The ID of an OpenGL (GLSL) shader program to which
+///    parameter values are to be sent
+/// @param scale  - scale factors for each axis
+/// @param rotate - rotation angles around the three axes, in degrees
+/// @param xlate  - amount of translation along each axis
+///
+void setTransforms( GLuint program, glm::vec3 scale,
+					glm::vec3 rotate, glm::vec3 xlate )
+{
+	setModelMatrix( program, modelMatrix(scale, rotate, xlate) );
+}
+
 ///
 /// This function sets up the camera parameters controlling the viewing
 /// transformation.
@@ -111,10 +156,10 @@ void setTransforms( GLuint program, glm::vec3 scale,
 void setCamera( GLuint program )
 {
 	// calculate our camera matrix
-	glm::mat4 vMat = glm::lookAt( eye, lookat, up );
+	glm::mat4 vMat = cameraMatrix();
 
 	// copy it down to the shader program
-	GLint loc = getUniformLoc( program, "viewMat" );
+	GLint loc = getUniformLoc( program, U_VIEW_MAT );
 	if( loc >= 0 ) {
 		glUniformMatrix4fv( loc, 1, GL_FALSE, glm::value_ptr(vMat) );
 	}
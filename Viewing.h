@@ -22,6 +22,21 @@
 #include <GLFW/glfw3.h>
 
 #include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+///
+/// This function returns the frustum projection matrix for the scene.
+///
+/// @return the projection matrix
+///
+glm::mat4 projectionMatrix( void );
+
+///
+/// This function returns the viewing (camera) matrix for the scene.
+///
+/// @return the camera matrix
+///
+glm::mat4 cameraMatrix( void );
 
 ///
 /// This function sets up a frustum projection of the scene.
@@ -31,6 +46,27 @@
 ///
 void setProjection( GLuint program );
 
+///
+/// This function builds the model transformation for an object.  The
+/// order of application is fixed: scaling, Z rotation, Y rotation,
+/// X rotation, and then translation.
+///
+/// @param scale     Scale factors for each axis
+/// @param rotate    Rotation angles around the three axes, in degrees
+/// @param xlate     Amount of translation along each axis
+/// @return the composite model matrix
+///
+glm::mat4 modelMatrix( glm::vec3 scale, glm::vec3 rotate, glm::vec3 xlate );
+
+///
+/// This function sends a precomputed model transformation to a program.
+///
+/// @param program   The ID of an OpenGL (GLSL) shader program to which
+///    parameter values are to be sent
+/// @param model     The composite model matrix
+///
+void setModelMatrix( GLuint program, const glm::mat4 &model );
+
 ///
 /// This function sets up the transformation parameters for the vertices
 /// of the object.  The order of application is fixed: scaling, Z rotation,
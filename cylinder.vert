@@ -0,0 +1,50 @@
+#version 400
+
+//
+// Cylinder control cage vertex shader
+//
+// Passes the corners of the cage's patches on to the tessellation
+// control shader, which decides how finely to divide them; the
+// evaluation shader does the transformations.
+//
+
+//
+// Vertex attributes
+//
+
+// Vertex position (in model space)
+in vec4 vPosition;
+
+// Texture coordinate for this vertex (its place on the cylinder)
+in vec2 vTexCoord;
+
+// Model transformation for this instance (used when 'instanced' is set)
+in mat4 vModel;
+
+//
+// Uniform data
+//
+
+uniform mat4 modelMat;  // composite
+
+// take the model transformation from vModel instead of modelMat?
+uniform bool instanced;
+
+// Decoding for packed positions (model = vPosition * posScale + posOffset);
+// unpacked meshes use a scale of 1 and an offset of 0
+uniform vec3 posScale;
+uniform vec3 posOffset;
+
+// OUTGOING DATA
+
+out vec3 tcPosition;   // model space
+out vec2 tcTexCoord;
+out mat4 tcModel;
+
+void main()
+{
+	// recover the model-space position
+	tcPosition = vPosition.xyz * posScale + posOffset;
+	tcTexCoord = vTexCoord;
+	tcModel = instanced ? vModel : modelMat;
+}
@@ -21,6 +21,11 @@ uniform mat4 projMat;  // projection
 // Model transformation matrices
 uniform mat4 modelMat; // composite
 
+// Decoding for packed positions (model = vPosition * posScale + posOffset);
+// unpacked meshes use a scale of 1 and an offset of 0
+uniform vec3 posScale;
+uniform vec3 posOffset;
+
 // Light position is given in world space
 uniform vec4 lightPosition;
 
@@ -83,9 +88,12 @@ mat3 inverse(mat3 m) {
 
 void main()
 {
+    // recover the model-space position
+    vec4 position = vec4( vPosition.xyz * posScale + posOffset, 1.0 );
+
     // transform our positions
     mat4 mvMat = viewMat * modelMat;
-    vec3 vPos = vec3(mvMat * vPosition);
+    vec3 vPos = vec3(mvMat * position);
     vec3 lPos = vec3(viewMat * lightPosition);
 
     // transform the normal vector
@@ -101,5 +109,5 @@ void main()
     color = (kCoeff.x * ambient) + (kCoeff.y * diffuse);
 
     // send the vertex position into clip space
-    gl_Position =  projMat * mvMat * vPosition;
+    gl_Position =  projMat * mvMat * position;
 }
@@ -13,23 +13,32 @@ in vec4 vPosition;
 // Normal vector at vertex (in model space)
 in vec3 vNormal;
 
+// Model transformation for this instance (used when 'instanced' is set)
+in mat4 vModel;
+
 //
 // Uniform data
 //
 
-// Transformations
-uniform mat4 viewMat;  // view (camera)
-uniform mat4 projMat;  // projection
+// Per-frame data shared by all objects
+layout(std140) uniform FrameData {
+    mat4 viewMat;        // view (camera)
+    mat4 projMat;        // projection
+    vec4 lightPosition;  // light position, in world space
+    vec4 lightColor;
+    vec4 ambientLight;
+};
 
 // Model transformation matrices
 uniform mat4 modelMat; // composite
 
-// Light position is given in world space
-uniform vec4 lightPosition;
+// take the model transformation from vModel instead of modelMat?
+uniform bool instanced;
 
-// Light color
-uniform vec4 lightColor;
-uniform vec4 ambientLight;
+// Decoding for packed positions (model = vPosition * posScale + posOffset);
+// unpacked meshes use a scale of 1 and an offset of 0
+uniform vec3 posScale;
+uniform vec3 posOffset;
 
 // Material properties
 uniform vec4 diffuseColor;
@@ -43,9 +52,12 @@ flat out vec4 color;
 
 void main()
 {
+    // recover the model-space position
+    vec4 position = vec4( vPosition.xyz * posScale + posOffset, 1.0 );
+
     // transform our positions
-    mat4 mvMat = viewMat * modelMat;
-    vec3 vPos = vec3(mvMat * vPosition);
+    mat4 mvMat = viewMat * (instanced ? vModel : modelMat);
+    vec3 vPos = vec3(mvMat * position);
     vec3 lPos = vec3(viewMat * lightPosition);
 
     // transform the normal vector
@@ -61,5 +73,5 @@ void main()
     color = (kCoeff.x * ambient) + (kCoeff.y * diffuse);
 
     // send the vertex position into clip space
-    gl_Position =  projMat * mvMat * vPosition;
+    gl_Position =  projMat * mvMat * position;
 }
@@ -46,14 +46,15 @@ FMWKS =
 # FMWKS += -framework IOKit -framework CoreVideo
 
 # common compiler flags
-COMMONCFLAGS = -ggdb $(INCLUDE) -DGL_GLEXT_PROTOTYPES
+# (-pthread because scene geometry is built on worker threads)
+COMMONCFLAGS = -ggdb -pthread $(INCLUDE) -DGL_GLEXT_PROTOTYPES
 
 # language-specific compiler flags
 CFLAGS = -std=c99 $(COMMONCFLAGS)
 CXXFLAGS = $(COMMONCFLAGS) -DGL_SILENCE_DEPRECATION
 
 # common linker flags
-LIBFLAGS = -ggdb $(LIBDIRS) $(LDLIBS)
+LIBFLAGS = -ggdb -pthread $(LIBDIRS) $(LDLIBS)
 
 # language-specific linker flags
 CLIBFLAGS = $(LIBFLAGS) $(CLDLIBS)
@@ -0,0 +1,15 @@
+#version 150
+
+// Occlusion proxy fragment shader
+//
+// Nothing is written (color writes are off while proxies are drawn);
+// only the number of fragments passing the depth test matters.
+
+// Color being sent back to the pipeline
+out vec4 fragColor;
+
+
+void main()
+{
+    fragColor = vec4( 1.0 );
+}
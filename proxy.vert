@@ -0,0 +1,34 @@
+#version 150
+
+// Occlusion proxy vertex shader
+//
+// Draws an object's world-space bounding box, for an occlusion query.
+
+// INCOMING DATA
+
+// Corner of the unit box (each component is -1 or 1)
+in vec3 vPosition;
+
+//
+// Uniform data
+//
+
+// Per-frame data shared by all objects
+layout(std140) uniform FrameData {
+    mat4 viewMat;        // view (camera)
+    mat4 projMat;        // projection
+    vec4 lightPosition;  // light position, in world space
+    vec4 lightColor;
+    vec4 ambientLight;
+};
+
+// The box, in world space
+uniform vec3 boxCenter;
+uniform vec3 boxExtent;
+
+void main()
+{
+    vec4 position = vec4( boxCenter + vPosition * boxExtent, 1.0 );
+
+    gl_Position = projMat * viewMat * position;
+}
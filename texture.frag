@@ -33,9 +33,14 @@ in vec2 texCoord;
 // Data coming from the application
 //
 
-// Light color
-uniform vec4 lightColor;
-uniform vec4 ambientLight;
+// Per-frame data shared by all objects
+layout(std140) uniform FrameData {
+    mat4 viewMat;        // view (camera)
+    mat4 projMat;        // projection
+    vec4 lightPosition;  // light position, in world space
+    vec4 lightColor;
+    vec4 ambientLight;
+};
 
 // Material properties
 uniform vec4 diffuseColor;
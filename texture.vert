@@ -22,18 +22,31 @@ in vec3 vNormal;
 // Texture coordinate for this vertex
 in vec2 vTexCoord;
 
+// Model transformation for this instance (used when 'instanced' is set)
+in mat4 vModel;
+
 //
 // Uniform data
 //
 
-// Camera and projection matrices
-uniform mat4 viewMat;   // view (camera)
-uniform mat4 projMat;   // projection
+// Per-frame data shared by all objects
+layout(std140) uniform FrameData {
+    mat4 viewMat;        // view (camera)
+    mat4 projMat;        // projection
+    vec4 lightPosition;  // light position, in world space
+    vec4 lightColor;
+    vec4 ambientLight;
+};
 
 uniform mat4 modelMat;  // composite
 
-// Light position is given in world space
-uniform vec4 lightPosition;
+// take the model transformation from vModel instead of modelMat?
+uniform bool instanced;
+
+// Decoding for packed positions (model = vPosition * posScale + posOffset);
+// unpacked meshes use a scale of 1 and an offset of 0
+uniform vec3 posScale;
+uniform vec3 posOffset;
 
 // OUTGOING DATA
 
@@ -49,10 +62,13 @@ out vec2 texCoord;
 
 void main()
 {
+	// recover the model-space position
+	vec4 position = vec4( vPosition.xyz * posScale + posOffset, 1.0 );
+
 	// transform our positions
-	mat4 mvMat = viewMat * modelMat;
+	mat4 mvMat = viewMat * (instanced ? vModel : modelMat);
 
-	vPos = vec3(mvMat * vPosition);
+	vPos = vec3(mvMat * position);
 	lPos = vec3(viewMat * lightPosition);
 
 	// transform the normal vector
@@ -61,5 +77,5 @@ void main()
         // Pass the texture coordinate to the fragment shader
 	texCoord = vTexCoord;
 
-	gl_Position =  projMat * mvMat * vPosition;
+	gl_Position =  projMat * mvMat * position;
 }